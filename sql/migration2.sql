@@ -0,0 +1,24 @@
+BEGIN TRANSACTION;
+-- Key attachments by player as well, and delete them along with their email
+CREATE TABLE Temp (
+    PlayerID    INTEGER NOT NULL,
+    MsgIndex    INTEGER NOT NULL,
+    Slot        INTEGER NOT NULL,
+    ID          INTEGER NOT NULL,
+    Type        INTEGER NOT NULL,
+    Opt         INTEGER NOT NULL,
+    TimeLimit   INTEGER NOT NULL,
+    FOREIGN KEY(PlayerID) REFERENCES Players(PlayerID) ON DELETE CASCADE,
+    FOREIGN KEY(PlayerID, MsgIndex) REFERENCES EmailData(PlayerID, MsgIndex) ON DELETE CASCADE,
+    UNIQUE (PlayerID, MsgIndex, Slot)
+);
+-- Attachments of deleted emails were left behind; leave them out
+INSERT INTO Temp
+    SELECT PlayerID, MsgIndex, Slot, ID, Type, Opt, TimeLimit FROM EmailItems
+    WHERE EXISTS (SELECT 1 FROM EmailData WHERE EmailData.PlayerID = EmailItems.PlayerID AND EmailData.MsgIndex = EmailItems.MsgIndex);
+DROP TABLE EmailItems;
+ALTER TABLE Temp RENAME TO EmailItems;
+-- Update DB Version
+UPDATE Meta SET Value = 3 WHERE Key = 'DatabaseVersion';
+UPDATE Meta SET Value = strftime('%s', 'now') WHERE Key = 'LastMigration';
+COMMIT;
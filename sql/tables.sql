@@ -140,9 +140,13 @@ CREATE TABLE IF NOT EXISTS EmailItems (
     Opt         INTEGER NOT NULL,
     TimeLimit   INTEGER NOT NULL,
     FOREIGN KEY(PlayerID) REFERENCES Players(PlayerID) ON DELETE CASCADE,
-    UNIQUE (MsgIndex, Slot)
+    FOREIGN KEY(PlayerID, MsgIndex) REFERENCES EmailData(PlayerID, MsgIndex) ON DELETE CASCADE,
+    UNIQUE (PlayerID, MsgIndex, Slot)
 );
 
+-- online players have their inbox cached; this is for counting everyone else's unread mail
+CREATE INDEX IF NOT EXISTS EmailUnread ON EmailData (PlayerID) WHERE ReadFlag = 0;
+
 CREATE TABLE IF NOT EXISTS RaceResults(
     EPID      INTEGER NOT NULL,
     PlayerID  INTEGER NOT NULL,
@@ -5,12 +5,13 @@
 #include "BuddyManager.hpp"
 #include "Database.hpp"
 #include "ItemManager.hpp"
-#include "Database.hpp"
+#include "Inbox.hpp"
 
 #include <iostream>
 #include <chrono>
 #include <algorithm>
 #include <thread>
+#include <unordered_map>
 
 void BuddyManager::init() {
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_REQUEST_MAKE_BUDDY, requestBuddy);
@@ -36,9 +37,30 @@ void BuddyManager::init() {
 }
 
 // Refresh buddy list
-void BuddyManager::refreshBuddyList(CNSocket* sock) {
+void BuddyManager::refreshBuddyList(CNSocket* sock, const std::vector<Database::PlayerSummary>* prefetched) {
     Player* plr = PlayerManager::getPlayer(sock);
-    int buddyCnt = Database::getNumBuddies(plr);
+
+    // online buddies are read from memory; only the offline ones need the DB, in one query
+    std::vector<int> offlineIDs;
+    int buddyCnt = 0;
+    for (int i = 0; i < 50; i++) {
+        int64_t buddyID = plr->cold->buddyIDs[i];
+        if (buddyID == 0)
+            continue;
+
+        buddyCnt++;
+        if (PlayerManager::getPlayerFromID(buddyID) == nullptr)
+            offlineIDs.push_back(buddyID);
+    }
+
+    std::unordered_map<int64_t, Database::PlayerSummary> offline;
+    if (prefetched == nullptr) {
+        for (auto& summary : Database::getPlayerSummaries(offlineIDs))
+            offline[summary.PlayerID] = summary;
+    } else {
+        for (auto& summary : *prefetched)
+            offline[summary.PlayerID] = summary;
+    }
 
     if (!validOutVarPacket(sizeof(sP_FE2CL_REP_PC_BUDDYLIST_INFO_SUCC), buddyCnt, sizeof(sBuddyBaseInfo))) {
         std::cout << "[WARN] bad sP_FE2CL_REP_PC_BUDDYLIST_INFO_SUCC packet size\n";
@@ -62,22 +84,29 @@ void BuddyManager::refreshBuddyList(CNSocket* sock) {
 
     int buddyIndex = 0;
     for (int i = 0; i < 50; i++) {
-        int64_t buddyID = plr->buddyIDs[i];
+        int64_t buddyID = plr->cold->buddyIDs[i];
         if (buddyID != 0) {
             sBuddyBaseInfo buddyInfo = {};
-            Player buddyPlayerData = {};
-            Database::getPlayer(&buddyPlayerData, buddyID);
-            if (buddyPlayerData.iID == 0)
-                continue;
-            buddyInfo.bBlocked = plr->isBuddyBlocked[i];
+            const sPCStyle* style;
+
+            Player* online = PlayerManager::getPlayerFromID(buddyID);
+            if (online != nullptr) {
+                style = &online->PCStyle;
+            } else {
+                auto it = offline.find(buddyID);
+                if (it == offline.end())
+                    continue;
+                style = &it->second.PCStyle;
+            }
+
+            buddyInfo.bBlocked = plr->cold->isBuddyBlocked[i];
             buddyInfo.bFreeChat = 1;
-            buddyInfo.iGender = buddyPlayerData.PCStyle.iGender;
+            buddyInfo.iGender = style->iGender;
             buddyInfo.iID = buddyID;
             buddyInfo.iPCUID = buddyID;
-            buddyInfo.iNameCheckFlag = buddyPlayerData.PCStyle.iNameCheck;
-            buddyInfo.iPCState = buddyPlayerData.iPCState;
-            memcpy(buddyInfo.szFirstName, buddyPlayerData.PCStyle.szFirstName, sizeof(buddyInfo.szFirstName));
-            memcpy(buddyInfo.szLastName, buddyPlayerData.PCStyle.szLastName, sizeof(buddyInfo.szLastName));
+            buddyInfo.iNameCheckFlag = style->iNameCheck;
+            memcpy(buddyInfo.szFirstName, style->szFirstName, sizeof(buddyInfo.szFirstName));
+            memcpy(buddyInfo.szLastName, style->szLastName, sizeof(buddyInfo.szLastName));
             respdata[buddyIndex] = buddyInfo;
             buddyIndex++;
         }
@@ -189,8 +218,8 @@ void BuddyManager::reqAcceptBuddy(CNSocket* sock, CNPacketData* data) {
         memcpy(resp.BuddyInfo.szFirstName, otherPlr->PCStyle.szFirstName, sizeof(resp.BuddyInfo.szFirstName));
         memcpy(resp.BuddyInfo.szLastName, otherPlr->PCStyle.szLastName, sizeof(resp.BuddyInfo.szLastName));
         sock->sendPacket((void*)&resp, P_FE2CL_REP_ACCEPT_MAKE_BUDDY_SUCC, sizeof(sP_FE2CL_REP_ACCEPT_MAKE_BUDDY_SUCC));
-        plr->buddyIDs[slotA] = otherPlr->PCStyle.iPC_UID;
-        //std::cout << "Buddy's ID: " << plr->buddyIDs[slotA] << std::endl;
+        plr->cold->buddyIDs[slotA] = otherPlr->PCStyle.iPC_UID;
+        //std::cout << "Buddy's ID: " << plr->cold->buddyIDs[slotA] << std::endl;
         
         // B to A, using the same struct
         resp.iBuddySlot = slotB;
@@ -204,8 +233,8 @@ void BuddyManager::reqAcceptBuddy(CNSocket* sock, CNPacketData* data) {
         memcpy(resp.BuddyInfo.szFirstName, plr->PCStyle.szFirstName, sizeof(resp.BuddyInfo.szFirstName));
         memcpy(resp.BuddyInfo.szLastName, plr->PCStyle.szLastName, sizeof(resp.BuddyInfo.szLastName));
         otherSock->sendPacket((void*)&resp, P_FE2CL_REP_ACCEPT_MAKE_BUDDY_SUCC, sizeof(sP_FE2CL_REP_ACCEPT_MAKE_BUDDY_SUCC));
-        otherPlr->buddyIDs[slotB] = plr->PCStyle.iPC_UID;
-        //std::cout << "Buddy's ID: " << plr->buddyIDs[slotB] << std::endl;
+        otherPlr->cold->buddyIDs[slotB] = plr->PCStyle.iPC_UID;
+        //std::cout << "Buddy's ID: " << plr->cold->buddyIDs[slotB] << std::endl;
 
         // add record to db
         Database::addBuddyship(plr->iID, otherPlr->iID);
@@ -240,7 +269,7 @@ void BuddyManager::reqFindNameBuddyAccept(CNSocket* sock, CNPacketData* data) {
     if (otherPlr == nullptr)
         return;
 
-    CNSocket* otherSock = PlayerManager::getSockFromID(pkt->iBuddyPCUID);
+    CNSocket* otherSock = PlayerManager::getSockFromUID(pkt->iBuddyPCUID);
 
     int slotA = getAvailableBuddySlot(plrReq);
     int slotB = getAvailableBuddySlot(otherPlr);
@@ -262,8 +291,8 @@ void BuddyManager::reqFindNameBuddyAccept(CNSocket* sock, CNPacketData* data) {
         memcpy(resp.BuddyInfo.szFirstName, otherPlr->PCStyle.szFirstName, sizeof(resp.BuddyInfo.szFirstName));
         memcpy(resp.BuddyInfo.szLastName, otherPlr->PCStyle.szLastName, sizeof(resp.BuddyInfo.szLastName));
         sock->sendPacket((void*)&resp, P_FE2CL_REP_ACCEPT_MAKE_BUDDY_SUCC, sizeof(sP_FE2CL_REP_ACCEPT_MAKE_BUDDY_SUCC));
-        plrReq->buddyIDs[slotA] = otherPlr->PCStyle.iPC_UID;
-        //std::cout << "Buddy's ID: " << plr->buddyIDs[slotA] << std::endl;
+        plrReq->cold->buddyIDs[slotA] = otherPlr->PCStyle.iPC_UID;
+        //std::cout << "Buddy's ID: " << plr->cold->buddyIDs[slotA] << std::endl;
 
         // B to A, using the same struct
         resp.iBuddySlot = slotB;
@@ -277,8 +306,8 @@ void BuddyManager::reqFindNameBuddyAccept(CNSocket* sock, CNPacketData* data) {
         memcpy(resp.BuddyInfo.szFirstName, plrReq->PCStyle.szFirstName, sizeof(resp.BuddyInfo.szFirstName));
         memcpy(resp.BuddyInfo.szLastName, plrReq->PCStyle.szLastName, sizeof(resp.BuddyInfo.szLastName));
         otherSock->sendPacket((void*)&resp, P_FE2CL_REP_ACCEPT_MAKE_BUDDY_SUCC, sizeof(sP_FE2CL_REP_ACCEPT_MAKE_BUDDY_SUCC));
-        otherPlr->buddyIDs[slotB] = plrReq->PCStyle.iPC_UID;
-        //std::cout << "Buddy's ID: " << plr->buddyIDs[slotB] << std::endl;
+        otherPlr->cold->buddyIDs[slotB] = plrReq->PCStyle.iPC_UID;
+        //std::cout << "Buddy's ID: " << plr->cold->buddyIDs[slotB] << std::endl;
 
         // add record to db
         Database::addBuddyship(plrReq->iID, otherPlr->iID);
@@ -304,7 +333,7 @@ void BuddyManager::reqBuddyFreechat(CNSocket* sock, CNPacketData* data) {
 
     INITSTRUCT(sP_FE2CL_REP_SEND_BUDDY_FREECHAT_MESSAGE_SUCC, resp);
 
-    CNSocket* otherSock = PlayerManager::getSockFromID(pkt->iBuddyPCUID);
+    CNSocket* otherSock = PlayerManager::getSockFromUID(pkt->iBuddyPCUID);
 
     if (otherSock == nullptr)
         return; // buddy offline
@@ -345,7 +374,7 @@ void BuddyManager::reqBuddyMenuchat(CNSocket* sock, CNPacketData* data) {
 
     INITSTRUCT(sP_FE2CL_REP_SEND_BUDDY_MENUCHAT_MESSAGE_SUCC, resp);
 
-    CNSocket* otherSock = PlayerManager::getSockFromID(pkt->iBuddyPCUID);
+    CNSocket* otherSock = PlayerManager::getSockFromUID(pkt->iBuddyPCUID);
 
     if (otherSock == nullptr)
         return; // buddy offline
@@ -384,8 +413,8 @@ void BuddyManager::reqPktGetBuddyState(CNSocket* sock, CNPacketData* data) {
     INITSTRUCT(sP_FE2CL_REP_GET_BUDDY_STATE_SUCC, resp);
     
     for (int slot = 0; slot < 50; slot++) {
-        resp.aBuddyState[slot] = PlayerManager::getPlayerFromID(plr->buddyIDs[slot]) != nullptr ? 1 : 0;
-        resp.aBuddyID[slot] = plr->buddyIDs[slot];
+        resp.aBuddyState[slot] = PlayerManager::getPlayerFromID(plr->cold->buddyIDs[slot]) != nullptr ? 1 : 0;
+        resp.aBuddyID[slot] = plr->cold->buddyIDs[slot];
     }
 
     sock->sendPacket((void*)&resp, P_FE2CL_REP_GET_BUDDY_STATE_SUCC, sizeof(sP_FE2CL_REP_GET_BUDDY_STATE_SUCC));
@@ -400,7 +429,7 @@ void BuddyManager::reqBuddyBlock(CNSocket* sock, CNPacketData* data) {
     Player* plr = PlayerManager::getPlayer(sock);
 
     // sanity checks
-    if (pkt->iBuddySlot < 0 || pkt->iBuddySlot >= 50 || plr->buddyIDs[pkt->iBuddySlot] != pkt->iBuddyPCUID)
+    if (pkt->iBuddySlot < 0 || pkt->iBuddySlot >= 50 || plr->cold->buddyIDs[pkt->iBuddySlot] != pkt->iBuddyPCUID)
         return;
 
     // save in DB
@@ -409,7 +438,7 @@ void BuddyManager::reqBuddyBlock(CNSocket* sock, CNPacketData* data) {
 
     // save serverside
     // since ID is already in the array, just set it to blocked
-    plr->isBuddyBlocked[pkt->iBuddySlot] = true;
+    plr->cold->isBuddyBlocked[pkt->iBuddySlot] = true;
 
     // send response
     INITSTRUCT(sP_FE2CL_REP_SET_BUDDY_BLOCK_SUCC, resp);
@@ -419,16 +448,16 @@ void BuddyManager::reqBuddyBlock(CNSocket* sock, CNPacketData* data) {
 
     // notify the other player he isn't a buddy anymore
     INITSTRUCT(sP_FE2CL_REP_REMOVE_BUDDY_SUCC, otherResp);
-    CNSocket* otherSock = PlayerManager::getSockFromID(pkt->iBuddyPCUID);
+    CNSocket* otherSock = PlayerManager::getSockFromUID(pkt->iBuddyPCUID);
     if (otherSock == nullptr)
         return; // other player isn't online, no broadcast needed
     Player* otherPlr = PlayerManager::getPlayer(otherSock);
     // search for the slot with the requesting player's ID
     otherResp.iBuddyPCUID = plr->PCStyle.iPC_UID;
     for (int i = 0; i < 50; i++) {
-        if (otherPlr->buddyIDs[i] == plr->PCStyle.iPC_UID) {
+        if (otherPlr->cold->buddyIDs[i] == plr->PCStyle.iPC_UID) {
             // remove buddy
-            otherPlr->buddyIDs[i] = 0;
+            otherPlr->cold->buddyIDs[i] = 0;
             // broadcast
             otherResp.iBuddySlot = i;
             otherSock->sendPacket((void*)&otherResp, P_FE2CL_REP_REMOVE_BUDDY_SUCC, sizeof(sP_FE2CL_REP_REMOVE_BUDDY_SUCC));
@@ -453,8 +482,8 @@ void BuddyManager::reqPlayerBlock(CNSocket* sock, CNPacketData* data) {
     Database::addBlock(plr->iID, pkt->iBlock_PCUID);
 
     // save serverside
-    plr->buddyIDs[buddySlot] = pkt->iBlock_PCUID;
-    plr->isBuddyBlocked[buddySlot] = true;
+    plr->cold->buddyIDs[buddySlot] = pkt->iBlock_PCUID;
+    plr->cold->isBuddyBlocked[buddySlot] = true;
 
     // send response
     INITSTRUCT(sP_FE2CL_REP_SET_PC_BLOCK_SUCC, resp);
@@ -479,12 +508,12 @@ void BuddyManager::reqBuddyDelete(CNSocket* sock, CNPacketData* data) {
     INITSTRUCT(sP_FE2CL_REP_REMOVE_BUDDY_SUCC, resp);
     resp.iBuddyPCUID = pkt->iBuddyPCUID;
     resp.iBuddySlot = pkt->iBuddySlot;
-    if (pkt->iBuddySlot < 0 || pkt->iBuddySlot >= 50 || plr->buddyIDs[pkt->iBuddySlot] != pkt->iBuddyPCUID)
+    if (pkt->iBuddySlot < 0 || pkt->iBuddySlot >= 50 || plr->cold->buddyIDs[pkt->iBuddySlot] != pkt->iBuddyPCUID)
         return; // sanity check
 
-    bool wasBlocked = plr->isBuddyBlocked[resp.iBuddySlot];
-    plr->buddyIDs[resp.iBuddySlot] = 0;
-    plr->isBuddyBlocked[resp.iBuddySlot] = false;
+    bool wasBlocked = plr->cold->isBuddyBlocked[resp.iBuddySlot];
+    plr->cold->buddyIDs[resp.iBuddySlot] = 0;
+    plr->cold->isBuddyBlocked[resp.iBuddySlot] = false;
 
     sock->sendPacket((void*)&resp, P_FE2CL_REP_REMOVE_BUDDY_SUCC, sizeof(sP_FE2CL_REP_REMOVE_BUDDY_SUCC));
     
@@ -497,16 +526,16 @@ void BuddyManager::reqBuddyDelete(CNSocket* sock, CNPacketData* data) {
         return;
 
     // remove buddy on their side, reusing the struct
-    CNSocket* otherSock = PlayerManager::getSockFromID(pkt->iBuddyPCUID);
+    CNSocket* otherSock = PlayerManager::getSockFromUID(pkt->iBuddyPCUID);
     if (otherSock == nullptr)
         return; // other player isn't online, no broadcast needed
     Player* otherPlr = PlayerManager::getPlayer(otherSock);
     // search for the slot with the requesting player's ID
     resp.iBuddyPCUID = plr->PCStyle.iPC_UID;
     for (int i = 0; i < 50; i++) {
-        if (otherPlr->buddyIDs[i] == plr->PCStyle.iPC_UID) {
+        if (otherPlr->cold->buddyIDs[i] == plr->PCStyle.iPC_UID) {
             // remove buddy
-            otherPlr->buddyIDs[i] = 0;
+            otherPlr->cold->buddyIDs[i] = 0;
             // broadcast
             resp.iBuddySlot = i;
             otherSock->sendPacket((void*)&resp, P_FE2CL_REP_REMOVE_BUDDY_SUCC, sizeof(sP_FE2CL_REP_REMOVE_BUDDY_SUCC));
@@ -562,7 +591,7 @@ void BuddyManager::emailUpdateCheck(CNSocket* sock, CNPacketData* data) {
         return; // malformed packet
 
     INITSTRUCT(sP_FE2CL_REP_PC_NEW_EMAIL, resp);
-    resp.iNewEmailCnt = Database::getUnreadEmailCount(PlayerManager::getPlayer(sock)->iID);
+    resp.iNewEmailCnt = Inbox::unreadCount(PlayerManager::getPlayer(sock)->iID);
     sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_NEW_EMAIL, sizeof(sP_FE2CL_REP_PC_NEW_EMAIL));
 }
 
@@ -575,7 +604,7 @@ void BuddyManager::emailReceivePageList(CNSocket* sock, CNPacketData* data) {
     INITSTRUCT(sP_FE2CL_REP_PC_RECV_EMAIL_PAGE_LIST_SUCC, resp);
     resp.iPageNum = pkt->iPageNum;
 
-    std::vector<Database::EmailData> emails = Database::getEmails(PlayerManager::getPlayer(sock)->iID, pkt->iPageNum);
+    std::vector<Database::EmailData> emails = Inbox::getPage(PlayerManager::getPlayer(sock)->iID, pkt->iPageNum);
     for (int i = 0; i < emails.size(); i++) {
         // convert each email and load them into the packet
         Database::EmailData* email = &emails.at(i);
@@ -603,10 +632,11 @@ void BuddyManager::emailRead(CNSocket* sock, CNPacketData* data) {
 
     Player* plr = PlayerManager::getPlayer(sock);
 
-    Database::EmailData email = Database::getEmail(plr->iID, pkt->iEmailIndex);
-    sItemBase* attachments = Database::getEmailAttachments(plr->iID, pkt->iEmailIndex);
-    email.ReadFlag = 1; // mark as read
-    Database::updateEmailContent(&email);
+    // marks it as read
+    Database::EmailData email;
+    sItemBase attachments[4];
+    if (!Inbox::read(plr->iID, pkt->iEmailIndex, &email, attachments))
+        return; // email not found
 
     INITSTRUCT(sP_FE2CL_REP_PC_READ_EMAIL_SUCC, resp);
     resp.iEmailIndex = pkt->iEmailIndex;
@@ -627,12 +657,11 @@ void BuddyManager::emailReceiveTaros(CNSocket* sock, CNPacketData* data) {
 
     Player* plr = PlayerManager::getPlayer(sock);
 
-    Database::EmailData email = Database::getEmail(plr->iID, pkt->iEmailIndex);
     // money transfer
-    plr->money += email.Taros;
-    email.Taros = 0;
-    // update Taros in email
-    Database::updateEmailContent(&email);
+    int taros;
+    if (!Inbox::takeTaros(plr->iID, pkt->iEmailIndex, &taros))
+        return; // email not found
+    plr->money += taros;
 
     INITSTRUCT(sP_FE2CL_REP_PC_RECV_EMAIL_CANDY_SUCC, resp);
     resp.iCandy = plr->money;
@@ -648,15 +677,16 @@ void BuddyManager::emailReceiveItemSingle(CNSocket* sock, CNPacketData* data) {
     sP_CL2FE_REQ_PC_RECV_EMAIL_ITEM* pkt = (sP_CL2FE_REQ_PC_RECV_EMAIL_ITEM*)data->buf;
     Player* plr = PlayerManager::getPlayer(sock);
 
-    // get email item from db and delete it
-    sItemBase* attachments = Database::getEmailAttachments(plr->iID, pkt->iEmailIndex);
-    sItemBase itemFrom = attachments[pkt->iEmailItemSlot - 1];
-    Database::deleteEmailAttachments(plr->iID, pkt->iEmailIndex, pkt->iEmailItemSlot);
-
-    // move item to player inventory
     if (pkt->iSlotNum < 0 || pkt->iSlotNum >= AINVEN_COUNT)
         return; // sanity check
-    sItemBase& itemTo = plr->Inven[pkt->iSlotNum];
+
+    // take the item out of the email
+    sItemBase itemFrom;
+    if (!Inbox::takeItem(plr->iID, pkt->iEmailIndex, pkt->iEmailItemSlot, &itemFrom))
+        return; // email or slot not found
+
+    // move item to player inventory
+    sItemBase& itemTo = plr->cold->Inven[pkt->iSlotNum];
     itemTo.iID = itemFrom.iID;
     itemTo.iOpt = itemFrom.iOpt;
     itemTo.iTimeLimit = itemFrom.iTimeLimit;
@@ -686,7 +716,9 @@ void BuddyManager::emailReceiveItemAll(CNSocket* sock, CNPacketData* data) {
 
     // move items to player inventory
     Player* plr = PlayerManager::getPlayer(sock);
-    sItemBase* itemsFrom = Database::getEmailAttachments(plr->iID, pkt->iEmailIndex);
+    sItemBase itemsFrom[4];
+    if (!Inbox::takeAllItems(plr->iID, pkt->iEmailIndex, itemsFrom))
+        return; // email not found
     for (int i = 0; i < 4; i++) {
         int slot = ItemManager::findFreeSlot(plr);
         if (slot < 0 || slot >= AINVEN_COUNT) {
@@ -698,7 +730,7 @@ void BuddyManager::emailReceiveItemAll(CNSocket* sock, CNPacketData* data) {
 
         // copy data over
         sItemBase itemFrom = itemsFrom[i];
-        sItemBase& itemTo = plr->Inven[slot];
+        sItemBase& itemTo = plr->cold->Inven[slot];
         itemTo.iID = itemFrom.iID;
         itemTo.iOpt = itemFrom.iOpt;
         itemTo.iTimeLimit = itemFrom.iTimeLimit;
@@ -713,9 +745,6 @@ void BuddyManager::emailReceiveItemAll(CNSocket* sock, CNPacketData* data) {
         sock->sendPacket((void*)&resp2, P_FE2CL_REP_PC_GIVE_ITEM_SUCC, sizeof(sP_FE2CL_REP_PC_GIVE_ITEM_SUCC));
     }
 
-    // delete all items from db
-    Database::deleteEmailAttachments(plr->iID, pkt->iEmailIndex, -1);
-
     INITSTRUCT(sP_FE2CL_REP_PC_RECV_EMAIL_ITEM_ALL_SUCC, resp);
     resp.iEmailIndex = pkt->iEmailIndex;
 
@@ -728,7 +757,7 @@ void BuddyManager::emailDelete(CNSocket* sock, CNPacketData* data) {
 
     sP_CL2FE_REQ_PC_DELETE_EMAIL* pkt = (sP_CL2FE_REQ_PC_DELETE_EMAIL*)data->buf;
 
-    Database::deleteEmails(PlayerManager::getPlayer(sock)->iID, pkt->iEmailIndexArray);
+    Inbox::remove(PlayerManager::getPlayer(sock)->iID, pkt->iEmailIndexArray);
 
     INITSTRUCT(sP_FE2CL_REP_PC_DELETE_EMAIL_SUCC, resp);
     for (int i = 0; i < 5; i++) {
@@ -749,9 +778,13 @@ void BuddyManager::emailSend(CNSocket* sock, CNPacketData* data) {
 
     if (pkt->iCash || pkt->aItem[0].ItemInven.iID) {
         // if there are item or taro attachments
-        Player otherPlr = {};
-        Database::getPlayer(&otherPlr, pkt->iTo_PCUID);
-        if (otherPlr.iID != 0 && plr->PCStyle2.iPayzoneFlag != otherPlr.PCStyle2.iPayzoneFlag) {
+        Player* online = PlayerManager::getPlayerFromID(pkt->iTo_PCUID);
+        std::vector<Database::PlayerSummary> other;
+        if (online == nullptr)
+            other = Database::getPlayerSummaries({(int)pkt->iTo_PCUID});
+
+        int otherPayzone = online != nullptr ? online->PCStyle2.iPayzoneFlag : (other.empty() ? -1 : other[0].PCStyle2.iPayzoneFlag);
+        if (otherPayzone != -1 && plr->PCStyle2.iPayzoneFlag != otherPayzone) {
             // if the players are not in the same time period
             INITSTRUCT(sP_FE2CL_REP_PC_SEND_EMAIL_FAIL, resp);
             resp.iErrorCode = 9; // error code 9 tells the player they can't send attachments across time
@@ -773,14 +806,14 @@ void BuddyManager::emailSend(CNSocket* sock, CNPacketData* data) {
         attachments.push_back(attachment.ItemInven);
         attSlots.push_back(attachment.iSlotNum);
         // delete item
-        plr->Inven[attachment.iSlotNum] = { 0, 0, 0, 0 };
+        plr->cold->Inven[attachment.iSlotNum] = { 0, 0, 0, 0 };
     }
 
     int cost = pkt->iCash + 50 + 20 * attachments.size(); // attached taros + postage
     plr->money -= cost;
     Database::EmailData email = {
         (int)pkt->iTo_PCUID, // PlayerId
-        Database::getNextEmailIndex(pkt->iTo_PCUID), // MsgIndex
+        0, // MsgIndex (picked by Inbox::send)
         0, // ReadFlag (unread)
         (pkt->iCash > 0 || attachments.size() > 0) ? 1 : 0, // ItemFlag
         plr->iID, // SenderID
@@ -793,12 +826,12 @@ void BuddyManager::emailSend(CNSocket* sock, CNPacketData* data) {
         0 // DeleteTime (unimplemented)
     };
 
-    if (!Database::sendEmail(&email, attachments)) {
+    if (!Inbox::send(&email, attachments)) {
         plr->money += cost; // give money back
         // give items back
         while (!attachments.empty()) {
             sItemBase attachment = attachments.back();
-            plr->Inven[attSlots.back()] = attachment;
+            plr->cold->Inven[attSlots.back()] = attachment;
 
             attachments.pop_back();
             attSlots.pop_back();
@@ -830,7 +863,7 @@ void BuddyManager::emailSend(CNSocket* sock, CNPacketData* data) {
 int BuddyManager::getAvailableBuddySlot(Player* plr) {
     int slot = -1;
     for (int i = 0; i < 50; i++) {
-        if (plr->buddyIDs[i] == 0)
+        if (plr->cold->buddyIDs[i] == 0)
             return i;
     }
     return slot;
@@ -838,7 +871,7 @@ int BuddyManager::getAvailableBuddySlot(Player* plr) {
 
 bool BuddyManager::playerHasBuddyWithID(Player* plr, int buddyID) {
     for (int i = 0; i < 50; i++) {
-        if (plr->buddyIDs[i] == buddyID)
+        if (plr->cold->buddyIDs[i] == buddyID)
             return true;
     }
     return false;
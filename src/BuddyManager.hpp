@@ -4,15 +4,18 @@
 #include "CNProtocol.hpp"
 #include "CNStructs.hpp"
 #include "CNShardServer.hpp"
+#include "Database.hpp"
 
 #include <map>
 #include <list>
+#include <vector>
 
 namespace BuddyManager {
 	void init();
 
 	// Buddy list
-	void refreshBuddyList(CNSocket* sock);
+	// prefetched: buddy summaries loaded by the login server; offline buddies found there aren't fetched again
+	void refreshBuddyList(CNSocket* sock, const std::vector<Database::PlayerSummary>* prefetched = nullptr);
 
 	// Buddy requests
 	void requestBuddy(CNSocket* sock, CNPacketData* data);
@@ -4,7 +4,9 @@
 #include "Database.hpp"
 #include "PlayerManager.hpp"
 #include "ItemManager.hpp"
+#include "RacingManager.hpp"
 #include <regex>
+#include <climits>
 #include "contrib/bcrypt/BCrypt.hpp"
 
 #include "settings.hpp"
@@ -394,9 +396,9 @@ void CNLoginServer::characterCreate(CNSocket* sock, CNPacketData* data) {
     resp.sPC_Style = player.PCStyle;
     resp.sPC_Style2 = player.PCStyle2;
     resp.iLevel = player.level;
-    resp.sOn_Item.iEquipUBID = player.Equip[1].iID;
-    resp.sOn_Item.iEquipLBID = player.Equip[2].iID;
-    resp.sOn_Item.iEquipFootID = player.Equip[3].iID;
+    resp.sOn_Item.iEquipUBID = player.cold->Equip[1].iID;
+    resp.sOn_Item.iEquipLBID = player.cold->Equip[2].iID;
+    resp.sOn_Item.iEquipFootID = player.cold->Equip[3].iID;
 
     loginSessions[sock].lastHeartbeat = getTime();
 
@@ -432,6 +434,7 @@ void CNLoginServer::characterDelete(CNSocket* sock, CNPacketData* data) {
     int removedSlot = Database::deleteCharacter(del->iPC_UID, loginSessions[sock].userID);
     if (removedSlot == 0)
         return invalidCharacter(sock);
+    RacingManager::forgetPlayer(del->iPC_UID);
 
     INITSTRUCT(sP_LS2CL_REP_CHAR_DELETE_SUCC, resp);
     resp.iSlotNum = removedSlot;
@@ -476,6 +479,17 @@ void CNLoginServer::characterSelect(CNSocket* sock, CNPacketData* data) {
     resp.iEnterSerialKey = passPlayer.iID;
     CNSharedData::setPlayer(resp.iEnterSerialKey, passPlayer);
 
+    // load the buddy list now too, while the client is still connecting to the shard
+    std::vector<int> buddyIDs;
+    for (int i = 0; i < 50; i++)
+        if (passPlayer.cold->buddyIDs[i] != 0)
+            buddyIDs.push_back(passPlayer.cold->buddyIDs[i]);
+    CNSharedData::setBuddies(resp.iEnterSerialKey, Database::getPlayerSummaries(buddyIDs));
+
+    // and their mail
+    CNSharedData::beginInbox(resp.iEnterSerialKey);
+    CNSharedData::setInbox(resp.iEnterSerialKey, Database::getEmails(passPlayer.iID, INT_MAX, -1));
+
     sock->sendPacket((void*)&resp, P_LS2CL_REP_SHARD_SELECT_SUCC, sizeof(sP_LS2CL_REP_SHARD_SELECT_SUCC));
     
     // update current slot in DB
@@ -7,6 +7,8 @@
 #include "settings.hpp"
 #include "Database.hpp"
 #include "Monitor.hpp"
+#include "SaveQueue.hpp"
+#include "Journal.hpp"
 #include "TableData.hpp" // for flush()
 
 #include <iostream>
@@ -53,17 +55,21 @@ void CNShardServer::keepAliveTimer(CNServer* serv, time_t currTime) {
 }
 
 void CNShardServer::periodicSaveTimer(CNServer* serv, time_t currTime) {
-    if (PlayerManager::players.empty())
+    if (PlayerManager::players.empty()) {
+        Journal::checkpoint(); // logouts may still be in the journal
         return;
-
-    std::cout << "[INFO] Saving " << PlayerManager::players.size() << " players to DB..." << std::endl;
-
-    for (auto& pair : PlayerManager::players) {
-        Database::updatePlayer(pair.second);
     }
 
+    // the writes happen on the save thread; this only copies the players
+    for (auto& pair : PlayerManager::players)
+        SaveQueue::push(pair.second);
+    Journal::checkpoint();
+
     TableData::flush();
-    std::cout << "[INFO] Done." << std::endl;
+
+    SaveQueue::Stats stats = SaveQueue::getStats();
+    std::cout << "[INFO] Queued " << PlayerManager::players.size() << " players for saving (" << stats.depth
+        << " waiting, peak " << stats.peakDepth << ", last batch took " << stats.lastBatchMicros / 1000 << "ms)" << std::endl;
 }
 
 bool CNShardServer::checkExtraSockets(int i) {
@@ -97,6 +103,7 @@ void CNShardServer::killConnection(CNSocket *cns) {
 // flush the DB when terminating the server
 void CNShardServer::kill() {
     periodicSaveTimer(nullptr, 0);
+    SaveQueue::flush();
     CNServer::kill();
 }
 
@@ -1,27 +1,92 @@
 #include "CNShared.hpp"
+#include "PlayerSnapshot.hpp"
 
 #if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
     #include "mingw/mingw.mutex.h"
 #else
     #include <mutex>
 #endif
-std::map<int64_t, Player> CNSharedData::players;
+std::map<int64_t, std::vector<uint8_t>> CNSharedData::players;
+static std::map<int64_t, std::vector<Database::PlayerSummary>> buddies;
+static std::map<int64_t, std::map<int, Database::EmailData>> inboxes;
 std::mutex playerCrit;
 
 void CNSharedData::setPlayer(int64_t sk, Player& plr) {
     std::lock_guard<std::mutex> lock(playerCrit); // the lock will be removed when the function ends
 
-    players[sk] = plr;
+    PlayerSnapshot::serialize(&plr, players[sk]);
 }
 
 Player CNSharedData::getPlayer(int64_t sk) {
     std::lock_guard<std::mutex> lock(playerCrit); // the lock will be removed when the function ends
 
-    return players[sk];
+    Player plr = {};
+    auto it = players.find(sk);
+    if (it != players.end())
+        PlayerSnapshot::deserialize(it->second.data(), it->second.size(), &plr);
+
+    return plr;
 }
 
 void CNSharedData::erasePlayer(int64_t sk) {
     std::lock_guard<std::mutex> lock(playerCrit); // the lock will be removed when the function ends
 
     players.erase(sk);
+    buddies.erase(sk);
+    inboxes.erase(sk);
+}
+
+void CNSharedData::setBuddies(int64_t sk, std::vector<Database::PlayerSummary> list) {
+    std::lock_guard<std::mutex> lock(playerCrit);
+
+    buddies[sk] = std::move(list);
+}
+
+std::vector<Database::PlayerSummary> CNSharedData::takeBuddies(int64_t sk) {
+    std::lock_guard<std::mutex> lock(playerCrit);
+
+    std::vector<Database::PlayerSummary> ret;
+    auto it = buddies.find(sk);
+    if (it != buddies.end()) {
+        ret = std::move(it->second);
+        buddies.erase(it);
+    }
+
+    return ret;
+}
+
+void CNSharedData::beginInbox(int64_t sk) {
+    std::lock_guard<std::mutex> lock(playerCrit);
+
+    inboxes[sk].clear();
+}
+
+void CNSharedData::setInbox(int64_t sk, std::vector<Database::EmailData> headers) {
+    std::lock_guard<std::mutex> lock(playerCrit);
+
+    std::map<int, Database::EmailData>& inbox = inboxes[sk];
+    for (Database::EmailData& header : headers)
+        inbox[header.MsgIndex] = std::move(header);
+}
+
+void CNSharedData::addMail(int64_t sk, const Database::EmailData& header) {
+    std::lock_guard<std::mutex> lock(playerCrit);
+
+    // only while the login server is handing them over
+    auto it = inboxes.find(sk);
+    if (it != inboxes.end())
+        it->second[header.MsgIndex] = header;
+}
+
+bool CNSharedData::takeInbox(int64_t sk, std::vector<Database::EmailData>* headers) {
+    std::lock_guard<std::mutex> lock(playerCrit);
+
+    auto it = inboxes.find(sk);
+    if (it == inboxes.end())
+        return false;
+
+    for (auto& pair : it->second)
+        headers->push_back(std::move(pair.second));
+    inboxes.erase(it);
+    return true;
 }
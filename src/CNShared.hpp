@@ -7,14 +7,31 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "Player.hpp"
+#include "Database.hpp"
 
 namespace CNSharedData {
-    // serialkey corresponds to player data
-    extern std::map<int64_t, Player> players;
+    // serialkey corresponds to player data, kept as a PlayerSnapshot record
+    extern std::map<int64_t, std::vector<uint8_t>> players;
 
     void setPlayer(int64_t sk, Player& plr);
     Player getPlayer(int64_t sk);
     void erasePlayer(int64_t sk);
+
+    // buddy list entries loaded ahead of time by the login server, so entering the shard doesn't hit the DB
+    void setBuddies(int64_t sk, std::vector<Database::PlayerSummary> buddies);
+    std::vector<Database::PlayerSummary> takeBuddies(int64_t sk);
+
+    /*
+     * Mail headers, loaded the same way. beginInbox() goes before the read, so
+     * anything the shard sends them from then on is kept with addMail() (serial
+     * keys are player IDs); whatever the read already saw is merged by MsgIndex.
+     */
+    void beginInbox(int64_t sk);
+    void setInbox(int64_t sk, std::vector<Database::EmailData> headers);
+    void addMail(int64_t sk, const Database::EmailData& header);
+    // false if nothing was loaded for them
+    bool takeInbox(int64_t sk, std::vector<Database::EmailData>* headers);
 }
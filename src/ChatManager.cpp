@@ -9,10 +9,23 @@
 #include "MissionManager.hpp"
 #include "ChunkManager.hpp"
 #include "ItemManager.hpp"
+#include "WorkerPool.hpp"
+#include "Rand.hpp"
+#include "Database.hpp"
+#include "SaveQueue.hpp"
+#include "PlayerSnapshot.hpp"
 
 #include <sstream>
 #include <iterator>
 #include <math.h>
+#include <chrono>
+#include <limits.h>
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.thread.h"
+#else
+    #include <thread>
+#endif
 
 std::map<std::string, ChatCommand> ChatManager::commands;
 std::vector<std::string> ChatManager::dump;
@@ -210,7 +223,7 @@ void summonWCommand(std::string full, std::vector<std::string>& args, CNSocket*
         return;
     }
 
-    int limit = NPCManager::NPCData.back()["m_iNpcNumber"];
+    int limit = NPCManager::MobTemplates.back().type;
 
     // permission & sanity check
     if (type > limit)
@@ -295,6 +308,10 @@ void unsummonWCommand(std::string full, std::vector<std::string>& args, CNSocket
 void toggleAiCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
     MobManager::simulateMobs = !MobManager::simulateMobs;
 
+    // sleeping mobs need to notice the change either way
+    for (auto& pair : MobManager::Mobs)
+        MobManager::wakeMob(pair.second);
+
     if (MobManager::simulateMobs)
         return;
 
@@ -430,18 +447,18 @@ void minfoCommand(std::string full, std::vector<std::string>& args, CNSocket* so
     for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
         if (plr->tasks[i] != 0) {
             TaskData& task = *MissionManager::Tasks[plr->tasks[i]];
-            if ((int)(task["m_iHMissionID"]) == plr->CurrentMissionID) {
+            if (task.missionID == plr->CurrentMissionID) {
                 ChatManager::sendServerMessage(sock, "[MINFO] Current task ID: " + std::to_string(plr->tasks[i]));
-                ChatManager::sendServerMessage(sock, "[MINFO] Current task type: " + std::to_string((int)(task["m_iHTaskType"])));
-                ChatManager::sendServerMessage(sock, "[MINFO] Current waypoint NPC ID: " + std::to_string((int)(task["m_iSTGrantWayPoint"])));
-                ChatManager::sendServerMessage(sock, "[MINFO] Current terminator NPC ID: " + std::to_string((int)(task["m_iHTerminatorNPCID"])));
+                ChatManager::sendServerMessage(sock, "[MINFO] Current task type: " + std::to_string(task.taskType));
+                ChatManager::sendServerMessage(sock, "[MINFO] Current waypoint NPC ID: " + std::to_string(task.stGrantWayPoint));
+                ChatManager::sendServerMessage(sock, "[MINFO] Current terminator NPC ID: " + std::to_string(task.terminatorNPCID));
 
-                if ((int)(task["m_iSTGrantTimer"]) != 0)
-                    ChatManager::sendServerMessage(sock, "[MINFO] Current task timer: " + std::to_string((int)(task["m_iSTGrantTimer"])));
+                if (task.stGrantTimer != 0)
+                    ChatManager::sendServerMessage(sock, "[MINFO] Current task timer: " + std::to_string(task.stGrantTimer));
 
                 for (int j = 0; j < 3; j++)
-                    if ((int)(task["m_iCSUEnemyID"][j]) != 0)
-                        ChatManager::sendServerMessage(sock, "[MINFO] Current task mob #" + std::to_string(j+1) +": " + std::to_string((int)(task["m_iCSUEnemyID"][j])));
+                    if (task.csuEnemyID[j] != 0)
+                        ChatManager::sendServerMessage(sock, "[MINFO] Current task mob #" + std::to_string(j+1) +": " + std::to_string(task.csuEnemyID[j]));
 
                 return;
             }
@@ -456,7 +473,7 @@ void tasksCommand(std::string full, std::vector<std::string>& args, CNSocket* so
     for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
         if (plr->tasks[i] != 0) {
             TaskData& task = *MissionManager::Tasks[plr->tasks[i]];
-            ChatManager::sendServerMessage(sock, "[TASK-" + std::to_string(i) + "] mission ID: " + std::to_string((int)(task["m_iHMissionID"])));
+            ChatManager::sendServerMessage(sock, "[TASK-" + std::to_string(i) + "] mission ID: " + std::to_string(task.missionID));
             ChatManager::sendServerMessage(sock, "[TASK-" + std::to_string(i) + "] task ID: " + std::to_string(plr->tasks[i]));
         }
     }
@@ -497,8 +514,7 @@ void eggCommand(std::string full, std::vector<std::string>& args, CNSocket* sock
         return;
     }
 
-    assert(NPCManager::nextId < INT32_MAX);
-    int id = NPCManager::nextId++;
+    int32_t id = NPCManager::NPCs.allocate();
 
     Player* plr = PlayerManager::getPlayer(sock);
 
@@ -556,7 +572,7 @@ void summonGroupCommand(std::string full, std::vector<std::string>& args, CNSock
         return;
     }
 
-    int limit = NPCManager::NPCData.back()["m_iNpcNumber"];
+    int limit = NPCManager::MobTemplates.back().type;
 
     // permission & sanity check
     if (type > limit || type2 > limit || count > 5) {
@@ -567,7 +583,7 @@ void summonGroupCommand(std::string full, std::vector<std::string>& args, CNSock
     Mob* leadNpc = nullptr;
 
     for (int i = 0; i < count; i++) {
-        int team = NPCManager::NPCData[type]["m_iTeam"];
+        int team = NPCManager::MobTemplates[type].team;
         int x = plr->x;
         int y = plr->y;
         int z = plr->z;
@@ -662,6 +678,442 @@ void whoisCommand(std::string full, std::vector<std::string>& args, CNSocket* so
     ChatManager::sendServerMessage(sock, "[WHOIS] Instance: " + std::to_string(PLAYERID(npc->instanceID)));
 }
 
+/*
+ * Reports the chunk configuration of the current map along with the broadcast
+ * fan-out (how many players/NPCs a packet from here would reach) at several view radii.
+ */
+void chunkInfoCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
+    Player* plr = PlayerManager::getPlayer(sock);
+    int radius = ChunkManager::getViewRadius(plr->instanceID);
+
+    ChatManager::sendServerMessage(sock, "[CHUNK] Map " + std::to_string(MAPNUM(plr->instanceID)) + ": chunk size "
+        + std::to_string(ChunkManager::getChunkSize(plr->instanceID)) + ", view radius " + std::to_string(radius));
+
+    for (int r = 0; r <= std::max(radius + 1, 3); r++) {
+        std::set<Chunk*> chnks = ChunkManager::getViewableChunks(plr->chunkPos, r);
+        int players = 0, npcs = 0;
+
+        for (Chunk* chunk : chnks) {
+            players += chunk->players.size();
+            npcs += chunk->NPCs.size();
+        }
+
+        ChatManager::sendServerMessage(sock, "[CHUNK] radius " + std::to_string(r) + (r == radius ? " (current)" : "") + ": "
+            + std::to_string(chnks.size()) + " chunks, " + std::to_string(players - 1) + " players, " + std::to_string(npcs) + " NPCs");
+    }
+}
+
+/*
+ * Times the batched aggro kernel against the old per-pair hypot() scan on
+ * synthetic mobs and players spread over a 3x3 chunk area.
+ */
+void aggroBenchCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
+    int mobCount = 10000, playerCount = 50;
+    char *tmp;
+
+    if (args.size() > 1) {
+        mobCount = std::strtol(args[1].c_str(), &tmp, 10);
+        if (*tmp || mobCount <= 0 || mobCount > 10000)
+            return;
+    }
+    if (args.size() > 2) {
+        playerCount = std::strtol(args[2].c_str(), &tmp, 10);
+        if (*tmp || playerCount <= 0 || playerCount > 1000)
+            return;
+    }
+
+    // a fixed seed of its own, so every run places the same mobs and the shard's streams don't move
+    Xoshiro256 rng(0xA66B0);
+    auto roll = [&rng](int bound) { return (int)(rng.next() % bound); };
+
+    int area = settings::CHUNKSIZE * 3;
+    std::vector<Player> players(playerCount);
+    AggroCandidates cands;
+    MobBatch batch;
+
+    for (Player& plr : players) {
+        plr.HP = 1;
+        plr.x = roll(area);
+        plr.y = roll(area);
+        plr.z = roll(2000);
+
+        cands.x.push_back(plr.x);
+        cands.y.push_back(plr.y);
+        cands.z.push_back(plr.z);
+        cands.rangeScale.push_back(roll(10) == 0 ? 1.0f / 3 : 1.0f);
+        cands.socks.push_back(nullptr);
+        cands.players.push_back(&plr);
+    }
+
+    for (int i = 0; i < mobCount; i++) {
+        batch.x.push_back(roll(area));
+        batch.y.push_back(roll(area));
+        batch.z.push_back(roll(2000));
+        batch.sightRange.push_back(1000 + roll(3000));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    int scalarHits = 0;
+    for (int m = 0; m < mobCount; m++) {
+        int closestDistance = INT_MAX;
+        bool found = false;
+
+        for (int i = 0; i < playerCount; i++) {
+            int mobRange = batch.sightRange[m];
+            if (cands.rangeScale[i] < 1.0f)
+                mobRange /= 3;
+
+            int xyDistance = hypot(batch.x[m] - cands.x[i], batch.y[m] - cands.y[i]);
+            int distance = hypot(xyDistance, (batch.z[m] - cands.z[i]) * 2);
+
+            if (distance > mobRange || distance > closestDistance)
+                continue;
+
+            closestDistance = distance;
+            found = true;
+        }
+
+        scalarHits += found;
+    }
+
+    auto mid = std::chrono::steady_clock::now();
+
+    std::vector<int> targets;
+    MobManager::nearestAggroTargets(batch, cands, targets);
+
+    auto end = std::chrono::steady_clock::now();
+
+    int batchHits = 0;
+    for (int t : targets)
+        batchHits += t != -1;
+
+    auto scalarUs = std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count();
+    auto batchUs = std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count();
+
+    ChatManager::sendServerMessage(sock, "[AGGRO] " + std::to_string(mobCount) + " mobs x " + std::to_string(playerCount) + " players");
+    ChatManager::sendServerMessage(sock, "[AGGRO] scalar: " + std::to_string(scalarUs) + "us, " + std::to_string(scalarHits) + " aggroed");
+    ChatManager::sendServerMessage(sock, "[AGGRO] batched: " + std::to_string(batchUs) + "us, " + std::to_string(batchHits) + " aggroed");
+
+    /*
+     * Scaling: the same mobs split into per-chunk-sized slices and spread over
+     * 1..N threads, like aggroStep() does. The candidates were already padded by
+     * the run above, so the kernel only reads them from here on.
+     */
+    const int sliceSize = 64;
+    std::vector<MobBatch> slices((mobCount + sliceSize - 1) / sliceSize);
+    for (int i = 0; i < mobCount; i++) {
+        MobBatch& slice = slices[i / sliceSize];
+        slice.x.push_back(batch.x[i]);
+        slice.y.push_back(batch.y[i]);
+        slice.z.push_back(batch.z[i]);
+        slice.sightRange.push_back(batch.sightRange[i]);
+    }
+
+    int maxThreads = std::max({ settings::MOBTHREADS, (int)std::thread::hardware_concurrency(), 1 });
+    std::vector<std::vector<int>> sliceTargets(slices.size());
+    std::string scaling;
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        WorkerPool pool(threads);
+
+        auto parStart = std::chrono::steady_clock::now();
+        pool.parallelFor(slices.size(), [&](size_t i) {
+            MobManager::nearestAggroTargets(slices[i], cands, sliceTargets[i]);
+        });
+        auto parUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - parStart).count();
+
+        scaling += (scaling.empty() ? "" : ", ") + std::to_string(threads) + "t " + std::to_string(parUs) + "us";
+    }
+
+    ChatManager::sendServerMessage(sock, "[AGGRO] threads: " + scaling);
+}
+
+void mobInfoCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
+    MobStepStats& stats = MobManager::StepStats;
+
+    ChatManager::sendServerMessage(sock, "[MOBINFO] Mobs: " + std::to_string(MobManager::Mobs.size())
+        + ", templates: " + std::to_string(NPCManager::MobTemplates.size())
+        + " (" + std::to_string(NPCManager::MobTemplates.size() * sizeof(MobTemplate)) + " bytes)");
+
+    if (stats.steps == 0)
+        return;
+
+    ChatManager::sendServerMessage(sock, "[MOBINFO] Steps: " + std::to_string(stats.steps)
+        + ", avg: " + std::to_string(stats.totalMicros / stats.steps) + "us"
+        + ", max: " + std::to_string(stats.maxMicros) + "us");
+    ChatManager::sendServerMessage(sock, "[MOBINFO] Wakes per step: avg " + std::to_string(stats.wakes / stats.steps)
+        + ", max " + std::to_string(stats.maxWakes) + "; wake queue: " + std::to_string(stats.queued));
+    ChatManager::sendServerMessage(sock, "[MOBINFO] Instances queued: " + std::to_string(stats.instances)
+        + ", instance turns deferred: " + std::to_string(stats.deferred)
+        + ", handed back to the shard thread: " + std::to_string(stats.posted));
+
+    // reset so the next reading covers a fresh window
+    if (args.size() > 1 && args[1] == "reset")
+        stats = {};
+}
+
+/*
+ * A character of its own for /dbbench to write over. SaveQueue only writes what
+ * changed since its last save of a player, so a full save of someone online
+ * from anywhere else would leave it believing rows that are no longer there.
+ * The login and name can't be typed into the client, so nobody else ends up
+ * with either.
+ */
+static int scratchCharacter(int* accountId) {
+    Database::Account account = {};
+    Database::findAccount(&account, "#dbbench");
+    if (account.AccountID == 0)
+        account.AccountID = Database::addAccount("#dbbench", "#dbbench");
+    if (account.AccountID == 0)
+        return 0;
+    *accountId = account.AccountID;
+
+    // an interrupted run may have left one behind
+    std::vector<sP_LS2CL_REP_CHAR_INFO> characters;
+    Database::getCharInfo(&characters, account.AccountID);
+    for (sP_LS2CL_REP_CHAR_INFO& character : characters)
+        Database::deleteCharacter(character.sPC_Style.iPC_UID, account.AccountID);
+
+    INITSTRUCT(sP_CL2LS_REQ_SAVE_CHAR_NAME, save);
+    save.iSlotNum = 1;
+    save.iFNCode = 1;
+    U8toU16("#dbbench", save.szFirstName, sizeof(save.szFirstName));
+    U8toU16("scratch", save.szLastName, sizeof(save.szLastName));
+    return Database::createCharacter(&save, account.AccountID);
+}
+
+/*
+ * Times saving and loading a copy of your character with and without the prepared
+ * statement cache. The saves are real, so this writes to the live database.
+ */
+void dbBenchCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
+    Player* plr = PlayerManager::getPlayer(sock);
+    int count = 50;
+    char *tmp;
+
+    if (args.size() > 1) {
+        count = std::strtol(args[1].c_str(), &tmp, 10);
+        if (*tmp || count <= 0 || count > 1000)
+            return;
+    }
+
+    // your character's contents, saved under the scratch one
+    int accountId = 0;
+    Player bench = *plr;
+    bench.iID = scratchCharacter(&accountId);
+    if (bench.iID == 0) {
+        ChatManager::sendServerMessage(sock, "[DBBENCH] couldn't make a scratch character");
+        return;
+    }
+    bench.accountId = accountId;
+    bench.slot = 1;
+
+    for (int cached = 0; cached < 2; cached++) {
+        Database::setStatementCache(cached);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+            Database::updatePlayer(&bench);
+        auto saved = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            Player loaded = {};
+            Database::getPlayer(&loaded, bench.iID);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        long saveMicros = std::chrono::duration_cast<std::chrono::microseconds>(saved - start).count();
+        long loadMicros = std::chrono::duration_cast<std::chrono::microseconds>(end - saved).count();
+        ChatManager::sendServerMessage(sock, std::string("[DBBENCH] ") + (cached ? "cached" : "uncached")
+            + ": save " + std::to_string(saveMicros / count) + "us, load " + std::to_string(loadMicros / count) + "us");
+    }
+
+    Database::deleteCharacter(bench.iID, accountId);
+}
+
+/*
+ * Round-trips randomized characters through PlayerSnapshot: each one has to come
+ * back field for field and re-encode to the same bytes, and every truncation of
+ * its record, a bad magic and a newer version all have to be turned away.
+ */
+void snapCheckCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
+    int count = 200;
+    char *tmp;
+
+    if (args.size() > 1) {
+        count = std::strtol(args[1].c_str(), &tmp, 10);
+        if (*tmp || count <= 0 || count > 1000)
+            return;
+    }
+
+    // a fixed seed, so a failure shows up the same way on the next run
+    Xoshiro256 rng(0x5EED);
+    auto roll = [&rng](int bound) { return (int)(rng.next() % bound); };
+    auto randomItem = [&]() {
+        return sItemBase{ (int16_t)roll(10), (int16_t)(1 + roll(1000)), (int32_t)rng.next(), (int32_t)rng.next() };
+    };
+
+    int failed = 0, rejected = 0;
+    size_t totalBytes = 0;
+    uint64_t encodeMicros = 0, decodeMicros = 0;
+    std::vector<uint8_t> record, again;
+
+    for (int n = 0; n < count; n++) {
+        Player plr = {};
+        PlayerCold& cold = *plr.cold;
+
+        plr.iID = (int32_t)rng.next();
+        plr.accountId = (int)rng.next();
+        plr.accountLevel = roll(100);
+        plr.slot = roll(4);
+        plr.SerialKey = (int64_t)rng.next();
+        plr.FEKey = rng.next();
+        plr.PCStyle.iPC_UID = (int64_t)rng.next();
+        plr.PCStyle.szFirstName[0] = (char16_t)('A' + roll(26));
+        plr.PCStyle.iBody = roll(3);
+        plr.PCStyle2.iPayzoneFlag = roll(2);
+        plr.level = roll(36);
+        plr.HP = (int)rng.next();
+        plr.money = (int)rng.next();
+        plr.fusionmatter = (int)rng.next();
+        plr.mentor = roll(10);
+        plr.batteryW = roll(10000);
+        plr.batteryN = roll(10000);
+        plr.equippedNanos[roll(3)] = roll(NANO_COUNT);
+        plr.x = (int)rng.next();
+        plr.y = (int)rng.next();
+        plr.z = (int)rng.next();
+        plr.angle = roll(360);
+        plr.instanceID = rng.next();
+        plr.lastX = (int)rng.next();
+        plr.lastY = (int)rng.next();
+        plr.lastZ = (int)rng.next();
+        plr.lastAngle = roll(360);
+        plr.recallX = (int)rng.next();
+        plr.recallY = (int)rng.next();
+        plr.recallZ = (int)rng.next();
+        plr.recallInstance = rng.next();
+        plr.iWarpLocationFlag = (int32_t)rng.next();
+        plr.aSkywayLocationFlag[roll(2)] = (int64_t)rng.next();
+        plr.CurrentMissionID = (int)rng.next();
+        cold.aQuestFlag[roll(16)] = (int64_t)rng.next();
+        cold.iFirstUseFlag[roll(2)] = rng.next();
+        plr.toRemoveVehicle = { roll(3), roll(AINVEN_COUNT) };
+
+        // from empty to packed, since empty slots are left out of the record
+        int density = roll(101);
+        for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
+            if (roll(100) >= density)
+                continue;
+            plr.tasks[i] = 1 + roll(10000);
+            for (int j = 0; j < 3; j++)
+                plr.RemainingNPCCount[i][j] = roll(100);
+        }
+        for (int i = 0; i < AEQUIP_COUNT; i++)
+            if (roll(100) < density)
+                cold.Equip[i] = randomItem();
+        for (int i = 0; i < AINVEN_COUNT; i++)
+            if (roll(100) < density)
+                cold.Inven[i] = randomItem();
+        for (int i = 0; i < ABANK_COUNT; i++)
+            if (roll(100) < density)
+                cold.Bank[i] = randomItem();
+        for (int i = 0; i < AQINVEN_COUNT; i++)
+            if (roll(100) < density)
+                cold.QInven[i] = randomItem();
+        for (int i = 1; i < NANO_COUNT; i++)
+            if (roll(100) < density)
+                plr.Nanos[i] = { (int16_t)i, (int16_t)roll(10000), (int16_t)roll(150) };
+        for (int i = 0; i < 50; i++) {
+            if (roll(100) >= density)
+                continue;
+            cold.buddyIDs[i] = 1 + (int64_t)(rng.next() >> 1);
+            cold.isBuddyBlocked[i] = roll(2);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        PlayerSnapshot::serialize(&plr, record);
+        auto mid = std::chrono::steady_clock::now();
+        Player back = {};
+        bool ok = PlayerSnapshot::deserialize(record.data(), record.size(), &back);
+        auto end = std::chrono::steady_clock::now();
+
+        encodeMicros += std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count();
+        decodeMicros += std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count();
+        totalBytes += record.size();
+
+        PlayerCold& coldBack = *back.cold;
+        ok = ok && back.iID == plr.iID && back.accountId == plr.accountId && back.accountLevel == plr.accountLevel
+            && back.slot == plr.slot && back.SerialKey == plr.SerialKey && back.FEKey == plr.FEKey
+            && memcmp(&back.PCStyle, &plr.PCStyle, sizeof(plr.PCStyle)) == 0
+            && memcmp(&back.PCStyle2, &plr.PCStyle2, sizeof(plr.PCStyle2)) == 0
+            && back.level == plr.level && back.HP == plr.HP && back.money == plr.money
+            && back.fusionmatter == plr.fusionmatter && back.mentor == plr.mentor
+            && back.batteryW == plr.batteryW && back.batteryN == plr.batteryN
+            && memcmp(back.equippedNanos, plr.equippedNanos, sizeof(plr.equippedNanos)) == 0
+            && back.x == plr.x && back.y == plr.y && back.z == plr.z && back.angle == plr.angle
+            && back.instanceID == plr.instanceID && back.lastX == plr.lastX && back.lastY == plr.lastY
+            && back.lastZ == plr.lastZ && back.lastAngle == plr.lastAngle && back.recallX == plr.recallX
+            && back.recallY == plr.recallY && back.recallZ == plr.recallZ && back.recallInstance == plr.recallInstance
+            && back.iWarpLocationFlag == plr.iWarpLocationFlag
+            && memcmp(back.aSkywayLocationFlag, plr.aSkywayLocationFlag, sizeof(plr.aSkywayLocationFlag)) == 0
+            && back.CurrentMissionID == plr.CurrentMissionID
+            && back.toRemoveVehicle.eIL == plr.toRemoveVehicle.eIL && back.toRemoveVehicle.iSlotNum == plr.toRemoveVehicle.iSlotNum
+            && memcmp(back.tasks, plr.tasks, sizeof(plr.tasks)) == 0
+            && memcmp(back.RemainingNPCCount, plr.RemainingNPCCount, sizeof(plr.RemainingNPCCount)) == 0
+            && memcmp(back.Nanos, plr.Nanos, sizeof(plr.Nanos)) == 0
+            && memcmp(coldBack.Equip, cold.Equip, sizeof(cold.Equip)) == 0
+            && memcmp(coldBack.Inven, cold.Inven, sizeof(cold.Inven)) == 0
+            && memcmp(coldBack.Bank, cold.Bank, sizeof(cold.Bank)) == 0
+            && memcmp(coldBack.QInven, cold.QInven, sizeof(cold.QInven)) == 0
+            && memcmp(coldBack.aQuestFlag, cold.aQuestFlag, sizeof(cold.aQuestFlag)) == 0
+            && memcmp(coldBack.buddyIDs, cold.buddyIDs, sizeof(cold.buddyIDs)) == 0
+            && memcmp(coldBack.isBuddyBlocked, cold.isBuddyBlocked, sizeof(cold.isBuddyBlocked)) == 0
+            && memcmp(coldBack.iFirstUseFlag, cold.iFirstUseFlag, sizeof(cold.iFirstUseFlag)) == 0;
+
+        PlayerSnapshot::serialize(&back, again);
+        ok = ok && again == record;
+
+        // every prefix, then the magic (first four bytes) and the version (next two)
+        bool leaky = false;
+        for (size_t len = 0; len < record.size() && !leaky; len++)
+            leaky = PlayerSnapshot::deserialize(record.data(), len, &back);
+
+        again = record;
+        again[0] ^= 0xFF;
+        leaky = leaky || PlayerSnapshot::deserialize(again.data(), again.size(), &back);
+
+        again = record;
+        uint16_t newer = PlayerSnapshot::VERSION + 1;
+        memcpy(again.data() + 4, &newer, sizeof(newer));
+        leaky = leaky || PlayerSnapshot::deserialize(again.data(), again.size(), &back);
+
+        if (!ok)
+            failed++;
+        if (leaky)
+            rejected++;
+    }
+
+    ChatManager::sendServerMessage(sock, "[SNAPCHECK] " + std::to_string(count) + " players: " + std::to_string(failed)
+        + " didn't round-trip, " + std::to_string(rejected) + " accepted a broken record");
+    ChatManager::sendServerMessage(sock, "[SNAPCHECK] " + std::to_string(totalBytes / count) + " bytes on average (Player + PlayerCold: "
+        + std::to_string(sizeof(Player) + sizeof(PlayerCold)) + "); encode " + std::to_string(encodeMicros) + "us, decode "
+        + std::to_string(decodeMicros) + "us in total");
+}
+
+void saveQueueCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
+    SaveQueue::Stats stats = SaveQueue::getStats();
+    uint64_t avgMicros = stats.batches > 0 ? stats.totalMicros / stats.batches : 0;
+
+    ChatManager::sendServerMessage(sock, "[SAVEQUEUE] " + std::to_string(stats.depth) + " waiting, peak "
+        + std::to_string(stats.peakDepth) + ", " + std::to_string(stats.stalls) + " stalls");
+    ChatManager::sendServerMessage(sock, "[SAVEQUEUE] " + std::to_string(stats.saved) + " saved, "
+        + std::to_string(stats.failed) + " failed in " + std::to_string(stats.batches) + " batches; "
+        + std::to_string(stats.unchanged) + " unchanged, " + std::to_string(stats.rows) + " rows written");
+    ChatManager::sendServerMessage(sock, "[SAVEQUEUE] batch time: last " + std::to_string(stats.lastBatchMicros)
+        + "us, avg " + std::to_string(avgMicros) + "us, max " + std::to_string(stats.maxBatchMicros) + "us");
+}
+
 void lairUnlockCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
     Player* plr = PlayerManager::getPlayer(sock);
     if (!ChunkManager::chunkExists(plr->chunkPos))
@@ -679,7 +1131,7 @@ void lairUnlockCommand(std::string full, std::vector<std::string>& args, CNSocke
         for (auto it = NPCManager::Warps.begin(); it != NPCManager::Warps.end(); it++) {
             if ((*it).second.npcID == npc->appearanceData.iNPCType) {
                 taskID = (*it).second.limitTaskID;
-                missionID = MissionManager::Tasks[taskID]->task["m_iHMissionID"];
+                missionID = MissionManager::Tasks[taskID]->missionID;
                 found++;
                 break;
             }
@@ -764,12 +1216,12 @@ void redeemCommand(std::string full, std::vector<std::string>& args, CNSocket* s
 
             // delete any temp items we might have set
             for (int j = 0; j < i; j++) {
-                plr->Inven[slots[j]] = { 0, 0, 0, 0 }; // empty
+                plr->cold->Inven[slots[j]] = { 0, 0, 0, 0 }; // empty
             }
             return;
         }
 
-        plr->Inven[slots[i]] = { 999, 999, 999, 0 }; // temp item; overwritten later
+        plr->cold->Inven[slots[i]] = { 999, 999, 999, 0 }; // temp item; overwritten later
     }
     
     for (int i = 0; i < itemCount; i++) {
@@ -784,7 +1236,7 @@ void redeemCommand(std::string full, std::vector<std::string>& args, CNSocket* s
         resp.Item.iOpt = 1;
 
         // save serverside
-        plr->Inven[resp.iSlotNum] = resp.Item;
+        plr->cold->Inven[resp.iSlotNum] = resp.Item;
 
         sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_GIVE_ITEM_SUCC, sizeof(sP_FE2CL_REP_PC_GIVE_ITEM_SUCC));
     }
@@ -831,6 +1283,12 @@ void ChatManager::init() {
     registerCommand("summonGroup", 30, summonGroupCommand, "summon group NPCs");
     registerCommand("summonGroupW", 30, summonGroupCommand, "permanently summon group NPCs");
     registerCommand("whois", 50, whoisCommand, "describe nearest NPC");
+    registerCommand("aggrobench", 50, aggroBenchCommand, "time batched vs scalar mob aggro checks");
+    registerCommand("mobinfo", 30, mobInfoCommand, "show mob count, template memory, AI step timings and wakes");
+    registerCommand("snapcheck", 50, snapCheckCommand, "round-trip random characters through the snapshot format");
+    registerCommand("savequeue", 30, saveQueueCommand, "show background save queue depth and write times");
+    registerCommand("dbbench", 1, dbBenchCommand, "time character saves and loads with and without the statement cache");
+    registerCommand("chunkinfo", 30, chunkInfoCommand, "show chunk settings and broadcast fan-out around you");
     registerCommand("lair", 50, lairUnlockCommand, "get the required mission for the nearest fusion lair");
     registerCommand("hide", 100, hideCommand, "hide yourself from the global player map");
     registerCommand("unhide", 100, unhideCommand, "un-hide yourself from the global player map");
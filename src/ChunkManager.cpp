@@ -3,6 +3,7 @@
 #include "NPCManager.hpp"
 #include "settings.hpp"
 #include "MobManager.hpp"
+#include "TransportManager.hpp"
 
 std::map<ChunkPos, Chunk*> ChunkManager::chunks;
 
@@ -172,7 +173,10 @@ void ChunkManager::addPlayerToChunks(std::set<Chunk*> chnks, CNSocket* sock) {
         // add npcs
         for (int32_t id : chunk->NPCs) {
             BaseNPC* npc = NPCManager::NPCs[id];
-            npc->playersInView++;
+
+            // mobs nobody could see have been asleep
+            if (npc->playersInView++ == 0 && npc->npcClass == NPC_MOB)
+                MobManager::wakeMob((Mob*)npc);
 
             if (npc->appearanceData.iHP <= 0)
                 continue;
@@ -182,6 +186,7 @@ void ChunkManager::addPlayerToChunks(std::set<Chunk*> chnks, CNSocket* sock) {
                 INITSTRUCT(sP_FE2CL_TRANSPORTATION_ENTER, enterBusData);
                 enterBusData.AppearanceData = { 3, npc->appearanceData.iNPC_ID, npc->appearanceData.iNPCType, npc->appearanceData.iX, npc->appearanceData.iY, npc->appearanceData.iZ };
                 sock->sendPacket((void*)&enterBusData, P_FE2CL_TRANSPORTATION_ENTER, sizeof(sP_FE2CL_TRANSPORTATION_ENTER));
+                TransportManager::sendSliderMove(sock, npc, getTime()); // pick up mid-leg
                 break;
             case NPC_EGG:
                 INITSTRUCT(sP_FE2CL_SHINY_ENTER, enterEggData);
@@ -215,7 +220,7 @@ void ChunkManager::addPlayerToChunks(std::set<Chunk*> chnks, CNSocket* sock) {
             newPlayer.PCAppearanceData.Nano = plr->Nanos[plr->activeNano];
             newPlayer.PCAppearanceData.iPCState = plr->iPCState;
             newPlayer.PCAppearanceData.iSpecialState = plr->iSpecialState;
-            memcpy(newPlayer.PCAppearanceData.ItemEquip, plr->Equip, sizeof(sItemBase) * AEQUIP_COUNT);
+            memcpy(newPlayer.PCAppearanceData.ItemEquip, plr->cold->Equip, sizeof(sItemBase) * AEQUIP_COUNT);
 
             otherSock->sendPacket((void*)&newPlayer, P_FE2CL_PC_NEW, sizeof(sP_FE2CL_PC_NEW));
 
@@ -230,7 +235,7 @@ void ChunkManager::addPlayerToChunks(std::set<Chunk*> chnks, CNSocket* sock) {
             newPlayer.PCAppearanceData.Nano = otherPlr->Nanos[otherPlr->activeNano];
             newPlayer.PCAppearanceData.iPCState = otherPlr->iPCState;
             newPlayer.PCAppearanceData.iSpecialState = otherPlr->iSpecialState;
-            memcpy(newPlayer.PCAppearanceData.ItemEquip, otherPlr->Equip, sizeof(sItemBase) * AEQUIP_COUNT);
+            memcpy(newPlayer.PCAppearanceData.ItemEquip, otherPlr->cold->Equip, sizeof(sItemBase) * AEQUIP_COUNT);
 
             sock->sendPacket((void*)&newPlayer, P_FE2CL_PC_NEW, sizeof(sP_FE2CL_PC_NEW));
         }
@@ -249,6 +254,7 @@ void ChunkManager::addNPCToChunks(std::set<Chunk*> chnks, int32_t id) {
             for (CNSocket* sock : chunk->players) {
                 // send to socket
                 sock->sendPacket((void*)&enterBusData, P_FE2CL_TRANSPORTATION_ENTER, sizeof(sP_FE2CL_TRANSPORTATION_ENTER));
+                TransportManager::sendSliderMove(sock, npc, getTime()); // pick up mid-leg
                 npc->playersInView++;
             }
         }
@@ -270,6 +276,7 @@ void ChunkManager::addNPCToChunks(std::set<Chunk*> chnks, int32_t id) {
         INITSTRUCT(sP_FE2CL_NPC_ENTER, enterData);
         enterData.NPCAppearanceData = npc->appearanceData;
 
+        bool unseen = npc->playersInView == 0;
         for (Chunk* chunk : chnks) {
             for (CNSocket* sock : chunk->players) {
                 // send to socket
@@ -277,6 +284,10 @@ void ChunkManager::addNPCToChunks(std::set<Chunk*> chnks, int32_t id) {
                 npc->playersInView++;
             }
         }
+
+        // a mob walking into view of players has to start paying attention
+        if (unseen && npc->playersInView > 0 && npc->npcClass == NPC_MOB)
+            MobManager::wakeMob((Mob*)npc);
         break;
     }
 }
@@ -396,11 +407,36 @@ bool ChunkManager::chunkExists(ChunkPos chunk) {
     return chunks.find(chunk) != chunks.end();
 }
 
+/*
+ * Chunk size and view radius can be overridden per map number; instances
+ * share the settings of the map they were created from.
+ */
+int ChunkManager::getChunkSize(uint64_t instanceID) {
+    auto it = settings::MAPVIEWSETTINGS.find(MAPNUM(instanceID));
+    if (it != settings::MAPVIEWSETTINGS.end())
+        return it->second.chunkSize;
+
+    return settings::CHUNKSIZE;
+}
+
+int ChunkManager::getViewRadius(uint64_t instanceID) {
+    auto it = settings::MAPVIEWSETTINGS.find(MAPNUM(instanceID));
+    if (it != settings::MAPVIEWSETTINGS.end())
+        return it->second.viewRadius;
+
+    return settings::VIEWRADIUS;
+}
+
 ChunkPos ChunkManager::chunkPosAt(int posX, int posY, uint64_t instanceID) {
-    return std::make_tuple(posX / (settings::VIEWDISTANCE / 3), posY / (settings::VIEWDISTANCE / 3), instanceID);
+    int chunkSize = getChunkSize(instanceID);
+    return std::make_tuple(posX / chunkSize, posY / chunkSize, instanceID);
 }
 
 std::set<Chunk*> ChunkManager::getViewableChunks(ChunkPos chunk) {
+    return getViewableChunks(chunk, getViewRadius(std::get<2>(chunk)));
+}
+
+std::set<Chunk*> ChunkManager::getViewableChunks(ChunkPos chunk, int radius) {
     std::set<Chunk*> chnks;
 
     int x, y;
@@ -408,13 +444,13 @@ std::set<Chunk*> ChunkManager::getViewableChunks(ChunkPos chunk) {
     std::tie(x, y, inst) = chunk;
 
     // grabs surrounding chunks if they exist
-    for (int i = -1; i < 2; i++) {
-        for (int z = -1; z < 2; z++) {
-            ChunkPos pos = std::make_tuple(x+i, y+z, inst);
+    for (int i = -radius; i <= radius; i++) {
+        for (int z = -radius; z <= radius; z++) {
+            auto it = chunks.find(std::make_tuple(x+i, y+z, inst));
 
             // if chunk exists, add it to the set
-            if (chunkExists(pos))
-                chnks.insert(chunks[pos]);
+            if (it != chunks.end())
+                chnks.insert(it->second);
         }
     }
 
@@ -463,7 +499,7 @@ void ChunkManager::createInstance(uint64_t instanceID) {
                         continue; // follower; don't copy individually
 
                     Mob* newMob = new Mob(baseNPC->appearanceData.iX, baseNPC->appearanceData.iY, baseNPC->appearanceData.iZ, baseNPC->appearanceData.iAngle,
-                        instanceID, baseNPC->appearanceData.iNPCType, NPCManager::NPCData[baseNPC->appearanceData.iNPCType], NPCManager::nextId++);
+                        instanceID, baseNPC->appearanceData.iNPCType, &NPCManager::MobTemplates[baseNPC->appearanceData.iNPCType], NPCManager::NPCs.allocate());
                     NPCManager::NPCs[newMob->appearanceData.iNPC_ID] = newMob;
                     MobManager::Mobs[newMob->appearanceData.iNPC_ID] = newMob;
 
@@ -473,11 +509,11 @@ void ChunkManager::createInstance(uint64_t instanceID) {
                         Mob* mobData = (Mob*)baseNPC;
                         for (int i = 0; i < 4; i++) {
                             if (mobData->groupMember[i] != 0) {
-                                int followerID = NPCManager::nextId++; // id for follower
+                                int followerID = NPCManager::NPCs.allocate(); // id for follower
                                 BaseNPC* baseFollower = NPCManager::NPCs[mobData->groupMember[i]]; // follower from template
                                 // new follower instance
                                 Mob* newMobFollower = new Mob(baseFollower->appearanceData.iX, baseFollower->appearanceData.iY, baseFollower->appearanceData.iZ, baseFollower->appearanceData.iAngle,
-                                    instanceID, baseFollower->appearanceData.iNPCType, NPCManager::NPCData[baseFollower->appearanceData.iNPCType], followerID);
+                                    instanceID, baseFollower->appearanceData.iNPCType, &NPCManager::MobTemplates[baseFollower->appearanceData.iNPCType], followerID);
                                 // add follower to NPC maps
                                 NPCManager::NPCs[followerID] = newMobFollower;
                                 MobManager::Mobs[followerID] = newMobFollower;
@@ -496,7 +532,7 @@ void ChunkManager::createInstance(uint64_t instanceID) {
                         instanceID, baseNPC->appearanceData.iAngle);
                 } else {
                     BaseNPC* newNPC = new BaseNPC(baseNPC->appearanceData.iX, baseNPC->appearanceData.iY, baseNPC->appearanceData.iZ, baseNPC->appearanceData.iAngle,
-                        instanceID, baseNPC->appearanceData.iNPCType, NPCManager::nextId++);
+                        instanceID, baseNPC->appearanceData.iNPCType, NPCManager::NPCs.allocate());
                     NPCManager::NPCs[newNPC->appearanceData.iNPC_ID] = newNPC;
                     NPCManager::updateNPCPosition(newNPC->appearanceData.iNPC_ID, baseNPC->appearanceData.iX, baseNPC->appearanceData.iY, baseNPC->appearanceData.iZ,
                         instanceID, baseNPC->appearanceData.iAngle);
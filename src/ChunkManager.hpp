@@ -45,8 +45,11 @@ namespace ChunkManager {
 
     bool chunkExists(ChunkPos chunk);
     void emptyChunk(ChunkPos chunkPos);
+    int getChunkSize(uint64_t instanceID);
+    int getViewRadius(uint64_t instanceID);
     ChunkPos chunkPosAt(int posX, int posY, uint64_t instanceID);
     std::set<Chunk*> getViewableChunks(ChunkPos chunkPos);
+    std::set<Chunk*> getViewableChunks(ChunkPos chunkPos, int radius);
 
     std::vector<ChunkPos> getChunksInMap(uint64_t mapNum);
     bool inPopulatedChunks(std::set<Chunk*>* chnks);
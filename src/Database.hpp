@@ -1,10 +1,12 @@
 #pragma once
 #include "CNStructs.hpp"
 #include "Player.hpp"
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
-#define DATABASE_VERSION 2
+#define DATABASE_VERSION 3
 
 namespace Database {
 
@@ -37,13 +39,39 @@ namespace Database {
         uint64_t Time;
         uint64_t Timestamp;
     };
+    // what buddy lists and mail checks need, without loading the whole character
+    struct PlayerSummary {
+        int PlayerID;
+        int Level;
+        sPCStyle PCStyle;
+        sPCStyle2 PCStyle2;
+    };
+    // one player's share of an updatePlayers() batch
+    struct PlayerSave {
+        const Player* player;
+        const Player* previous; // last state written for them; nullptr rewrites everything
+        bool ok;
+        int rows; // rows written or deleted
+    };
     
+    /*
+     * Everything below goes through the Storage picked by the dbbackend
+     * setting: "sqlite" for the database file, or "memory" to keep it all in
+     * RAM until shutdown, for benchmarks that shouldn't measure the disk.
+     */
     void open();
     void close();
-    void checkMetaTable();
-    void createMetaTable();
-    void createTables();
-    int getTableSize(std::string tableName);
+    const char* backendName();
+    // turning it off finalizes every statement after use, like before there was a cache
+    void setStatementCache(bool enabled);
+
+    /// runs job wherever the backend does its I/O; the caller doesn't wait for it
+    void submit(std::function<void()> job);
+    /// like submit(), then hands fn's result to done, still on the backend's side
+    template<typename F, typename D>
+    void async(F fn, D done) {
+        submit([fn, done]() mutable { done(fn()); });
+    }
 
     void findAccount(Account* account, std::string login);
     /// returns ID, 0 if something failed
@@ -74,7 +102,11 @@ namespace Database {
 
     // getting players
     void getPlayer(Player* plr, int id);
-    void updatePlayer(Player *player);
+    /// characters in ids that don't exist are left out
+    std::vector<PlayerSummary> getPlayerSummaries(const std::vector<int>& ids);
+    void updatePlayer(const Player* player);
+    /// saves them all in one transaction, only writing what changed since previous
+    void updatePlayers(std::vector<PlayerSave>& saves);
     void removeExpiredVehicles(Player* player);
     
     // buddies
@@ -86,18 +118,19 @@ namespace Database {
     void addBlock(int playerId, int blockedPlayerId);
     void removeBlock(int playerId, int blockedPlayerId);
 
-    // email
+    // email; online players go through Inbox, which caches theirs
     int getUnreadEmailCount(int playerID);
-    std::vector<EmailData> getEmails(int playerID, int page);
+    // headers (no MsgBody) newest first, from below MsgIndex before; a count under 0 gets them all
+    std::vector<EmailData> getEmails(int playerID, int before, int count);
     EmailData getEmail(int playerID, int index);
     sItemBase* getEmailAttachments(int playerID, int index);
-    void updateEmailContent(EmailData* data);
+    void updateEmailContent(EmailData* data); // ItemFlag is stored as given
     void deleteEmailAttachments(int playerID, int index, int slot);
     void deleteEmails(int playerID, int64_t* indices);
     int getNextEmailIndex(int playerID);
     bool sendEmail(EmailData* data, std::vector<sItemBase> attachments);
 
     // racing
-    RaceRanking getTopRaceRanking(int epID, int playerID);
+    std::vector<RaceRanking> getRaceBests();
     void postRaceRanking(RaceRanking ranking);
 }
@@ -10,6 +10,8 @@
 #include <algorithm>
 #include <thread>
 
+std::unordered_map<int32_t, Group*> GroupManager::Groups;
+
 void GroupManager::init() {
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_PC_GROUP_INVITE, requestGroup);
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_PC_GROUP_INVITE_REFUSE, refuseGroup);
@@ -19,6 +21,26 @@ void GroupManager::init() {
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_SEND_ALL_GROUP_MENUCHAT_MESSAGE, menuChatGroup);
 }
 
+/*
+ * The parts of a member's roster entry that the join, leave and tick packets all share.
+ */
+static void fillMemberInfo(sPCGroupMemberInfo* info, Player* varPlr) {
+    info->iPC_ID = varPlr->iID;
+    info->iPCUID = varPlr->PCStyle.iPC_UID;
+    info->iNameCheck = varPlr->PCStyle.iNameCheck;
+    memcpy(info->szFirstName, varPlr->PCStyle.szFirstName, sizeof(varPlr->PCStyle.szFirstName));
+    memcpy(info->szLastName, varPlr->PCStyle.szLastName, sizeof(varPlr->PCStyle.szLastName));
+    info->iSpecialState = varPlr->iSpecialState;
+    info->iLv = varPlr->level;
+    info->iHP = varPlr->HP;
+    info->iMaxHP = PC_MAXHEALTH(varPlr->level);
+    //info->iMapType = 0;
+    //info->iMapNum = 0;
+    info->iX = varPlr->x;
+    info->iY = varPlr->y;
+    info->iZ = varPlr->z;
+}
+
 void GroupManager::requestGroup(CNSocket* sock, CNPacketData* data) {
     if (data->size != sizeof(sP_CL2FE_REQ_PC_GROUP_INVITE))
         return; // malformed packet
@@ -26,31 +48,23 @@ void GroupManager::requestGroup(CNSocket* sock, CNPacketData* data) {
     sP_CL2FE_REQ_PC_GROUP_INVITE* recv = (sP_CL2FE_REQ_PC_GROUP_INVITE*)data->buf;
 
     Player* plr = PlayerManager::getPlayer(sock);
-    Player* otherPlr = PlayerManager::getPlayerFromID(recv->iID_To);
+    CNSocket* otherSock = PlayerManager::getSockFromID(recv->iID_To);
 
-    if (otherPlr == nullptr)
+    if (otherSock == nullptr)
         return;
 
-    otherPlr = PlayerManager::getPlayerFromID(otherPlr->iIDGroup);
-
-    if (otherPlr == nullptr)
-        return;
+    Player* otherPlr = PlayerManager::getPlayer(otherSock);
 
     // fail if the group is full or the other player is already in a group
-    if (plr->groupCnt >= 4 || otherPlr->groupCnt > 1) {
+    if ((plr->group != nullptr && plr->group->members.size() >= 4) || otherPlr->group != nullptr) {
         INITSTRUCT(sP_FE2CL_PC_GROUP_INVITE_FAIL, resp);
         sock->sendPacket((void*)&resp, P_FE2CL_PC_GROUP_INVITE_FAIL, sizeof(sP_FE2CL_PC_GROUP_INVITE_FAIL));
         return;
     }
 
-    CNSocket* otherSock = PlayerManager::getSockFromID(recv->iID_To);
-
-    if (otherSock == nullptr)
-        return;
-
     INITSTRUCT(sP_FE2CL_PC_GROUP_INVITE, resp);
 
-    resp.iHostID = plr->iIDGroup;
+    resp.iHostID = getLeaderID(plr);
 
     otherSock->sendPacket((void*)&resp, P_FE2CL_PC_GROUP_INVITE, sizeof(sP_FE2CL_PC_GROUP_INVITE));
 }
@@ -81,33 +95,42 @@ void GroupManager::joinGroup(CNSocket* sock, CNPacketData* data) {
 
     sP_CL2FE_REQ_PC_GROUP_JOIN* recv = (sP_CL2FE_REQ_PC_GROUP_JOIN*)data->buf;
     Player* plr = PlayerManager::getPlayer(sock);
-    Player* otherPlr = PlayerManager::getPlayerFromID(recv->iID_From);
+    CNSocket* otherSock = PlayerManager::getSockFromID(recv->iID_From);
 
-    if (otherPlr == nullptr)
+    if (otherSock == nullptr)
         return;
 
-    otherPlr = PlayerManager::getPlayerFromID(otherPlr->iIDGroup);
-
-    if (otherPlr == nullptr)
-        return;
+    Player* otherPlr = PlayerManager::getPlayer(otherSock);
+    Group* group = otherPlr->group;
+    int groupSize = group == nullptr ? 1 : (int)group->members.size();
 
     // fail if the group is full or the other player is already in a group
-    if (plr->groupCnt > 1 || plr->iIDGroup != plr->iID || otherPlr->groupCnt >= 4) {
+    if (plr->group != nullptr || groupSize >= 4) {
         INITSTRUCT(sP_FE2CL_PC_GROUP_JOIN_FAIL, resp);
         sock->sendPacket((void*)&resp, P_FE2CL_PC_GROUP_JOIN_FAIL, sizeof(sP_FE2CL_PC_GROUP_JOIN_FAIL));
         return;
     }
 
-    if (!validOutVarPacket(sizeof(sP_FE2CL_PC_GROUP_JOIN), otherPlr->groupCnt + 1, sizeof(sPCGroupMemberInfo))) {
+    if (!validOutVarPacket(sizeof(sP_FE2CL_PC_GROUP_JOIN), groupSize + 1, sizeof(sPCGroupMemberInfo))) {
         std::cout << "[WARN] bad sP_FE2CL_PC_GROUP_JOIN packet size\n";
         return;
     }
 
-    plr->iIDGroup = otherPlr->iID;
-    otherPlr->groupCnt += 1;
-    otherPlr->groupIDs[otherPlr->groupCnt-1] = plr->iID;
+    // the inviter was on their own until now; they lead the new group
+    if (group == nullptr) {
+        group = new Group();
+        group->members.push_back(otherPlr);
+        group->socks.push_back(otherSock);
+        otherPlr->group = group;
+        Groups[otherPlr->iID] = group;
+    }
+
+    group->members.push_back(plr);
+    group->socks.push_back(sock);
+    group->lastInfo.clear(); // the roster changed, so the next tick goes out whatever the entries say
+    plr->group = group;
 
-    size_t resplen = sizeof(sP_FE2CL_PC_GROUP_JOIN) + otherPlr->groupCnt * sizeof(sPCGroupMemberInfo);
+    size_t resplen = sizeof(sP_FE2CL_PC_GROUP_JOIN) + group->members.size() * sizeof(sPCGroupMemberInfo);
     uint8_t respbuf[CN_PACKET_BUFFER_SIZE];
 
     memset(respbuf, 0, resplen);
@@ -116,31 +139,15 @@ void GroupManager::joinGroup(CNSocket* sock, CNPacketData* data) {
     sPCGroupMemberInfo *respdata = (sPCGroupMemberInfo*)(respbuf+sizeof(sP_FE2CL_PC_GROUP_JOIN));
 
     resp->iID_NewMember = plr->iID;
-    resp->iMemberPCCnt = otherPlr->groupCnt;
-
-    int bitFlag = getGroupFlags(otherPlr);
+    resp->iMemberPCCnt = group->members.size();
 
-    for (int i = 0; i < otherPlr->groupCnt; i++) {
-        Player* varPlr = PlayerManager::getPlayerFromID(otherPlr->groupIDs[i]);
-        CNSocket* sockTo = PlayerManager::getSockFromID(otherPlr->groupIDs[i]);
+    int bitFlag = getGroupFlags(plr);
 
-        if (varPlr == nullptr || sockTo == nullptr)
-            continue;
+    for (size_t i = 0; i < group->members.size(); i++) {
+        Player* varPlr = group->members[i];
+        CNSocket* sockTo = group->socks[i];
 
-        respdata[i].iPC_ID = varPlr->iID;
-        respdata[i].iPCUID = varPlr->PCStyle.iPC_UID;
-        respdata[i].iNameCheck = varPlr->PCStyle.iNameCheck;
-        memcpy(respdata[i].szFirstName, varPlr->PCStyle.szFirstName, sizeof(varPlr->PCStyle.szFirstName));
-        memcpy(respdata[i].szLastName, varPlr->PCStyle.szLastName, sizeof(varPlr->PCStyle.szLastName));
-        respdata[i].iSpecialState = varPlr->iSpecialState;
-        respdata[i].iLv = varPlr->level;
-        respdata[i].iHP = varPlr->HP;
-        respdata[i].iMaxHP = PC_MAXHEALTH(varPlr->level);
-        //respdata[i].iMapType = 0;
-        //respdata[i].iMapNum = 0;
-        respdata[i].iX = varPlr->x;
-        respdata[i].iY = varPlr->y;
-        respdata[i].iZ = varPlr->z;
+        fillMemberInfo(&respdata[i], varPlr);
         // client doesnt read nano data here
 
         if (varPlr != plr) { // apply the new member's buffs to the group and the group's buffs to the new member
@@ -151,7 +158,7 @@ void GroupManager::joinGroup(CNSocket* sock, CNPacketData* data) {
         }
     }
 
-    sendToGroup(otherPlr, (void*)&respbuf, P_FE2CL_PC_GROUP_JOIN, resplen);
+    sendToGroup(group, (void*)&respbuf, P_FE2CL_PC_GROUP_JOIN, resplen);
 }
 
 void GroupManager::leaveGroup(CNSocket* sock, CNPacketData* data) {
@@ -165,10 +172,6 @@ void GroupManager::chatGroup(CNSocket* sock, CNPacketData* data) {
 
     sP_CL2FE_REQ_SEND_ALL_GROUP_FREECHAT_MESSAGE* chat = (sP_CL2FE_REQ_SEND_ALL_GROUP_FREECHAT_MESSAGE*)data->buf;
     Player* plr = PlayerManager::getPlayer(sock);
-    Player* otherPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
-
-    if (otherPlr == nullptr)
-        return;
 
     std::string fullChat = ChatManager::sanitizeText(U16toU8(chat->szFreeChat));
 
@@ -191,7 +194,10 @@ void GroupManager::chatGroup(CNSocket* sock, CNPacketData* data) {
     resp.iSendPCID = plr->iID;
     resp.iEmoteCode = chat->iEmoteCode;
 
-    sendToGroup(otherPlr, (void*)&resp, P_FE2CL_REP_SEND_ALL_GROUP_FREECHAT_MESSAGE_SUCC, sizeof(sP_FE2CL_REP_SEND_ALL_GROUP_FREECHAT_MESSAGE_SUCC));
+    if (plr->group == nullptr)
+        sock->sendPacket((void*)&resp, P_FE2CL_REP_SEND_ALL_GROUP_FREECHAT_MESSAGE_SUCC, sizeof(sP_FE2CL_REP_SEND_ALL_GROUP_FREECHAT_MESSAGE_SUCC));
+    else
+        sendToGroup(plr->group, (void*)&resp, P_FE2CL_REP_SEND_ALL_GROUP_FREECHAT_MESSAGE_SUCC, sizeof(sP_FE2CL_REP_SEND_ALL_GROUP_FREECHAT_MESSAGE_SUCC));
 }
 
 void GroupManager::menuChatGroup(CNSocket* sock, CNPacketData* data) {
@@ -200,10 +206,6 @@ void GroupManager::menuChatGroup(CNSocket* sock, CNPacketData* data) {
 
     sP_CL2FE_REQ_SEND_ALL_GROUP_MENUCHAT_MESSAGE* chat = (sP_CL2FE_REQ_SEND_ALL_GROUP_MENUCHAT_MESSAGE*)data->buf;
     Player* plr = PlayerManager::getPlayer(sock);
-    Player* otherPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
-
-    if (otherPlr == nullptr)
-        return;
 
     std::string fullChat = ChatManager::sanitizeText(U16toU8(chat->szFreeChat));
     std::string logLine = "[GroupMenuChat] " + PlayerManager::getPlayerName(plr, true) + ": " + fullChat;
@@ -218,92 +220,94 @@ void GroupManager::menuChatGroup(CNSocket* sock, CNPacketData* data) {
     resp.iSendPCID = plr->iID;
     resp.iEmoteCode = chat->iEmoteCode;
 
-    sendToGroup(otherPlr, (void*)&resp, P_FE2CL_REP_SEND_ALL_GROUP_MENUCHAT_MESSAGE_SUCC, sizeof(sP_FE2CL_REP_SEND_ALL_GROUP_MENUCHAT_MESSAGE_SUCC));
+    if (plr->group == nullptr)
+        sock->sendPacket((void*)&resp, P_FE2CL_REP_SEND_ALL_GROUP_MENUCHAT_MESSAGE_SUCC, sizeof(sP_FE2CL_REP_SEND_ALL_GROUP_MENUCHAT_MESSAGE_SUCC));
+    else
+        sendToGroup(plr->group, (void*)&resp, P_FE2CL_REP_SEND_ALL_GROUP_MENUCHAT_MESSAGE_SUCC, sizeof(sP_FE2CL_REP_SEND_ALL_GROUP_MENUCHAT_MESSAGE_SUCC));
 }
 
-void GroupManager::sendToGroup(Player* plr, void* buf, uint32_t type, size_t size) {
-    for (int i = 0; i < plr->groupCnt; i++) {
-        CNSocket* sock = PlayerManager::getSockFromID(plr->groupIDs[i]);
-
-        if (sock == nullptr)
-            continue;
-
-        if (type == P_FE2CL_PC_GROUP_LEAVE_SUCC) {
-            Player* leavingPlr = PlayerManager::getPlayer(sock);
-            leavingPlr->iIDGroup = leavingPlr->iID;
-        }
-
+void GroupManager::sendToGroup(Group* group, void* buf, uint32_t type, size_t size) {
+    for (CNSocket* sock : group->socks)
         sock->sendPacket(buf, type, size);
-    }
 }
 
-void GroupManager::groupTickInfo(Player* plr) {
-    if (!validOutVarPacket(sizeof(sP_FE2CL_PC_GROUP_MEMBER_INFO), plr->groupCnt, sizeof(sPCGroupMemberInfo))) {
-        std::cout << "[WARN] bad sP_FE2CL_PC_GROUP_JOIN packet size\n";
+/*
+ * Built once per group and sent to every member. The client takes this packet
+ * as the whole roster, so it always lists everyone; it's only skipped when no
+ * entry has changed since the last tick.
+ */
+void GroupManager::groupTickInfo(Group* group) {
+    size_t count = group->members.size();
+
+    if (!validOutVarPacket(sizeof(sP_FE2CL_PC_GROUP_MEMBER_INFO), count, sizeof(sPCGroupMemberInfo))) {
+        std::cout << "[WARN] bad sP_FE2CL_PC_GROUP_MEMBER_INFO packet size\n";
         return;
     }
 
-    size_t resplen = sizeof(sP_FE2CL_PC_GROUP_MEMBER_INFO) + plr->groupCnt * sizeof(sPCGroupMemberInfo);
     uint8_t respbuf[CN_PACKET_BUFFER_SIZE];
 
-    memset(respbuf, 0, resplen);
+    memset(respbuf, 0, sizeof(sP_FE2CL_PC_GROUP_MEMBER_INFO) + count * sizeof(sPCGroupMemberInfo));
 
     sP_FE2CL_PC_GROUP_MEMBER_INFO *resp = (sP_FE2CL_PC_GROUP_MEMBER_INFO*)respbuf;
     sPCGroupMemberInfo *respdata = (sPCGroupMemberInfo*)(respbuf+sizeof(sP_FE2CL_PC_GROUP_MEMBER_INFO));
 
-    resp->iID = plr->iID;
-    resp->iMemberPCCnt = plr->groupCnt;
-
-    for (int i = 0; i < plr->groupCnt; i++) {
-        Player* varPlr = PlayerManager::getPlayerFromID(plr->groupIDs[i]);
+    bool full = group->lastInfo.size() != count;
+    group->lastInfo.resize(count);
 
-        if (varPlr == nullptr)
-            continue;
+    bool changed = full;
+    for (size_t i = 0; i < count; i++) {
+        Player* varPlr = group->members[i];
 
-        respdata[i].iPC_ID = varPlr->iID;
-        respdata[i].iPCUID = varPlr->PCStyle.iPC_UID;
-        respdata[i].iNameCheck = varPlr->PCStyle.iNameCheck;
-        memcpy(respdata[i].szFirstName, varPlr->PCStyle.szFirstName, sizeof(varPlr->PCStyle.szFirstName));
-        memcpy(respdata[i].szLastName, varPlr->PCStyle.szLastName, sizeof(varPlr->PCStyle.szLastName));
-        respdata[i].iSpecialState = varPlr->iSpecialState;
-        respdata[i].iLv = varPlr->level;
-        respdata[i].iHP = varPlr->HP;
-        respdata[i].iMaxHP = PC_MAXHEALTH(varPlr->level);
-        //respdata[i].iMapType = 0;
-        //respdata[i].iMapNum = 0;
-        respdata[i].iX = varPlr->x;
-        respdata[i].iY = varPlr->y;
-        respdata[i].iZ = varPlr->z;
+        sPCGroupMemberInfo info;
+        memset(&info, 0, sizeof(sPCGroupMemberInfo));
+        fillMemberInfo(&info, varPlr);
         if (varPlr->activeNano > 0) {
-            respdata[i].bNano = 1;
-            respdata[i].Nano = varPlr->Nanos[varPlr->activeNano];
+            info.bNano = 1;
+            info.Nano = varPlr->Nanos[varPlr->activeNano];
+        }
+
+        if (memcmp(&info, &group->lastInfo[i], sizeof(sPCGroupMemberInfo)) != 0) {
+            group->lastInfo[i] = info;
+            changed = true;
         }
+        respdata[i] = info;
     }
 
-    sendToGroup(plr, (void*)&respbuf, P_FE2CL_PC_GROUP_MEMBER_INFO, resplen);
+    if (!changed)
+        return;
+
+    resp->iID = group->members[0]->iID;
+    resp->iMemberPCCnt = count;
+
+    size_t resplen = sizeof(sP_FE2CL_PC_GROUP_MEMBER_INFO) + count * sizeof(sPCGroupMemberInfo);
+    sendToGroup(group, (void*)&respbuf, P_FE2CL_PC_GROUP_MEMBER_INFO, resplen);
 }
 
 void GroupManager::groupKickPlayer(Player* plr) {
-    // if you are the group leader, destroy your own group and kick everybody
-    if (plr->iID == plr->iIDGroup) {
-        groupUnbuff(plr);
-        INITSTRUCT(sP_FE2CL_PC_GROUP_LEAVE_SUCC, resp1);
-        sendToGroup(plr, (void*)&resp1, P_FE2CL_PC_GROUP_LEAVE_SUCC, sizeof(sP_FE2CL_PC_GROUP_LEAVE_SUCC));
-        plr->groupCnt = 1;
+    Group* group = plr->group;
+
+    if (group == nullptr)
         return;
-    }
 
-    Player* otherPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
+    // if you are the group leader, destroy your own group and kick everybody
+    if (group->members[0] == plr) {
+        groupUnbuff(group);
+        INITSTRUCT(sP_FE2CL_PC_GROUP_LEAVE_SUCC, resp1);
+        sendToGroup(group, (void*)&resp1, P_FE2CL_PC_GROUP_LEAVE_SUCC, sizeof(sP_FE2CL_PC_GROUP_LEAVE_SUCC));
 
-    if (otherPlr == nullptr)
+        for (Player* member : group->members)
+            member->group = nullptr;
+        Groups.erase(plr->iID);
+        delete group;
         return;
+    }
 
-    if (!validOutVarPacket(sizeof(sP_FE2CL_PC_GROUP_LEAVE), otherPlr->groupCnt - 1, sizeof(sPCGroupMemberInfo))) {
+    if (!validOutVarPacket(sizeof(sP_FE2CL_PC_GROUP_LEAVE), group->members.size() - 1, sizeof(sPCGroupMemberInfo))) {
         std::cout << "[WARN] bad sP_FE2CL_PC_GROUP_LEAVE packet size\n";
         return;
     }
 
-    size_t resplen = sizeof(sP_FE2CL_PC_GROUP_LEAVE) + (otherPlr->groupCnt - 1) * sizeof(sPCGroupMemberInfo);
+    size_t resplen = sizeof(sP_FE2CL_PC_GROUP_LEAVE) + (group->members.size() - 1) * sizeof(sPCGroupMemberInfo);
     uint8_t respbuf[CN_PACKET_BUFFER_SIZE];
 
     memset(respbuf, 0, resplen);
@@ -312,87 +316,79 @@ void GroupManager::groupKickPlayer(Player* plr) {
     sPCGroupMemberInfo *respdata = (sPCGroupMemberInfo*)(respbuf+sizeof(sP_FE2CL_PC_GROUP_LEAVE));
 
     resp->iID_LeaveMember = plr->iID;
-    resp->iMemberPCCnt = otherPlr->groupCnt - 1;
+    resp->iMemberPCCnt = group->members.size() - 1;
 
-    int bitFlag = getGroupFlags(otherPlr) & ~plr->iGroupConditionBitFlag;
-    int moveDown = 0;
-
-    CNSocket* sock = PlayerManager::getSockFromID(plr->iID);
+    int bitFlag = getGroupFlags(plr) & ~plr->iGroupConditionBitFlag;
 
-    if (sock == nullptr)
-        return;
+    size_t idx = std::find(group->members.begin(), group->members.end(), plr) - group->members.begin();
+    CNSocket* sock = group->socks[idx];
 
-    for (int i = 0; i < otherPlr->groupCnt; i++) {
-        Player* varPlr = PlayerManager::getPlayerFromID(otherPlr->groupIDs[i]);
-        CNSocket* sockTo = PlayerManager::getSockFromID(otherPlr->groupIDs[i]);
+    int moveDown = 0;
+    for (size_t i = 0; i < group->members.size(); i++) {
+        Player* varPlr = group->members[i];
+        CNSocket* sockTo = group->socks[i];
 
-        if (varPlr == nullptr || sockTo == nullptr)
+        if (varPlr == plr) {
+            moveDown = 1;
             continue;
+        }
 
-        if (moveDown == 1)
-            otherPlr->groupIDs[i-1] = otherPlr->groupIDs[i];
-
-        respdata[i-moveDown].iPC_ID = varPlr->iID;
-        respdata[i-moveDown].iPCUID = varPlr->PCStyle.iPC_UID;
-        respdata[i-moveDown].iNameCheck = varPlr->PCStyle.iNameCheck;
-        memcpy(respdata[i-moveDown].szFirstName, varPlr->PCStyle.szFirstName, sizeof(varPlr->PCStyle.szFirstName));
-        memcpy(respdata[i-moveDown].szLastName, varPlr->PCStyle.szLastName, sizeof(varPlr->PCStyle.szLastName));
-        respdata[i-moveDown].iSpecialState = varPlr->iSpecialState;
-        respdata[i-moveDown].iLv = varPlr->level;
-        respdata[i-moveDown].iHP = varPlr->HP;
-        respdata[i-moveDown].iMaxHP = PC_MAXHEALTH(varPlr->level);
-        // respdata[i-moveDown]].iMapType = 0;
-        // respdata[i-moveDown]].iMapNum = 0;
-        respdata[i-moveDown].iX = varPlr->x;
-        respdata[i-moveDown].iY = varPlr->y;
-        respdata[i-moveDown].iZ = varPlr->z;
+        fillMemberInfo(&respdata[i-moveDown], varPlr);
         // client doesnt read nano data here
 
-        if (varPlr == plr) {
-            moveDown = 1;
-            otherPlr->groupIDs[i] = 0;
-        } else { // remove the leaving member's buffs from the group and remove the group buffs from the leaving member.
-            if (NanoManager::SkillTable[varPlr->Nanos[varPlr->activeNano].iSkillID].targetType == 3)
-                NanoManager::applyBuff(sock, varPlr->Nanos[varPlr->activeNano].iSkillID, 2, 1, 0);
-            if (NanoManager::SkillTable[plr->Nanos[varPlr->activeNano].iSkillID].targetType == 3)
-                NanoManager::applyBuff(sockTo, plr->Nanos[plr->activeNano].iSkillID, 2, 1, bitFlag);
-        }
+        // remove the leaving member's buffs from the group and remove the group buffs from the leaving member.
+        if (NanoManager::SkillTable[varPlr->Nanos[varPlr->activeNano].iSkillID].targetType == 3)
+            NanoManager::applyBuff(sock, varPlr->Nanos[varPlr->activeNano].iSkillID, 2, 1, 0);
+        if (NanoManager::SkillTable[plr->Nanos[varPlr->activeNano].iSkillID].targetType == 3)
+            NanoManager::applyBuff(sockTo, plr->Nanos[plr->activeNano].iSkillID, 2, 1, bitFlag);
     }
 
-    plr->iIDGroup = plr->iID;
-    otherPlr->groupCnt -= 1;
+    group->members.erase(group->members.begin() + idx);
+    group->socks.erase(group->socks.begin() + idx);
+    group->lastInfo.clear();
+    plr->group = nullptr;
 
-    sendToGroup(otherPlr, (void*)&respbuf, P_FE2CL_PC_GROUP_LEAVE, resplen);
+    sendToGroup(group, (void*)&respbuf, P_FE2CL_PC_GROUP_LEAVE, resplen);
 
     INITSTRUCT(sP_FE2CL_PC_GROUP_LEAVE_SUCC, resp1);
     sock->sendPacket((void*)&resp1, P_FE2CL_PC_GROUP_LEAVE_SUCC, sizeof(sP_FE2CL_PC_GROUP_LEAVE_SUCC));
+
+    // a group of one is just a player again
+    if (group->members.size() == 1) {
+        group->members[0]->group = nullptr;
+        Groups.erase(group->members[0]->iID);
+        delete group;
+    }
 }
 
-void GroupManager::groupUnbuff(Player* plr) {
-    for (int i = 0; i < plr->groupCnt; i++) {
-        for (int n = 0; n < plr->groupCnt; n++) {
+void GroupManager::groupUnbuff(Group* group) {
+    for (size_t i = 0; i < group->members.size(); i++) {
+        for (size_t n = 0; n < group->members.size(); n++) {
             if (i == n)
                 continue;
 
-            Player* otherPlr = PlayerManager::getPlayerFromID(plr->groupIDs[i]);
-            CNSocket* sock = PlayerManager::getSockFromID(plr->groupIDs[n]);
-
-            NanoManager::applyBuff(sock, otherPlr->Nanos[otherPlr->activeNano].iSkillID, 2, 1, 0);
+            Player* otherPlr = group->members[i];
+            NanoManager::applyBuff(group->socks[n], otherPlr->Nanos[otherPlr->activeNano].iSkillID, 2, 1, 0);
         }
     }
 }
 
+/*
+ * Group buffs in effect for a player, whether or not they're in a group.
+ */
 int GroupManager::getGroupFlags(Player* plr) {
-    int bitFlag = 0;
+    if (plr->group == nullptr)
+        return plr->iGroupConditionBitFlag;
 
-    for (int i = 0; i < plr->groupCnt; i++) {
-        Player* otherPlr = PlayerManager::getPlayerFromID(plr->groupIDs[i]);
-
-        if (otherPlr == nullptr)
-            continue;
+    int bitFlag = 0;
 
+    for (Player* otherPlr : plr->group->members)
         bitFlag |= otherPlr->iGroupConditionBitFlag;
-    }
 
     return bitFlag;
 }
+
+// players on their own lead themselves, as far as instances and invites are concerned
+int32_t GroupManager::getLeaderID(Player* plr) {
+    return plr->group == nullptr ? plr->iID : plr->group->members[0]->iID;
+}
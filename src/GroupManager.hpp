@@ -7,8 +7,22 @@
 
 #include <map>
 #include <list>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * A group of two to four players. Players on their own aren't in one; a group
+ * is made when someone accepts an invite and disbanded once it's down to one.
+ */
+struct Group {
+    std::vector<Player*> members; // the leader comes first
+    std::vector<CNSocket*> socks; // same order as members
+    std::vector<sPCGroupMemberInfo> lastInfo; // what the last member info tick said about each member
+};
 
 namespace GroupManager {
+    extern std::unordered_map<int32_t, Group*> Groups; // leader IDs to their groups
+
 	void init();
 
     void requestGroup(CNSocket* sock, CNPacketData* data);
@@ -17,9 +31,10 @@ namespace GroupManager {
 	void leaveGroup(CNSocket* sock, CNPacketData* data);
     void chatGroup(CNSocket* sock, CNPacketData* data);
     void menuChatGroup(CNSocket* sock, CNPacketData* data);
-    void sendToGroup(Player* plr, void* buf, uint32_t type, size_t size);
-    void groupTickInfo(Player* plr);
+    void sendToGroup(Group* group, void* buf, uint32_t type, size_t size);
+    void groupTickInfo(Group* group);
     void groupKickPlayer(Player* plr);
-    void groupUnbuff(Player* plr);
+    void groupUnbuff(Group* group);
     int getGroupFlags(Player* plr);
+    int32_t getLeaderID(Player* plr);
 }
@@ -0,0 +1,211 @@
+#include "Inbox.hpp"
+#include "CNShared.hpp"
+
+#include <climits>
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+struct Mail {
+    Database::EmailData data;
+    sItemBase items[4];
+    bool opened; // the body and attachments have been loaded
+};
+
+struct Mailbox {
+    std::map<int, Mail, std::greater<int>> mail; // by MsgIndex, newest first
+    int unread;
+};
+
+static std::unordered_map<int, Mailbox> mailboxes;
+
+// anyone the email handlers ask about is online, but load them if they somehow aren't
+static Mailbox& getMailbox(int playerID) {
+    auto it = mailboxes.find(playerID);
+    if (it == mailboxes.end()) {
+        Inbox::load(playerID);
+        it = mailboxes.find(playerID);
+    }
+    return it->second;
+}
+
+// fetches what the headers left out the first time a message is needed in full
+static Mail* openMail(int playerID, int index) {
+    Mailbox& box = getMailbox(playerID);
+    auto it = box.mail.find(index);
+    if (it == box.mail.end())
+        return nullptr;
+
+    Mail& mail = it->second;
+    if (!mail.opened) {
+        mail.data.MsgBody = Database::getEmail(playerID, index).MsgBody;
+        sItemBase* items = Database::getEmailAttachments(playerID, index);
+        for (int i = 0; i < 4; i++)
+            mail.items[i] = items[i];
+        delete[] items;
+        mail.opened = true;
+    }
+
+    return &mail;
+}
+
+// the client shows the flag as long as there are taros or items left to take; true if it changed
+static bool updateItemFlag(Mail* mail) {
+    int flag = mail->data.Taros > 0 ? 1 : 0;
+    for (int i = 0; i < 4; i++)
+        if (mail->items[i].iID != 0)
+            flag = 1;
+
+    if (flag == mail->data.ItemFlag)
+        return false;
+    mail->data.ItemFlag = flag;
+    return true;
+}
+
+void Inbox::load(int playerID, const std::vector<Database::EmailData>& headers) {
+    Mailbox& box = mailboxes[playerID];
+    box.mail.clear();
+    box.unread = 0;
+
+    for (const Database::EmailData& email : headers) {
+        Mail& mail = box.mail[email.MsgIndex];
+        mail = {};
+        mail.data = email;
+        if (email.ReadFlag == 0)
+            box.unread++;
+    }
+}
+
+void Inbox::load(int playerID) {
+    load(playerID, Database::getEmails(playerID, INT_MAX, -1));
+}
+
+void Inbox::unload(int playerID) {
+    mailboxes.erase(playerID);
+}
+
+int Inbox::unreadCount(int playerID) {
+    return getMailbox(playerID).unread;
+}
+
+std::vector<Database::EmailData> Inbox::getPage(int playerID, int page) {
+    Mailbox& box = getMailbox(playerID);
+    std::vector<Database::EmailData> emails;
+
+    int offset = 5 * page - 5;
+    for (auto it = box.mail.begin(); it != box.mail.end() && emails.size() < 5; it++) {
+        if (offset-- > 0)
+            continue;
+        emails.push_back(it->second.data);
+        emails.back().MsgBody.clear();
+    }
+
+    return emails;
+}
+
+bool Inbox::read(int playerID, int index, Database::EmailData* email, sItemBase* items) {
+    Mail* mail = openMail(playerID, index);
+    if (mail == nullptr)
+        return false;
+
+    if (mail->data.ReadFlag == 0) {
+        mail->data.ReadFlag = 1;
+        getMailbox(playerID).unread--;
+        Database::updateEmailContent(&mail->data);
+    }
+
+    *email = mail->data;
+    for (int i = 0; i < 4; i++)
+        items[i] = mail->items[i];
+    return true;
+}
+
+bool Inbox::takeTaros(int playerID, int index, int* taros) {
+    Mail* mail = openMail(playerID, index);
+    if (mail == nullptr)
+        return false;
+
+    *taros = mail->data.Taros;
+    if (mail->data.Taros != 0) {
+        mail->data.Taros = 0;
+        updateItemFlag(mail);
+        Database::updateEmailContent(&mail->data);
+    }
+    return true;
+}
+
+bool Inbox::takeItem(int playerID, int index, int slot, sItemBase* item) {
+    if (slot < 1 || slot > 4)
+        return false;
+
+    Mail* mail = openMail(playerID, index);
+    if (mail == nullptr)
+        return false;
+
+    *item = mail->items[slot - 1];
+    mail->items[slot - 1] = { 0, 0, 0, 0 };
+    Database::deleteEmailAttachments(playerID, index, slot);
+    if (updateItemFlag(mail))
+        Database::updateEmailContent(&mail->data);
+    return true;
+}
+
+bool Inbox::takeAllItems(int playerID, int index, sItemBase* items) {
+    Mail* mail = openMail(playerID, index);
+    if (mail == nullptr)
+        return false;
+
+    for (int i = 0; i < 4; i++) {
+        items[i] = mail->items[i];
+        mail->items[i] = { 0, 0, 0, 0 };
+    }
+    Database::deleteEmailAttachments(playerID, index, -1);
+    if (updateItemFlag(mail))
+        Database::updateEmailContent(&mail->data);
+    return true;
+}
+
+void Inbox::remove(int playerID, int64_t* indices) {
+    Mailbox& box = getMailbox(playerID);
+
+    for (int i = 0; i < 5; i++) {
+        auto it = box.mail.find(indices[i]);
+        if (it == box.mail.end())
+            continue;
+        if (it->second.data.ReadFlag == 0)
+            box.unread--;
+        box.mail.erase(it);
+    }
+
+    Database::deleteEmails(playerID, indices);
+}
+
+bool Inbox::send(Database::EmailData* data, std::vector<sItemBase> attachments) {
+    auto it = mailboxes.find(data->PlayerId);
+    if (it == mailboxes.end()) {
+        // not online; it'll be loaded from the database with the rest, unless that's already underway
+        data->MsgIndex = Database::getNextEmailIndex(data->PlayerId);
+        if (!Database::sendEmail(data, attachments))
+            return false;
+
+        Database::EmailData header = *data;
+        header.MsgBody.clear();
+        CNSharedData::addMail(data->PlayerId, header);
+        return true;
+    }
+
+    Mailbox& box = it->second;
+    data->MsgIndex = box.mail.empty() ? 1 : box.mail.begin()->first + 1;
+    if (!Database::sendEmail(data, attachments))
+        return false;
+
+    Mail& mail = box.mail[data->MsgIndex];
+    mail = {};
+    mail.data = *data;
+    for (size_t i = 0; i < attachments.size() && i < 4; i++)
+        mail.items[i] = attachments[i];
+    mail.opened = true;
+    if (mail.data.ReadFlag == 0)
+        box.unread++;
+    return true;
+}
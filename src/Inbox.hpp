@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Database.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * The mailboxes of everyone online, so checking for mail, paging through it
+ * and reading it don't go to the database.
+ *
+ * Headers are fetched by the login server when a character is picked, handed
+ * over through CNSharedData when they enter the shard, and dropped when they
+ * leave; a message's body and attachments are fetched the first time it's
+ * opened. Changes land here first and are then written through Database,
+ * which queues them. Mail for someone who isn't online goes straight to the
+ * database, and they'll load it with the rest when they come in.
+ *
+ * Shard thread only.
+ */
+namespace Inbox {
+    // headers as returned by Database::getEmails(); the second form fetches them itself
+    void load(int playerID, const std::vector<Database::EmailData>& headers);
+    void load(int playerID);
+    void unload(int playerID);
+
+    int unreadCount(int playerID);
+    // five to a page, newest first, counting from 1; headers only, so no MsgBody
+    std::vector<Database::EmailData> getPage(int playerID, int page);
+
+    // these return false if there's no such message; items has room for four
+    bool read(int playerID, int index, Database::EmailData* email, sItemBase* items);
+    bool takeTaros(int playerID, int index, int* taros);
+    bool takeItem(int playerID, int index, int slot, sItemBase* item); // slot counts from 1
+    bool takeAllItems(int playerID, int index, sItemBase* items);
+    void remove(int playerID, int64_t* indices); // the five the client sends
+
+    // picks data->MsgIndex; false if the database turned it down
+    bool send(Database::EmailData* data, std::vector<sItemBase> attachments);
+}
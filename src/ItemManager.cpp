@@ -6,6 +6,7 @@
 #include "NPCManager.hpp"
 #include "Player.hpp"
 #include "ChatManager.hpp"
+#include "Rand.hpp"
 
 #include <string.h> // for memset()
 #include <assert.h>
@@ -54,14 +55,14 @@ void ItemManager::itemMoveHandler(CNSocket* sock, CNPacketData* data) {
     Player* plr = PlayerManager::getPlayer(sock);
 
     // sanity check
-    if (plr->Equip[itemmove->iFromSlotNum].iType != 0 && itemmove->eFrom == 0 && itemmove->eTo == 0) {
+    if (plr->cold->Equip[itemmove->iFromSlotNum].iType != 0 && itemmove->eFrom == 0 && itemmove->eTo == 0) {
         // this packet should never happen unless it is a weapon, tell the client to do nothing and do nothing ourself
         resp.eTo = itemmove->eFrom;
         resp.iToSlotNum = itemmove->iFromSlotNum;
-        resp.ToSlotItem = plr->Equip[itemmove->iToSlotNum];
+        resp.ToSlotItem = plr->cold->Equip[itemmove->iToSlotNum];
         resp.eFrom = itemmove->eTo;
         resp.iFromSlotNum = itemmove->iToSlotNum;
-        resp.FromSlotItem = plr->Equip[itemmove->iFromSlotNum];
+        resp.FromSlotItem = plr->cold->Equip[itemmove->iFromSlotNum];
 
         sock->sendPacket((void*)&resp, P_FE2CL_PC_ITEM_MOVE_SUCC, sizeof(sP_FE2CL_PC_ITEM_MOVE_SUCC));
         return;
@@ -75,13 +76,13 @@ void ItemManager::itemMoveHandler(CNSocket* sock, CNPacketData* data) {
     sItemBase *fromItem;
     switch ((SlotType)itemmove->eFrom) {
         case SlotType::EQUIP:
-            fromItem = &plr->Equip[itemmove->iFromSlotNum];
+            fromItem = &plr->cold->Equip[itemmove->iFromSlotNum];
             break;
         case SlotType::INVENTORY:
-            fromItem = &plr->Inven[itemmove->iFromSlotNum];
+            fromItem = &plr->cold->Inven[itemmove->iFromSlotNum];
             break;
         case SlotType::BANK:
-            fromItem = &plr->Bank[itemmove->iFromSlotNum];
+            fromItem = &plr->cold->Bank[itemmove->iFromSlotNum];
             break;
         default:
             std::cout << "[WARN] MoveItem submitted unknown Item Type?! " << itemmove->eFrom << std::endl;
@@ -92,13 +93,13 @@ void ItemManager::itemMoveHandler(CNSocket* sock, CNPacketData* data) {
     sItemBase* toItem;
     switch ((SlotType)itemmove->eTo) {
     case SlotType::EQUIP:
-        toItem = &plr->Equip[itemmove->iToSlotNum];
+        toItem = &plr->cold->Equip[itemmove->iToSlotNum];
         break;
     case SlotType::INVENTORY:
-        toItem = &plr->Inven[itemmove->iToSlotNum];
+        toItem = &plr->cold->Inven[itemmove->iToSlotNum];
         break;
     case SlotType::BANK:
-        toItem = &plr->Bank[itemmove->iToSlotNum];
+        toItem = &plr->cold->Bank[itemmove->iToSlotNum];
         break;
     default:
         std::cout << "[WARN] MoveItem submitted unknown Item Type?! " << itemmove->eTo << std::endl;
@@ -156,7 +157,7 @@ void ItemManager::itemMoveHandler(CNSocket* sock, CNPacketData* data) {
         }
 
         // unequip vehicle if equip slot 8 is 0
-        if (plr->Equip[8].iID == 0)
+        if (plr->cold->Equip[8].iID == 0)
             plr->iPCState = 0;
 
         // send equip event to other players
@@ -187,9 +188,9 @@ void ItemManager::itemDeleteHandler(CNSocket* sock, CNPacketData* data) {
     resp.iSlotNum = itemdel->iSlotNum;
 
     // so, im not sure what this eIL thing does since you always delete items in inventory and not equips
-    plr->Inven[itemdel->iSlotNum].iID = 0;
-    plr->Inven[itemdel->iSlotNum].iType = 0;
-    plr->Inven[itemdel->iSlotNum].iOpt = 0;
+    plr->cold->Inven[itemdel->iSlotNum].iID = 0;
+    plr->cold->Inven[itemdel->iSlotNum].iType = 0;
+    plr->cold->Inven[itemdel->iSlotNum].iOpt = 0;
 
     sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_ITEM_DELETE_SUCC, sizeof(sP_FE2CL_REP_PC_ITEM_DELETE_SUCC));
 }
@@ -228,7 +229,7 @@ void ItemManager::itemGMGiveHandler(CNSocket* sock, CNPacketData* data) {
         }
         resp.Item = itemreq->Item;
 
-        plr->Inven[itemreq->iSlotNum] = itemreq->Item;
+        plr->cold->Inven[itemreq->iSlotNum] = itemreq->Item;
 
         sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_GIVE_ITEM_SUCC, sizeof(sP_FE2CL_REP_PC_GIVE_ITEM_SUCC));
     }
@@ -244,7 +245,7 @@ void ItemManager::itemUseHandler(CNSocket* sock, CNPacketData* data) {
         return; // sanity check
 
     // gumball can only be used from inventory, so we ignore eIL
-    sItemBase gumball = player->Inven[request->iSlotNum];
+    sItemBase gumball = player->cold->Inven[request->iSlotNum];
     sNano nano = player->Nanos[player->equippedNanos[request->iNanoSlot]];
 
     // sanity check, check if gumball exists
@@ -310,7 +311,7 @@ void ItemManager::itemUseHandler(CNSocket* sock, CNPacketData* data) {
 
     sock->sendPacket((void*)&respbuf, P_FE2CL_REP_PC_ITEM_USE_SUCC, resplen);
     // update inventory serverside
-    player->Inven[resp->iSlotNum] = resp->RemainItem;
+    player->cold->Inven[resp->iSlotNum] = resp->RemainItem;
 
     std::pair<CNSocket*, int32_t> key = std::make_pair(sock, value1);
     time_t until = getTime() + (time_t)NanoManager::SkillTable[144].durationTime[0] * 100;
@@ -326,7 +327,7 @@ void ItemManager::itemBankOpenHandler(CNSocket* sock, CNPacketData* data) {
     // just send bank inventory
     INITSTRUCT(sP_FE2CL_REP_PC_BANK_OPEN_SUCC, resp);
     for (int i = 0; i < ABANK_COUNT; i++) {
-        resp.aBank[i] = plr->Bank[i];
+        resp.aBank[i] = plr->cold->Bank[i];
     }
     resp.iExtraBank = 1;
     sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_BANK_OPEN_SUCC, sizeof(sP_FE2CL_REP_PC_BANK_OPEN_SUCC));
@@ -346,14 +347,9 @@ void ItemManager::itemTradeOfferHandler(CNSocket* sock, CNPacketData* data) {
         iID_Check = pacdat->iID_From;
     }
 
-    CNSocket* otherSock = sock;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == iID_Check) {
-            otherSock = pair.first;
-            break;
-        }
-    }
+    CNSocket* otherSock = PlayerManager::getSockFromID(iID_Check);
+    if (otherSock == nullptr)
+        otherSock = sock;
 
     Player* plr = PlayerManager::getPlayer(sock);
 
@@ -392,14 +388,9 @@ void ItemManager::itemTradeOfferAcceptHandler(CNSocket* sock, CNPacketData* data
         iID_Check = pacdat->iID_From;
     }
 
-    CNSocket* otherSock = sock;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == iID_Check) {
-            otherSock = pair.first;
-            break;
-        }
-    }
+    CNSocket* otherSock = PlayerManager::getSockFromID(iID_Check);
+    if (otherSock == nullptr)
+        otherSock = sock;
 
     INITSTRUCT(sP_FE2CL_REP_PC_TRADE_OFFER, resp);
 
@@ -432,8 +423,8 @@ void ItemManager::itemTradeOfferAcceptHandler(CNSocket* sock, CNPacketData* data
     plr->moneyInTrade = 0;
     plr2->moneyInTrade = 0;
 
-    memset(&plr->Trade, 0, sizeof(plr->Trade));
-    memset(&plr2->Trade, 0, sizeof(plr2->Trade));
+    memset(&plr->cold->Trade, 0, sizeof(plr->cold->Trade));
+    memset(&plr2->cold->Trade, 0, sizeof(plr2->cold->Trade));
 
     otherSock->sendPacket((void*)&resp, P_FE2CL_REP_PC_TRADE_OFFER_SUCC, sizeof(sP_FE2CL_REP_PC_TRADE_OFFER_SUCC));
 }
@@ -457,14 +448,9 @@ void ItemManager::itemTradeOfferRefusalHandler(CNSocket* sock, CNPacketData* dat
         iID_Check = pacdat->iID_From;
     }
 
-    CNSocket* otherSock = sock;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == iID_Check) {
-            otherSock = pair.first;
-            break;
-        }
-    }
+    CNSocket* otherSock = PlayerManager::getSockFromID(iID_Check);
+    if (otherSock == nullptr)
+        otherSock = sock;
 
     otherSock->sendPacket((void*)&resp, P_FE2CL_REP_PC_TRADE_OFFER_REFUSAL, sizeof(sP_FE2CL_REP_PC_TRADE_OFFER_REFUSAL));
 }
@@ -483,14 +469,9 @@ void ItemManager::itemTradeConfirmHandler(CNSocket* sock, CNPacketData* data) {
         iID_Check = pacdat->iID_From;
     }
 
-    CNSocket* otherSock = sock;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == iID_Check) {
-            otherSock = pair.first;
-            break;
-        }
-    }
+    CNSocket* otherSock = PlayerManager::getSockFromID(iID_Check);
+    if (otherSock == nullptr)
+        otherSock = sock;
 
     Player* plr = PlayerManager::getPlayer(sock);
     Player* plr2 = PlayerManager::getPlayer(otherSock);
@@ -509,22 +490,22 @@ void ItemManager::itemTradeConfirmHandler(CNSocket* sock, CNPacketData* data) {
         int freeSlotsNeeded2 = 0;
 
         for (int i = 0; i < AINVEN_COUNT; i++) {
-            if (plr->Inven[i].iID == 0)
+            if (plr->cold->Inven[i].iID == 0)
                 freeSlots++;
         }
 
         for (int i = 0; i < 5; i++) {
-            if (plr->Trade[i].iID != 0)
+            if (plr->cold->Trade[i].iID != 0)
                 freeSlotsNeeded++;
         }
 
         for (int i = 0; i < AINVEN_COUNT; i++) {
-            if (plr2->Inven[i].iID == 0)
+            if (plr2->cold->Inven[i].iID == 0)
                 freeSlots2++;
         }
 
         for (int i = 0; i < 5; i++) {
-            if (plr2->Trade[i].iID != 0)
+            if (plr2->cold->Trade[i].iID != 0)
                 freeSlotsNeeded2++;
         }
 
@@ -562,27 +543,27 @@ void ItemManager::itemTradeConfirmHandler(CNSocket* sock, CNPacketData* data) {
         // ^^ this is a must have or else the player won't accept a succ packet for some reason
 
         for (int i = 0; i < freeSlotsNeeded; i++) {
-            plr->Inven[plr->Trade[i].iInvenNum].iID = 0;
-            plr->Inven[plr->Trade[i].iInvenNum].iType = 0;
-            plr->Inven[plr->Trade[i].iInvenNum].iOpt = 0;
+            plr->cold->Inven[plr->cold->Trade[i].iInvenNum].iID = 0;
+            plr->cold->Inven[plr->cold->Trade[i].iInvenNum].iType = 0;
+            plr->cold->Inven[plr->cold->Trade[i].iInvenNum].iOpt = 0;
         }
 
         for (int i = 0; i < freeSlotsNeeded2; i++) {
-            plr2->Inven[plr2->Trade[i].iInvenNum].iID = 0;
-            plr2->Inven[plr2->Trade[i].iInvenNum].iType = 0;
-            plr2->Inven[plr2->Trade[i].iInvenNum].iOpt = 0;
+            plr2->cold->Inven[plr2->cold->Trade[i].iInvenNum].iID = 0;
+            plr2->cold->Inven[plr2->cold->Trade[i].iInvenNum].iType = 0;
+            plr2->cold->Inven[plr2->cold->Trade[i].iInvenNum].iOpt = 0;
         }
 
         for (int i = 0; i < AINVEN_COUNT; i++) {
             if (freeSlotsNeeded <= 0)
                     break;
 
-            if (plr2->Inven[i].iID == 0) {
+            if (plr2->cold->Inven[i].iID == 0) {
 
-                plr2->Inven[i].iID = plr->Trade[freeSlotsNeeded - 1].iID;
-                plr2->Inven[i].iType = plr->Trade[freeSlotsNeeded - 1].iType;
-                plr2->Inven[i].iOpt = plr->Trade[freeSlotsNeeded - 1].iOpt;
-                plr->Trade[freeSlotsNeeded - 1].iInvenNum = i;
+                plr2->cold->Inven[i].iID = plr->cold->Trade[freeSlotsNeeded - 1].iID;
+                plr2->cold->Inven[i].iType = plr->cold->Trade[freeSlotsNeeded - 1].iType;
+                plr2->cold->Inven[i].iOpt = plr->cold->Trade[freeSlotsNeeded - 1].iOpt;
+                plr->cold->Trade[freeSlotsNeeded - 1].iInvenNum = i;
                 freeSlotsNeeded--;
             }
         }
@@ -591,12 +572,12 @@ void ItemManager::itemTradeConfirmHandler(CNSocket* sock, CNPacketData* data) {
             if (freeSlotsNeeded2 <= 0)
                 break;
 
-            if (plr->Inven[i].iID == 0) {
+            if (plr->cold->Inven[i].iID == 0) {
 
-                plr->Inven[i].iID = plr2->Trade[freeSlotsNeeded2 - 1].iID;
-                plr->Inven[i].iType = plr2->Trade[freeSlotsNeeded2 - 1].iType;
-                plr->Inven[i].iOpt = plr2->Trade[freeSlotsNeeded2 - 1].iOpt;
-                plr2->Trade[freeSlotsNeeded2 - 1].iInvenNum = i;
+                plr->cold->Inven[i].iID = plr2->cold->Trade[freeSlotsNeeded2 - 1].iID;
+                plr->cold->Inven[i].iType = plr2->cold->Trade[freeSlotsNeeded2 - 1].iType;
+                plr->cold->Inven[i].iOpt = plr2->cold->Trade[freeSlotsNeeded2 - 1].iOpt;
+                plr2->cold->Trade[freeSlotsNeeded2 - 1].iInvenNum = i;
                 freeSlotsNeeded2--;
             }
         }
@@ -610,16 +591,16 @@ void ItemManager::itemTradeConfirmHandler(CNSocket* sock, CNPacketData* data) {
         plr->money = plr->money + plr2->moneyInTrade - plr->moneyInTrade;
         resp2.iCandy = plr->money;
 
-        memcpy(resp2.Item, plr2->Trade, sizeof(plr2->Trade));
-        memcpy(resp2.ItemStay, plr->Trade, sizeof(plr->Trade));
+        memcpy(resp2.Item, plr2->cold->Trade, sizeof(plr2->cold->Trade));
+        memcpy(resp2.ItemStay, plr->cold->Trade, sizeof(plr->cold->Trade));
 
         sock->sendPacket((void*)&resp2, P_FE2CL_REP_PC_TRADE_CONFIRM_SUCC, sizeof(sP_FE2CL_REP_PC_TRADE_CONFIRM_SUCC));
 
         plr2->money = plr2->money + plr->moneyInTrade - plr2->moneyInTrade;
         resp2.iCandy = plr2->money;
 
-        memcpy(resp2.Item, plr->Trade, sizeof(plr->Trade));
-        memcpy(resp2.ItemStay, plr2->Trade, sizeof(plr2->Trade));
+        memcpy(resp2.Item, plr->cold->Trade, sizeof(plr->cold->Trade));
+        memcpy(resp2.ItemStay, plr2->cold->Trade, sizeof(plr2->cold->Trade));
 
         otherSock->sendPacket((void*)&resp2, P_FE2CL_REP_PC_TRADE_CONFIRM_SUCC, sizeof(sP_FE2CL_REP_PC_TRADE_CONFIRM_SUCC));
     } else {
@@ -656,13 +637,9 @@ void ItemManager::itemTradeConfirmCancelHandler(CNSocket* sock, CNPacketData* da
         iID_Check = pacdat->iID_From;
     }
 
-    CNSocket* otherSock = sock;
-
-    for (auto pair : PlayerManager::players) {
-        if (pair.second->iID == iID_Check) {
-            otherSock = pair.first;
-        }
-    }
+    CNSocket* otherSock = PlayerManager::getSockFromID(iID_Check);
+    if (otherSock == nullptr)
+        otherSock = sock;
 
     Player* plr = PlayerManager::getPlayer(sock);
     Player* plr2 = PlayerManager::getPlayer(otherSock);
@@ -700,16 +677,12 @@ void ItemManager::itemTradeRegisterItemHandler(CNSocket* sock, CNPacketData* dat
         iID_Check = pacdat->iID_From;
     }
 
-    CNSocket* otherSock = sock;
-
-    for (auto pair : PlayerManager::players) {
-        if (pair.second->iID == iID_Check) {
-            otherSock = pair.first;
-        }
-    }
+    CNSocket* otherSock = PlayerManager::getSockFromID(iID_Check);
+    if (otherSock == nullptr)
+        otherSock = sock;
 
     Player* plr = PlayerManager::getPlayer(sock);
-    plr->Trade[pacdat->Item.iSlotNum] = pacdat->Item;
+    plr->cold->Trade[pacdat->Item.iSlotNum] = pacdat->Item;
     plr->isTradeConfirm = false;
 
     sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_TRADE_ITEM_REGISTER_SUCC, sizeof(sP_FE2CL_REP_PC_TRADE_ITEM_REGISTER_SUCC));
@@ -729,7 +702,7 @@ void ItemManager::itemTradeUnregisterItemHandler(CNSocket* sock, CNPacketData* d
     resp.TradeItem = pacdat->Item;
 
     Player* plr = PlayerManager::getPlayer(sock);
-    resp.InvenItem = plr->Trade[pacdat->Item.iSlotNum];
+    resp.InvenItem = plr->cold->Trade[pacdat->Item.iSlotNum];
     plr->isTradeConfirm = false;
 
     int iID_Check;
@@ -740,22 +713,18 @@ void ItemManager::itemTradeUnregisterItemHandler(CNSocket* sock, CNPacketData* d
         iID_Check = pacdat->iID_From;
     }
 
-    CNSocket* otherSock = sock;
-
-    for (auto pair : PlayerManager::players) {
-        if (pair.second->iID == iID_Check) {
-            otherSock = pair.first;
-        }
-    }
+    CNSocket* otherSock = PlayerManager::getSockFromID(iID_Check);
+    if (otherSock == nullptr)
+        otherSock = sock;
 
     int temp_num = pacdat->Item.iSlotNum;
 
     if (temp_num >= 0 && temp_num <= 4) {
-        plr->Trade[temp_num].iID = 0;
-        plr->Trade[temp_num].iType = 0;
-        plr->Trade[temp_num].iOpt = 0;
-        plr->Trade[temp_num].iInvenNum = 0;
-        plr->Trade[temp_num].iSlotNum = 0;
+        plr->cold->Trade[temp_num].iID = 0;
+        plr->cold->Trade[temp_num].iType = 0;
+        plr->cold->Trade[temp_num].iOpt = 0;
+        plr->cold->Trade[temp_num].iInvenNum = 0;
+        plr->cold->Trade[temp_num].iSlotNum = 0;
     }
 
     sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_TRADE_ITEM_UNREGISTER_SUCC, sizeof(sP_FE2CL_REP_PC_TRADE_ITEM_UNREGISTER_SUCC));
@@ -788,13 +757,9 @@ void ItemManager::itemTradeRegisterCashHandler(CNSocket* sock, CNPacketData* dat
         iID_Check = pacdat->iID_From;
     }
 
-    CNSocket* otherSock = sock;
-
-    for (auto pair : PlayerManager::players) {
-        if (pair.second->iID == iID_Check) {
-            otherSock = pair.first;
-        }
-    }
+    CNSocket* otherSock = PlayerManager::getSockFromID(iID_Check);
+    if (otherSock == nullptr)
+        otherSock = sock;
 
     plr->moneyInTrade = pacdat->iCandy;
     plr->isTradeConfirm = false;
@@ -917,11 +882,11 @@ void ItemManager::chestOpenHandler(CNSocket *sock, CNPacketData *data) {
     // if we failed to open a crate, at least give the player a gumball (suggested by Jade)
     if (failing) {
         item->sItem.iType = 7;
-        item->sItem.iID = 119 + (rand() % 3);
+        item->sItem.iID = 119 + Rand::next(Rand::LOOT, 3);
         item->sItem.iOpt = 1;
     }
     // update player
-    plr->Inven[chest->iSlotNum] = item->sItem;
+    plr->cold->Inven[chest->iSlotNum] = item->sItem;
 
     // transmit item
     sock->sendPacket((void*)respbuf, P_FE2CL_REP_REWARD_ITEM, resplen);
@@ -939,7 +904,7 @@ int ItemManager::getItemSetId(Crate& crate, int crateId) {
     }
 
     // if crate points to multiple itemSets, choose a random one
-    int itemSetIndex = rand() % itemSetsCount;
+    int itemSetIndex = Rand::next(Rand::LOOT, itemSetsCount);
     return crate.itemSets[itemSetIndex];
 }
 
@@ -964,25 +929,14 @@ int ItemManager::getRarity(Crate& crate, int itemSetId) {
             rarityRatio[i] = 0;
     }
 
-    int total = 0;
-    for (int value : rarityRatio)
-        total += value;
-
-    if (total == 0) {
+    // now return a random rarity number
+    int rarity = Rand::weighted(Rand::LOOT, rarityRatio.data(), rarityRatio.size());
+    if (rarity == -1) {
         std::cout << "Item Set " << itemSetId << " has no items assigned?!" << std::endl;
         return -1;
     }
 
-    // now return a random rarity number
-    int randomNum = rand() % total;
-    int rarity = 0;
-    int sum = 0;
-    do {
-        sum += rarityRatio[rarity];
-        rarity++;
-    } while (sum <= randomNum);
-
-    return rarity;
+    return rarity + 1;
 }
 
 int ItemManager::getCrateItem(sItemBase& result, int itemSetId, int rarity, int playerGender) {
@@ -1008,7 +962,7 @@ int ItemManager::getCrateItem(sItemBase& result, int itemSetId, int rarity, int
         return -1;
     }
 
-    auto item = items[rand() % items.size()];
+    auto item = items[Rand::next(Rand::LOOT, items.size())];
 
     result.iID = item->first.first;
     result.iType = item->first.second;
@@ -1022,7 +976,7 @@ int ItemManager::findFreeSlot(Player *plr) {
     int i;
 
     for (i = 0; i < AINVEN_COUNT; i++)
-        if (plr->Inven[i].iType == 0 && plr->Inven[i].iID == 0 && plr->Inven[i].iOpt == 0)
+        if (plr->cold->Inven[i].iType == 0 && plr->cold->Inven[i].iID == 0 && plr->cold->Inven[i].iOpt == 0)
             return i;
 
     // not found
@@ -1062,9 +1016,9 @@ void ItemManager::checkItemExpire(CNSocket* sock, Player* player) {
 
     // delete serverside
     if (player->toRemoveVehicle.eIL == 0)
-        memset(&player->Equip[8], 0, sizeof(sItemBase));
+        memset(&player->cold->Equip[8], 0, sizeof(sItemBase));
     else
-        memset(&player->Inven[player->toRemoveVehicle.iSlotNum], 0, sizeof(sItemBase));
+        memset(&player->cold->Inven[player->toRemoveVehicle.iSlotNum], 0, sizeof(sItemBase));
 
     player->toRemoveVehicle.eIL = 0;
     player->toRemoveVehicle.iSlotNum = 0;
@@ -1079,7 +1033,7 @@ void ItemManager::setItemStats(Player* plr) {
     Item* itemStatsDat;
 
     for (int i = 0; i < 4; i++) {
-        itemStatsDat = ItemManager::getItemData(plr->Equip[i].iID, plr->Equip[i].iType);
+        itemStatsDat = ItemManager::getItemData(plr->cold->Equip[i].iID, plr->cold->Equip[i].iType);
         if (itemStatsDat == nullptr) {
             std::cout << "[WARN] setItemStats(): getItemData() returned NULL" << std::endl;
             continue;
@@ -1097,7 +1051,7 @@ void ItemManager::updateEquips(CNSocket* sock, Player* plr) {
 
         resp.iPC_ID = plr->iID;
         resp.iEquipSlotNum = i;
-        resp.EquipSlotItem = plr->Equip[i];
+        resp.EquipSlotItem = plr->cold->Equip[i];
 
         PlayerManager::sendToViewable(sock, (void*)&resp, P_FE2CL_PC_EQUIP_CHANGE, sizeof(sP_FE2CL_PC_EQUIP_CHANGE));
     }
@@ -1137,7 +1091,7 @@ void ItemManager::nanoCapsuleHandler(CNSocket* sock, sP_CL2FE_REQ_ITEM_CHEST_OPE
     item->eIL = chest->eIL;
     
     // update player serverside
-    plr->Inven[chest->iSlotNum] = item->sItem;
+    plr->cold->Inven[chest->iSlotNum] = item->sItem;
 
     // transmit item
     sock->sendPacket((void*)respbuf, P_FE2CL_REP_REWARD_ITEM, resplen);
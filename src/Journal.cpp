@@ -0,0 +1,222 @@
+#include "Journal.hpp"
+#include "CNShardServer.hpp"
+#include "PlayerManager.hpp"
+#include "PlayerSnapshot.hpp"
+#include "SaveQueue.hpp"
+#include "Database.hpp"
+#include "settings.hpp"
+
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.mutex.h"
+#else
+    #include <mutex>
+#endif
+
+static std::mutex journalLock;
+static FILE* journal = nullptr;
+static bool checkpointPending = false;
+
+// the last record written for each player, so unchanged players cost nothing
+static std::unordered_map<int32_t, std::vector<uint8_t>> lastRecorded;
+static std::vector<uint8_t> scratch;
+static uint64_t recordCount = 0, recordBytes = 0;
+
+struct RecordHeader {
+    uint32_t size;
+    uint32_t checksum;
+};
+
+static uint32_t fnv1a(const uint8_t* data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static std::string oldPath() {
+    return settings::JOURNALPATH + ".old";
+}
+
+// keeps the newest intact record per player; stops at the first torn one, which is where a crash cut off
+static int readJournal(const std::string& path, std::map<int32_t, std::vector<uint8_t>>& latest) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        return 0;
+
+    int count = 0;
+    RecordHeader header;
+    std::vector<uint8_t> data;
+
+    while (fread(&header, sizeof(header), 1, file) == 1) {
+        data.resize(header.size);
+        if (fread(data.data(), 1, header.size, file) != header.size || fnv1a(data.data(), data.size()) != header.checksum) {
+            std::cout << "[WARN] Journal: " << path << " ends in a torn record, ignoring the rest" << std::endl;
+            break;
+        }
+
+        Player plr = {};
+        if (!PlayerSnapshot::deserialize(data.data(), data.size(), &plr)) {
+            std::cout << "[WARN] Journal: skipping unreadable record in " << path << std::endl;
+            continue;
+        }
+
+        latest[plr.iID] = data;
+        count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+static void replay() {
+    std::map<int32_t, std::vector<uint8_t>> latest;
+
+    // the old file holds everything from before the last rotation, so it goes first
+    int count = readJournal(oldPath(), latest);
+    count += readJournal(settings::JOURNALPATH, latest);
+
+    if (latest.empty())
+        return;
+
+    std::vector<Player> players(latest.size());
+    std::vector<Database::PlayerSave> saves;
+    size_t i = 0;
+    for (auto& pair : latest) {
+        PlayerSnapshot::deserialize(pair.second.data(), pair.second.size(), &players[i]);
+        saves.push_back({&players[i], nullptr, false, 0});
+        i++;
+    }
+
+    Database::updatePlayers(saves);
+
+    int failed = 0;
+    for (auto& save : saves)
+        if (!save.ok)
+            failed++;
+
+    std::cout << "[INFO] Journal: recovered " << saves.size() - failed << " players from " << count << " records left by the last run";
+    if (failed > 0)
+        std::cout << " (" << failed << " failed)";
+    std::cout << std::endl;
+}
+
+void Journal::init() {
+    replay();
+
+    remove(oldPath().c_str());
+    remove(settings::JOURNALPATH.c_str());
+
+    if (settings::JOURNALINTERVAL <= 0)
+        return;
+
+    journal = fopen(settings::JOURNALPATH.c_str(), "wb");
+    if (journal == nullptr) {
+        std::cout << "[WARN] Journal: couldn't open " << settings::JOURNALPATH << ", running without one" << std::endl;
+        return;
+    }
+
+    REGISTER_SHARD_TIMER(tick, settings::JOURNALINTERVAL);
+}
+
+void Journal::close() {
+    std::lock_guard<std::mutex> lock(journalLock);
+    if (journal == nullptr)
+        return;
+
+    fclose(journal);
+    journal = nullptr;
+    lastRecorded.clear();
+
+    /*
+     * A save that failed isn't retried, and whoever it was for may have left since.
+     * The journal is the only place their progress is still written down, so it
+     * stays for init() to replay on the next start.
+     */
+    if (checkpointPending || SaveQueue::getStats().failed > 0) {
+        std::cout << "[WARN] Journal: some saves failed this run, keeping the journal for the next start" << std::endl;
+        return;
+    }
+
+    remove(oldPath().c_str());
+    remove(settings::JOURNALPATH.c_str());
+}
+
+void Journal::record(const Player* plr) {
+    std::lock_guard<std::mutex> lock(journalLock);
+    if (journal == nullptr)
+        return;
+
+    PlayerSnapshot::serialize(plr, scratch);
+
+    std::vector<uint8_t>& last = lastRecorded[plr->iID];
+    if (last == scratch)
+        return;
+
+    RecordHeader header = {(uint32_t)scratch.size(), fnv1a(scratch.data(), scratch.size())};
+    fwrite(&header, sizeof(header), 1, journal);
+    fwrite(scratch.data(), 1, scratch.size(), journal);
+
+    // hand it to the OS now; that's what survives the process dying
+    fflush(journal);
+
+    last.swap(scratch);
+    recordCount++;
+    recordBytes += sizeof(header) + last.size();
+}
+
+void Journal::forget(int32_t playerId) {
+    std::lock_guard<std::mutex> lock(journalLock);
+    lastRecorded.erase(playerId);
+}
+
+void Journal::checkpoint() {
+    {
+        std::lock_guard<std::mutex> lock(journalLock);
+        if (journal == nullptr)
+            return;
+
+        std::cout << "[INFO] Journal: " << recordCount << " records (" << recordBytes / 1024 << " KB) since the last full save" << std::endl;
+
+        // the previous rotation hasn't been fully saved yet; keep appending until it has
+        if (checkpointPending)
+            return;
+
+        fclose(journal);
+        rename(settings::JOURNALPATH.c_str(), oldPath().c_str());
+        journal = fopen(settings::JOURNALPATH.c_str(), "wb");
+        if (journal == nullptr) {
+            std::cout << "[WARN] Journal: couldn't reopen " << settings::JOURNALPATH << ", journaling stopped" << std::endl;
+            return;
+        }
+
+        // the new file has to stand on its own once the old one is gone
+        lastRecorded.clear();
+        recordCount = recordBytes = 0;
+        checkpointPending = true;
+    }
+
+    SaveQueue::whenWritten([](bool ok) {
+        std::lock_guard<std::mutex> lock(journalLock);
+
+        if (!ok) {
+            std::cout << "[WARN] Journal: a full save failed, keeping " << oldPath() << " until the next start" << std::endl;
+            return;
+        }
+
+        remove(oldPath().c_str());
+        checkpointPending = false;
+    });
+}
+
+void Journal::tick(CNServer* serv, time_t currTime) {
+    for (auto& pair : PlayerManager::players)
+        record(pair.second);
+}
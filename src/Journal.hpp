@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CNProtocol.hpp"
+#include "Player.hpp"
+
+#include <cstdint>
+
+/*
+ * Write-ahead journal of player state between full saves.
+ *
+ * Every journalinterval milliseconds, anyone whose PlayerSnapshot changed
+ * since their last record gets a new one appended, and so does every save
+ * handed to SaveQueue. The journal is therefore never behind the database,
+ * and a crash loses at most one interval instead of a whole dbsaveinterval.
+ *
+ * Each full save rotates the journal. The old file is deleted once the save
+ * queue has committed everything that was queued before the rotation. On
+ * startup, init() replays the newest record of each player left behind by a
+ * crash and then starts over with an empty journal.
+ */
+namespace Journal {
+    // replays what a previous run left behind; call after Database::open() and before SaveQueue::init()
+    void init();
+    // call after SaveQueue::shutdown(); the journal goes away unless a save failed along the way
+    void close();
+
+    void record(const Player* plr);
+    void forget(int32_t playerId);
+    // called after a full save has been queued
+    void checkpoint();
+
+    void tick(CNServer* serv, time_t currTime);
+}
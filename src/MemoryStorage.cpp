@@ -0,0 +1,639 @@
+#include "MemoryStorage.hpp"
+#include "settings.hpp"
+
+#include "contrib/bcrypt/BCrypt.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+
+// names are COLLATE NOCASE in the schema
+static bool sameName(const std::string& a, const std::string& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower((unsigned char)x) == std::tolower((unsigned char)y);
+    });
+}
+
+static void eraseValue(std::vector<int>& list, int value) {
+    list.erase(std::remove(list.begin(), list.end(), value), list.end());
+}
+
+void MemoryStorage::open() {
+    std::cout << "[INFO] Database in operation: in memory, nothing will be kept after shutdown" << std::endl;
+}
+
+void MemoryStorage::close() {
+    std::lock_guard<std::mutex> lk(lock);
+
+    accounts.clear();
+    logins.clear();
+    characters.clear();
+    buddies.clear();
+    blocks.clear();
+    mail.clear();
+    races.clear();
+}
+
+MemoryStorage::Character* MemoryStorage::findCharacter(int playerId, int accountId) {
+    auto it = characters.find(playerId);
+    if (it == characters.end() || (accountId != 0 && it->second.saved.accountId != accountId))
+        return nullptr;
+    return &it->second;
+}
+
+// what ON DELETE CASCADE takes with a character
+void MemoryStorage::forgetPlayer(int playerId) {
+    for (int other : buddies[playerId])
+        eraseValue(buddies[other], playerId);
+    buddies.erase(playerId);
+
+    blocks.erase(playerId);
+    for (auto& pair : blocks)
+        eraseValue(pair.second, playerId);
+
+    mail.erase(playerId);
+
+    for (auto& pair : races) {
+        std::vector<RaceRanking>& results = pair.second;
+        results.erase(std::remove_if(results.begin(), results.end(), [playerId](const RaceRanking& ranking) {
+            return ranking.PlayerID == playerId;
+        }), results.end());
+    }
+}
+
+// accounts
+void MemoryStorage::findAccount(Account* account, std::string login) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    auto it = accounts.find(login);
+    if (it == accounts.end())
+        return;
+
+    account->AccountID = it->second.id;
+    account->Password = it->second.password;
+    account->Selected = it->second.selected;
+    account->BannedUntil = it->second.bannedUntil;
+    account->BanReason = it->second.banReason;
+}
+
+int MemoryStorage::addAccount(std::string login, std::string password) {
+    // hashing is slow on purpose; don't hold everyone else up for it
+    std::string hashedPassword = BCrypt::generateHash(password);
+
+    std::lock_guard<std::mutex> lk(lock);
+
+    if (accounts.find(login) != accounts.end()) {
+        std::cout << "[WARN] Database: failed to add new account" << std::endl;
+        return 0;
+    }
+
+    int id = nextAccountId++;
+    accounts[login] = {id, login, hashedPassword, settings::ACCLEVEL, 1, 0, ""};
+    logins[id] = login;
+    return id;
+}
+
+void MemoryStorage::banAccount(int accountId, int days) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    auto it = logins.find(accountId);
+    if (it != logins.end())
+        accounts[it->second].bannedUntil = getTimestamp() + days * 86400;
+}
+
+void MemoryStorage::updateSelected(int accountId, int slot) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    if (slot < 1 || slot > 4) {
+        std::cout << "[WARN] Invalid slot number passed to updateSelected()! " << std::endl;
+        return;
+    }
+
+    auto it = logins.find(accountId);
+    if (it != logins.end())
+        accounts[it->second].selected = slot;
+}
+
+// characters
+bool MemoryStorage::validateCharacter(int characterID, int userID) {
+    std::lock_guard<std::mutex> lk(lock);
+    return findCharacter(characterID, userID) != nullptr;
+}
+
+bool MemoryStorage::isNameFree(std::string firstName, std::string lastName) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    for (auto& pair : characters)
+        if (sameName(pair.second.firstName, firstName) && sameName(pair.second.lastName, lastName))
+            return false;
+    return true;
+}
+
+bool MemoryStorage::isSlotFree(int accountId, int slotNum) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    if (slotNum < 1 || slotNum > 4) {
+        std::cout << "[WARN] Invalid slot number passed to isSlotFree()! " << slotNum << std::endl;
+        return false;
+    }
+
+    for (auto& pair : characters)
+        if (pair.second.saved.accountId == accountId && pair.second.saved.slot == slotNum)
+            return false;
+    return true;
+}
+
+int MemoryStorage::createCharacter(sP_CL2LS_REQ_SAVE_CHAR_NAME* save, int AccountID) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    std::string firstName = U16toU8(save->szFirstName);
+    std::string lastName = U16toU8(save->szLastName);
+
+    // the constraints on Players
+    if (logins.find(AccountID) == logins.end())
+        return 0;
+    for (auto& pair : characters) {
+        const Player& other = pair.second.saved;
+        if ((other.accountId == AccountID && other.slot == save->iSlotNum)
+            || (sameName(pair.second.firstName, firstName) && sameName(pair.second.lastName, lastName)))
+            return 0;
+    }
+
+    int playerId = nextPlayerId++;
+    Character& character = characters[playerId];
+    character.firstName = firstName;
+    character.lastName = lastName;
+
+    // column defaults from tables.sql
+    Player& plr = character.saved;
+    plr.iID = playerId;
+    plr.accountId = AccountID;
+    plr.slot = save->iSlotNum;
+    plr.level = 1;
+    plr.mentor = 5;
+    plr.x = settings::SPAWN_X;
+    plr.y = settings::SPAWN_Y;
+    plr.z = settings::SPAWN_Z;
+    plr.angle = settings::SPAWN_ANGLE;
+    plr.HP = PC_MAXHEALTH(1);
+
+    plr.PCStyle.iPC_UID = playerId;
+    memcpy(plr.PCStyle.szFirstName, save->szFirstName, sizeof(plr.PCStyle.szFirstName));
+    memcpy(plr.PCStyle.szLastName, save->szLastName, sizeof(plr.PCStyle.szLastName));
+    // if FNCode isn't 0, it's a wheel name
+    plr.PCStyle.iNameCheck = (settings::APPROVEALLNAMES || save->iFNCode) ? 1 : 0;
+    plr.PCStyle.iEyeColor = 1;
+    plr.PCStyle.iFaceStyle = 1;
+    plr.PCStyle.iGender = 1;
+    plr.PCStyle.iHairColor = 1;
+    plr.PCStyle.iHairStyle = 1;
+    plr.PCStyle.iSkinColor = 1;
+
+    return playerId;
+}
+
+bool MemoryStorage::finishCharacter(sP_CL2LS_REQ_CHAR_CREATE* character, int accountId) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    Character* target = findCharacter(character->PCStyle.iPC_UID, accountId);
+    if (target == nullptr || target->saved.PCStyle2.iAppearanceFlag != 0)
+        return false;
+
+    Player& plr = target->saved;
+    plr.PCStyle2.iAppearanceFlag = 1;
+    plr.PCStyle.iBody = character->PCStyle.iBody;
+    plr.PCStyle.iEyeColor = character->PCStyle.iEyeColor;
+    plr.PCStyle.iFaceStyle = character->PCStyle.iFaceStyle;
+    plr.PCStyle.iGender = character->PCStyle.iGender;
+    plr.PCStyle.iHairColor = character->PCStyle.iHairColor;
+    plr.PCStyle.iHairStyle = character->PCStyle.iHairStyle;
+    plr.PCStyle.iHeight = character->PCStyle.iHeight;
+    plr.PCStyle.iSkinColor = character->PCStyle.iSkinColor;
+
+    int items[3] = { character->sOn_Item.iEquipUBID, character->sOn_Item.iEquipLBID, character->sOn_Item.iEquipFootID };
+    for (int i = 0; i < 3; i++) {
+        sItemBase& item = plr.cold->Equip[i+1];
+        item.iType = i+1;
+        item.iID = items[i];
+        item.iOpt = 1;
+    }
+
+    return true;
+}
+
+bool MemoryStorage::finishTutorial(int playerID, int accountID) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    Character* target = findCharacter(playerID, accountID);
+    if (target == nullptr || target->saved.PCStyle2.iTutorialFlag != 0)
+        return false;
+
+    Player& plr = target->saved;
+    plr.PCStyle2.iTutorialFlag = 1;
+    memset(plr.cold->aQuestFlag, 0, sizeof(plr.cold->aQuestFlag));
+
+#ifndef ACADEMY
+    // save missions nr 1 & 2; equip Buttercup
+    plr.cold->aQuestFlag[0] = 3;
+    plr.equippedNanos[0] = 1;
+
+    // Lightning Gun
+    plr.cold->Equip[0] = { 0, 328, 1, 0 };
+
+    // Nano Buttercup
+    plr.Nanos[1] = { 1, 1, 150 };
+#else
+    // no, none of that
+    plr.equippedNanos[0] = 0;
+#endif
+
+    return true;
+}
+
+int MemoryStorage::deleteCharacter(int characterID, int userID) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    Character* target = findCharacter(characterID, userID);
+    if (target == nullptr)
+        return 0;
+
+    int slot = target->saved.slot;
+    characters.erase(characterID);
+    forgetPlayer(characterID);
+    return slot;
+}
+
+void MemoryStorage::getCharInfo(std::vector <sP_LS2CL_REP_CHAR_INFO>* result, int userID) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    for (auto& pair : characters) {
+        const Player& plr = pair.second.saved;
+        if (plr.accountId != userID)
+            continue;
+
+        sP_LS2CL_REP_CHAR_INFO toAdd = {};
+        toAdd.iSlot = plr.slot;
+        toAdd.iLevel = plr.level;
+        toAdd.sPC_Style = plr.PCStyle;
+        toAdd.sPC_Style2 = plr.PCStyle2;
+        toAdd.iX = plr.x;
+        toAdd.iY = plr.y;
+        toAdd.iZ = plr.z;
+        memcpy(toAdd.aEquip, plr.cold->Equip, sizeof(toAdd.aEquip));
+
+        result->push_back(toAdd);
+    }
+}
+
+void MemoryStorage::evaluateCustomName(int characterID, CustomName decision) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    Character* target = findCharacter(characterID);
+    if (target != nullptr)
+        target->saved.PCStyle.iNameCheck = int(decision);
+}
+
+bool MemoryStorage::changeName(sP_CL2LS_REQ_CHANGE_CHAR_NAME* save, int accountId) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    Character* target = findCharacter(save->iPCUID, accountId);
+    if (target == nullptr)
+        return true; // an UPDATE that matched nothing still succeeded
+
+    std::string firstName = U16toU8(save->szFirstName);
+    std::string lastName = U16toU8(save->szLastName);
+    for (auto& pair : characters)
+        if (&pair.second != target && sameName(pair.second.firstName, firstName) && sameName(pair.second.lastName, lastName))
+            return false;
+
+    target->firstName = firstName;
+    target->lastName = lastName;
+    memcpy(target->saved.PCStyle.szFirstName, save->szFirstName, sizeof(target->saved.PCStyle.szFirstName));
+    memcpy(target->saved.PCStyle.szLastName, save->szLastName, sizeof(target->saved.PCStyle.szLastName));
+    // if FNCode isn't 0, it's a wheel name
+    target->saved.PCStyle.iNameCheck = (settings::APPROVEALLNAMES || save->iFNCode) ? 1 : 0;
+    return true;
+}
+
+// players
+void MemoryStorage::getPlayer(Player* plr, int id) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    Character* character = findCharacter(id);
+    if (character == nullptr) {
+        std::cout << "[WARN] Database: Failed to load character [" << id << "]: no such character" << std::endl;
+        return;
+    }
+
+    *plr = character->saved;
+    plr->accountLevel = accounts[logins[plr->accountId]].level;
+
+    Database::removeExpiredVehicles(plr);
+
+    // buddies, then blocked players
+    int i = 0;
+    for (int buddy : buddies[id]) {
+        if (i >= 50)
+            break;
+        plr->cold->buddyIDs[i] = buddy;
+        plr->cold->isBuddyBlocked[i] = false;
+        i++;
+    }
+    for (int blocked : blocks[id]) {
+        if (i >= 50)
+            break;
+        plr->cold->buddyIDs[i] = blocked;
+        plr->cold->isBuddyBlocked[i] = true;
+        i++;
+    }
+}
+
+std::vector<Database::PlayerSummary> MemoryStorage::getPlayerSummaries(const std::vector<int>& ids) {
+    std::lock_guard<std::mutex> lk(lock);
+    std::vector<PlayerSummary> result;
+
+    for (int id : ids) {
+        Character* character = findCharacter(id);
+        if (character != nullptr)
+            result.push_back({id, character->saved.level, character->saved.PCStyle, character->saved.PCStyle2});
+    }
+
+    return result;
+}
+
+// copies what savePlayer() writes to the database; the caller holds the lock
+bool MemoryStorage::store(const Player* player) {
+    Character* character = findCharacter(player->iID);
+    if (character == nullptr) {
+        std::cout << "[WARN] Database: no character " << player->iID << " to save" << std::endl;
+        return false;
+    }
+
+    Player& saved = character->saved;
+
+    // instances and monkeys put them back where they came from
+    if (player->instanceID == 0 && !player->onMonkey) {
+        saved.x = player->x;
+        saved.y = player->y;
+        saved.z = player->z;
+        saved.angle = player->angle;
+    } else {
+        saved.x = player->lastX;
+        saved.y = player->lastY;
+        saved.z = player->lastZ;
+        saved.angle = player->lastAngle;
+    }
+
+    saved.level = player->level;
+    memcpy(saved.equippedNanos, player->equippedNanos, sizeof(saved.equippedNanos));
+    saved.HP = player->HP;
+    saved.fusionmatter = player->fusionmatter;
+    saved.money = player->money;
+    memcpy(saved.cold->aQuestFlag, player->cold->aQuestFlag, sizeof(saved.cold->aQuestFlag));
+    saved.batteryW = player->batteryW;
+    saved.batteryN = player->batteryN;
+    saved.iWarpLocationFlag = player->iWarpLocationFlag;
+    memcpy(saved.aSkywayLocationFlag, player->aSkywayLocationFlag, sizeof(saved.aSkywayLocationFlag));
+    saved.CurrentMissionID = player->CurrentMissionID;
+    saved.PCStyle2.iPayzoneFlag = player->PCStyle2.iPayzoneFlag;
+    memcpy(saved.cold->iFirstUseFlag, player->cold->iFirstUseFlag, sizeof(saved.cold->iFirstUseFlag));
+    saved.mentor = player->mentor;
+
+    // empty slots have no rows, and quest items only keep their ID and Opt
+    memcpy(saved.cold->Equip, player->cold->Equip, sizeof(saved.cold->Equip));
+    memcpy(saved.cold->Inven, player->cold->Inven, sizeof(saved.cold->Inven));
+    memcpy(saved.cold->Bank, player->cold->Bank, sizeof(saved.cold->Bank));
+    for (int i = 0; i < AEQUIP_COUNT + AINVEN_COUNT + ABANK_COUNT; i++) {
+        sItemBase& item = i < AEQUIP_COUNT ? saved.cold->Equip[i]
+            : i < AEQUIP_COUNT + AINVEN_COUNT ? saved.cold->Inven[i - AEQUIP_COUNT]
+            : saved.cold->Bank[i - AEQUIP_COUNT - AINVEN_COUNT];
+        if (item.iID == 0)
+            item = {};
+    }
+    for (int i = 0; i < AQINVEN_COUNT; i++) {
+        const sItemBase& item = player->cold->QInven[i];
+        saved.cold->QInven[i] = item.iID != 0 ? sItemBase{ 8, item.iID, item.iOpt, 0 } : sItemBase{};
+    }
+
+    for (int i = 0; i < NANO_COUNT; i++)
+        saved.Nanos[i] = player->Nanos[i].iID != 0 ? player->Nanos[i] : sNano{};
+
+    // running quests come back packed at the front, in order
+    memset(saved.tasks, 0, sizeof(saved.tasks));
+    memset(saved.RemainingNPCCount, 0, sizeof(saved.RemainingNPCCount));
+    int n = 0;
+    for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
+        if (player->tasks[i] == 0)
+            continue;
+        saved.tasks[n] = player->tasks[i];
+        memcpy(saved.RemainingNPCCount[n], player->RemainingNPCCount[i], sizeof(saved.RemainingNPCCount[n]));
+        n++;
+    }
+
+    return true;
+}
+
+void MemoryStorage::updatePlayer(const Player* player) {
+    std::lock_guard<std::mutex> lk(lock);
+    store(player);
+}
+
+void MemoryStorage::updatePlayers(std::vector<PlayerSave>& saves) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    // there's nothing to diff against on disk, so previous doesn't matter; each player is one record
+    for (PlayerSave& save : saves) {
+        save.ok = store(save.player);
+        save.rows = save.ok ? 1 : 0;
+    }
+}
+
+// buddies
+int MemoryStorage::getNumBuddies(Player* player) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    int result = buddies[player->iID].size() + blocks[player->iID].size();
+    return result > 50 ? 50 : result;
+}
+
+void MemoryStorage::addBuddyship(int playerA, int playerB) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    if (findCharacter(playerA) == nullptr || findCharacter(playerB) == nullptr) {
+        std::cout << "[WARN] Database: failed to add buddyship: no such character" << std::endl;
+        return;
+    }
+
+    buddies[playerA].push_back(playerB);
+    buddies[playerB].push_back(playerA);
+}
+
+void MemoryStorage::removeBuddyship(int playerA, int playerB) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    eraseValue(buddies[playerA], playerB);
+    eraseValue(buddies[playerB], playerA);
+}
+
+// blocking
+void MemoryStorage::addBlock(int playerId, int blockedPlayerId) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    if (findCharacter(playerId) == nullptr || findCharacter(blockedPlayerId) == nullptr) {
+        std::cout << "[WARN] Database: failed to block player: no such character" << std::endl;
+        return;
+    }
+
+    blocks[playerId].push_back(blockedPlayerId);
+}
+
+void MemoryStorage::removeBlock(int playerId, int blockedPlayerId) {
+    std::lock_guard<std::mutex> lk(lock);
+    eraseValue(blocks[playerId], blockedPlayerId);
+}
+
+// email
+int MemoryStorage::getUnreadEmailCount(int playerID) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    int ret = 0;
+    for (auto& pair : mail[playerID])
+        if (pair.second.data.ReadFlag == 0)
+            ret++;
+    return ret;
+}
+
+std::vector<Database::EmailData> MemoryStorage::getEmails(int playerID, int before, int count) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    std::vector<EmailData> emails;
+    std::map<int, Mail>& inbox = mail[playerID];
+
+    // newest first, starting below before
+    auto it = std::map<int, Mail>::reverse_iterator(inbox.lower_bound(before));
+    for (; it != inbox.rend() && (count < 0 || (int)emails.size() < count); it++) {
+        emails.push_back(it->second.data);
+        emails.back().MsgBody.clear();
+    }
+
+    return emails;
+}
+
+Database::EmailData MemoryStorage::getEmail(int playerID, int index) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    std::map<int, Mail>& inbox = mail[playerID];
+    auto it = inbox.find(index);
+    if (it == inbox.end()) {
+        std::cout << "[WARN] Database: Email not found!" << std::endl;
+        return {};
+    }
+
+    return it->second.data;
+}
+
+sItemBase* MemoryStorage::getEmailAttachments(int playerID, int index) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    sItemBase* items = new sItemBase[4];
+    for (int i = 0; i < 4; i++)
+        items[i] = { 0, 0, 0, 0 };
+
+    std::map<int, Mail>& inbox = mail[playerID];
+    auto it = inbox.find(index);
+    if (it == inbox.end())
+        return items;
+
+    for (auto& pair : it->second.items)
+        items[pair.first - 1] = pair.second;
+    return items;
+}
+
+void MemoryStorage::updateEmailContent(EmailData* data) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    std::map<int, Mail>& inbox = mail[data->PlayerId];
+    auto it = inbox.find(data->MsgIndex);
+    if (it != inbox.end())
+        it->second.data = *data;
+}
+
+void MemoryStorage::deleteEmailAttachments(int playerID, int index, int slot) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    std::map<int, Mail>& inbox = mail[playerID];
+    auto it = inbox.find(index);
+    if (it == inbox.end())
+        return;
+
+    if (slot == -1)
+        it->second.items.clear();
+    else
+        it->second.items.erase(slot);
+}
+
+void MemoryStorage::deleteEmails(int playerID, int64_t* indices) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    std::map<int, Mail>& inbox = mail[playerID];
+    for (int i = 0; i < 5; i++)
+        inbox.erase(indices[i]);
+}
+
+int MemoryStorage::getNextEmailIndex(int playerID) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    std::map<int, Mail>& inbox = mail[playerID];
+    int index = inbox.empty() ? 0 : inbox.rbegin()->first;
+    return (index > 0 ? index + 1 : 1);
+}
+
+bool MemoryStorage::sendEmail(EmailData* data, std::vector<sItemBase> attachments) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    std::map<int, Mail>& inbox = mail[data->PlayerId];
+    if (findCharacter(data->PlayerId) == nullptr || inbox.count(data->MsgIndex) != 0 || attachments.size() > 4) {
+        std::cout << "[WARN] Database: Failed to send email" << std::endl;
+        return false;
+    }
+
+    Mail& message = inbox[data->MsgIndex];
+    message.data = *data;
+    int slot = 1;
+    for (sItemBase item : attachments)
+        message.items[slot++] = item;
+    return true;
+}
+
+// racing
+std::vector<Database::RaceRanking> MemoryStorage::getRaceBests() {
+    std::lock_guard<std::mutex> lk(lock);
+
+    std::vector<RaceRanking> bests;
+    for (auto& ep : races) {
+        std::unordered_map<int, size_t> seen; // PlayerID -> index in bests
+        for (const RaceRanking& result : ep.second) {
+            auto it = seen.find(result.PlayerID);
+            if (it == seen.end()) {
+                seen[result.PlayerID] = bests.size();
+                bests.push_back(result);
+            } else if (result.Score > bests[it->second].Score) {
+                bests[it->second] = result;
+            }
+        }
+    }
+
+    return bests;
+}
+
+void MemoryStorage::postRaceRanking(RaceRanking ranking) {
+    std::lock_guard<std::mutex> lk(lock);
+
+    if (findCharacter(ranking.PlayerID) == nullptr) {
+        std::cout << "[WARN] Database: Failed to post race result" << std::endl;
+        return;
+    }
+
+    races[ranking.EPID].push_back(ranking);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Storage.hpp"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.mutex.h"
+#else
+    #include <mutex>
+#endif
+
+/*
+ * Everything in RAM behind one lock, gone on shutdown.
+ *
+ * It keeps what the SQLite schema keeps and answers the same way, so the
+ * server can't tell the difference; only the disk is missing. That's the
+ * point: a load test against it measures game logic, not I/O.
+ */
+class MemoryStorage : public Storage {
+public:
+    const char* name() const override { return "memory"; }
+    void open() override;
+    void close() override;
+
+    void findAccount(Account* account, std::string login) override;
+    int addAccount(std::string login, std::string password) override;
+    void banAccount(int accountId, int days) override;
+    void updateSelected(int accountId, int slot) override;
+
+    bool validateCharacter(int characterID, int userID) override;
+    bool isNameFree(std::string firstName, std::string lastName) override;
+    bool isSlotFree(int accountId, int slotNum) override;
+    int createCharacter(sP_CL2LS_REQ_SAVE_CHAR_NAME* save, int AccountID) override;
+    bool finishCharacter(sP_CL2LS_REQ_CHAR_CREATE* character, int accountId) override;
+    bool finishTutorial(int playerID, int accountID) override;
+    int deleteCharacter(int characterID, int userID) override;
+    void getCharInfo(std::vector <sP_LS2CL_REP_CHAR_INFO>* result, int userID) override;
+    void evaluateCustomName(int characterID, CustomName decision) override;
+    bool changeName(sP_CL2LS_REQ_CHANGE_CHAR_NAME* save, int accountId) override;
+
+    void getPlayer(Player* plr, int id) override;
+    std::vector<PlayerSummary> getPlayerSummaries(const std::vector<int>& ids) override;
+    void updatePlayer(const Player* player) override;
+    void updatePlayers(std::vector<PlayerSave>& saves) override;
+
+    int getNumBuddies(Player* player) override;
+    void addBuddyship(int playerA, int playerB) override;
+    void removeBuddyship(int playerA, int playerB) override;
+    void addBlock(int playerId, int blockedPlayerId) override;
+    void removeBlock(int playerId, int blockedPlayerId) override;
+
+    int getUnreadEmailCount(int playerID) override;
+    std::vector<EmailData> getEmails(int playerID, int before, int count) override;
+    EmailData getEmail(int playerID, int index) override;
+    sItemBase* getEmailAttachments(int playerID, int index) override;
+    void updateEmailContent(EmailData* data) override;
+    void deleteEmailAttachments(int playerID, int index, int slot) override;
+    void deleteEmails(int playerID, int64_t* indices) override;
+    int getNextEmailIndex(int playerID) override;
+    bool sendEmail(EmailData* data, std::vector<sItemBase> attachments) override;
+
+    std::vector<RaceRanking> getRaceBests() override;
+    void postRaceRanking(RaceRanking ranking) override;
+
+private:
+    struct AccountRecord {
+        int id;
+        std::string login;
+        std::string password; // hashed, like in the table
+        int level;
+        int selected;
+        time_t bannedUntil;
+        std::string banReason;
+    };
+    struct Character {
+        std::string firstName, lastName;
+        Player saved; // the columns of Players, Appearances, Inventory, QuestItems, Nanos and RunningQuests
+    };
+    struct Mail {
+        EmailData data;
+        std::map<int, sItemBase> items; // by slot, 1 to 4
+    };
+
+    std::mutex lock;
+
+    std::unordered_map<std::string, AccountRecord> accounts;
+    std::unordered_map<int, std::string> logins; // account ID -> login
+    int nextAccountId = 1;
+
+    std::map<int, Character> characters; // ordered like PlayerID
+    int nextPlayerId = 1;
+
+    // both directions, in the order they were made; loading fills buddyIDs that way
+    std::unordered_map<int, std::vector<int>> buddies;
+    std::unordered_map<int, std::vector<int>> blocks;
+
+    std::unordered_map<int, std::map<int, Mail>> mail; // player -> MsgIndex -> message
+    std::unordered_map<int, std::vector<RaceRanking>> races; // by EPID
+
+    Character* findCharacter(int playerId, int accountId = 0);
+    void forgetPlayer(int playerId);
+    bool store(const Player* player);
+};
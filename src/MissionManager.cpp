@@ -7,9 +7,12 @@
 
 #include "string.h"
 
+#include <algorithm>
+
 std::map<int32_t, Reward*> MissionManager::Rewards;
 std::map<int32_t, TaskData*> MissionManager::Tasks;
-nlohmann::json MissionManager::AvatarGrowth[37];
+GrowthData MissionManager::AvatarGrowth[37];
+std::unordered_map<int32_t, std::vector<int32_t>> MissionManager::KillTasks;
 
 void MissionManager::init() {
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_PC_TASK_START, taskStart);
@@ -18,6 +21,65 @@ void MissionManager::init() {
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_PC_TASK_STOP, quitMission);
 }
 
+// copies up to n entries of a JSON int array, zero-filling whatever is missing
+static void loadArray(nlohmann::json& t, const char *key, int32_t *out, int n) {
+    auto it = t.find(key);
+    for (int i = 0; i < n; i++)
+        out[i] = (it != t.end() && it->is_array() && i < (int)it->size()) ? (int32_t)(*it)[i] : 0;
+}
+
+TaskData::TaskData(nlohmann::json& t) {
+    taskID = t.value("m_iHTaskID", 0);
+    missionID = t.value("m_iHMissionID", 0);
+    taskType = t.value("m_iHTaskType", 0);
+    terminatorNPCID = t.value("m_iHTerminatorNPCID", 0);
+    requireInstanceID = t.value("m_iRequireInstanceID", 0);
+    loadArray(t, "m_iHBarkerTextID", barkerTextID, 4);
+
+    stNanoID = t.value("m_iSTNanoID", 0);
+    stGrantTimer = t.value("m_iSTGrantTimer", 0);
+    stGrantWayPoint = t.value("m_iSTGrantWayPoint", 0);
+    loadArray(t, "m_iSTItemID", stItemID, 3);
+    loadArray(t, "m_iSTItemNumNeeded", stItemNumNeeded, 3);
+    loadArray(t, "m_iSTItemDropRate", stItemDropRate, 3);
+
+    suOutgoingTask = t.value("m_iSUOutgoingTask", 0);
+    loadArray(t, "m_iSUItem", suItem, 3);
+    loadArray(t, "m_iSUInstancename", suInstancename, 3);
+
+    loadArray(t, "m_iCSUEnemyID", csuEnemyID, 3);
+    loadArray(t, "m_iCSUNumToKill", csuNumToKill, 3);
+    loadArray(t, "m_iCSUItemID", csuItemID, 3);
+    loadArray(t, "m_iCSUItemNumNeeded", csuItemNumNeeded, 3);
+
+    fOutgoingTask = t.value("m_iFOutgoingTask", 0);
+}
+
+void MissionManager::loadTask(nlohmann::json& task) {
+    TaskData *td = new TaskData(task);
+    Tasks[td->taskID] = td;
+
+    // index the task under every mob type mobKilled() has to look at it for
+    for (int i = 0; i < 3; i++) {
+        int32_t mob = td->csuEnemyID[i];
+        if (mob == 0 || (td->csuNumToKill[i] == 0 && td->csuItemNumNeeded[i] == 0))
+            continue;
+
+        std::vector<int32_t>& list = KillTasks[mob];
+        if (list.empty() || list.back() != td->taskID)
+            list.push_back(td->taskID);
+    }
+}
+
+void MissionManager::loadAvatarGrowth(nlohmann::json& growth) {
+    for (int i = 0; i < 37; i++) {
+        AvatarGrowth[i].fmLimit = growth[i].value("m_iFMLimit", 0);
+        AvatarGrowth[i].reqBlobNanoCreate = growth[i].value("m_iReqBlob_NanoCreate", 0);
+        AvatarGrowth[i].reqBlobNanoTune = growth[i].value("m_iReqBlob_NanoTune", 0);
+        AvatarGrowth[i].nanoQuestTaskID = growth[i].value("m_iNanoQuestTaskID", 0);
+    }
+}
+
 bool MissionManager::startTask(Player* plr, int TaskID) {
     if (MissionManager::Tasks.find(TaskID) == MissionManager::Tasks.end()) {
         std::cout << "[WARN] Player submitted unknown task!?" << std::endl;
@@ -27,7 +89,7 @@ bool MissionManager::startTask(Player* plr, int TaskID) {
     TaskData& task = *MissionManager::Tasks[TaskID];
 
     // client freaks out if nano mission isn't sent first after relogging, so it's easiest to set it here
-    if (task["m_iSTNanoID"] != 0 && plr->tasks[0] != 0) {
+    if (task.stNanoID != 0 && plr->tasks[0] != 0) {
             // lets move task0 to different spot
             int moveToSlot = 1;
             for (; moveToSlot < ACTIVE_MISSION_COUNT; moveToSlot++)
@@ -47,7 +109,7 @@ bool MissionManager::startTask(Player* plr, int TaskID) {
         if (plr->tasks[i] == 0) {
             plr->tasks[i] = TaskID;
             for (int j = 0; j < 3; j++) {
-                plr->RemainingNPCCount[i][j] = (int)task["m_iCSUNumToKill"][j];
+                plr->RemainingNPCCount[i][j] = task.csuNumToKill[j];
             }
             break;
         }
@@ -79,15 +141,15 @@ void MissionManager::taskStart(CNSocket* sock, CNPacketData* data) {
 
     // Give player their delivery items at the start, or reset them to 0 at the start.
     for (int i = 0; i < 3; i++)
-        if (task["m_iSTItemID"][i] != 0)
-            dropQuestItem(sock, missionData->iTaskNum, task["m_iSTItemNumNeeded"][i], task["m_iSTItemID"][i], 0);
+        if (task.stItemID[i] != 0)
+            dropQuestItem(sock, missionData->iTaskNum, task.stItemNumNeeded[i], task.stItemID[i], 0);
     std::cout << "Mission requested task: " << missionData->iTaskNum << std::endl;
     response.iTaskNum = missionData->iTaskNum;
-    response.iRemainTime = task["m_iSTGrantTimer"];
+    response.iRemainTime = task.stGrantTimer;
     sock->sendPacket((void*)&response, P_FE2CL_REP_PC_TASK_START_SUCC, sizeof(sP_FE2CL_REP_PC_TASK_START_SUCC));
 
     // HACK: auto-succeed escort task
-    if (task["m_iHTaskType"] == 6) {
+    if (task.taskType == 6) {
         std::cout << "Skipping escort mission" << std::endl;
         INITSTRUCT(sP_FE2CL_REP_PC_TASK_END_SUCC, response);
 
@@ -107,7 +169,7 @@ void MissionManager::taskEnd(CNSocket* sock, CNPacketData* data) {
     // failed timed missions give an iNPC_ID of 0
     if (missionData->iNPC_ID == 0) {
         TaskData* task = MissionManager::Tasks[missionData->iTaskNum];
-        if (task->task["m_iSTGrantTimer"] > 0) { // its a timed mission
+        if (task->stGrantTimer > 0) { // its a timed mission
             Player* plr = PlayerManager::getPlayer(sock);
             /*
              * Enemy killing missions
@@ -115,7 +177,7 @@ void MissionManager::taskEnd(CNSocket* sock, CNPacketData* data) {
              * once we comb over mission logic more throughly
              */
             bool mobsAreKilled = false;
-            if (task->task["m_iHTaskType"] == 5) {
+            if (task->taskType == 5) {
                 mobsAreKilled = true;
                 for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
                     if (plr->tasks[i] == missionData->iTaskNum) {
@@ -131,7 +193,7 @@ void MissionManager::taskEnd(CNSocket* sock, CNPacketData* data) {
 
             if (!mobsAreKilled) {
                 
-                int failTaskID = task->task["m_iFOutgoingTask"];
+                int failTaskID = task->fOutgoingTask;
                 if (failTaskID != 0) {
                     MissionManager::quitTask(sock, missionData->iTaskNum, false);
                     
@@ -185,8 +247,8 @@ bool MissionManager::endTask(CNSocket *sock, int32_t taskNum, int choice) {
      */
 
     for (int i = 0; i < 3; i++)
-        if (task["m_iSUItem"][i] != 0)
-            dropQuestItem(sock, taskNum, task["m_iSUInstancename"][i], task["m_iSUItem"][i], 0);
+        if (task.suItem[i] != 0)
+            dropQuestItem(sock, taskNum, task.suInstancename[i], task.suItem[i], 0);
 
     // update player
     int i;
@@ -203,13 +265,13 @@ bool MissionManager::endTask(CNSocket *sock, int32_t taskNum, int choice) {
     }
 
     // if it's the last task
-    if (task["m_iSUOutgoingTask"] == 0) {
+    if (task.suOutgoingTask == 0) {
         // save completed mission on player
-        saveMission(plr, (int)(task["m_iHMissionID"])-1);
+        saveMission(plr, task.missionID-1);
 
         // if it's a nano mission, reward the nano.
-        if (task["m_iSTNanoID"] != 0)
-            NanoManager::addNano(sock, task["m_iSTNanoID"], 0, true);
+        if (task.stNanoID != 0)
+            NanoManager::addNano(sock, task.stNanoID, 0, true);
 
         // remove current mission
         plr->CurrentMissionID = 0;
@@ -266,7 +328,7 @@ void MissionManager::quitTask(CNSocket* sock, int32_t taskNum, bool manual) {
 
     // clean up quest items
     for (i = 0; i < 3; i++) {
-        if (task["m_iSUItem"][i] == 0 && task["m_iCSUItemID"][i] == 0)
+        if (task.suItem[i] == 0 && task.csuItemID[i] == 0)
             continue;
 
         /*
@@ -274,8 +336,8 @@ void MissionManager::quitTask(CNSocket* sock, int32_t taskNum, bool manual) {
          * slot later items will be placed in.
          */
         for (int j = 0; j < AQINVEN_COUNT; j++)
-            if (plr->QInven[j].iID == task["m_iSUItem"][i] || plr->QInven[j].iID == task["m_iCSUItemID"][i] || plr->QInven[j].iID == task["m_iSTItemID"][i])
-                memset(&plr->QInven[j], 0, sizeof(sItemBase));
+            if (plr->cold->QInven[j].iID == task.suItem[i] || plr->cold->QInven[j].iID == task.csuItemID[i] || plr->cold->QInven[j].iID == task.stItemID[i])
+                memset(&plr->cold->QInven[j], 0, sizeof(sItemBase));
     }
 
     if (!manual) {
@@ -295,12 +357,12 @@ int MissionManager::findQSlot(Player *plr, int id) {
 
     // two passes. we mustn't fail to find an existing stack.
     for (i = 0; i < AQINVEN_COUNT; i++)
-        if (plr->QInven[i].iID == id)
+        if (plr->cold->QInven[i].iID == id)
             return i;
 
     // no stack. start a new one.
     for (i = 0; i < AQINVEN_COUNT; i++)
-        if (plr->QInven[i].iOpt == 0)
+        if (plr->cold->QInven[i].iOpt == 0)
             return i;
 
     // not found
@@ -333,14 +395,14 @@ void MissionManager::dropQuestItem(CNSocket *sock, int task, int count, int id,
 
     // update player
     if (id != 0) {
-        plr->QInven[slot].iType = 8;
-        plr->QInven[slot].iID = id;
-        plr->QInven[slot].iOpt += count; // stacking
+        plr->cold->QInven[slot].iType = 8;
+        plr->cold->QInven[slot].iID = id;
+        plr->cold->QInven[slot].iOpt += count; // stacking
     }
 
     // fully destory deleted items, for good measure
-    if (plr->QInven[slot].iOpt <= 0)
-        memset(&plr->QInven[slot], 0, sizeof(sItemBase));
+    if (plr->cold->QInven[slot].iOpt <= 0)
+        memset(&plr->cold->QInven[slot], 0, sizeof(sItemBase));
 
     // preserve stats
     reward->m_iCandy = plr->money;
@@ -354,7 +416,7 @@ void MissionManager::dropQuestItem(CNSocket *sock, int task, int count, int id,
     reward->iTaskID = task;
     reward->iNPC_TypeID = mobid;
 
-    item->sItem = plr->QInven[slot];
+    item->sItem = plr->cold->QInven[slot];
     item->iSlotNum = slot;
     item->eIL = 2;
 
@@ -389,12 +451,12 @@ int MissionManager::giveMissionReward(CNSocket *sock, int task, int choice) {
 
             // delete any temp items we might have set
             for (int j = 0; j < i; j++) {
-                plr->Inven[slots[j]] = { 0, 0, 0, 0 }; // empty
+                plr->cold->Inven[slots[j]] = { 0, 0, 0, 0 }; // empty
             }
             return -1;
         }
         
-        plr->Inven[slots[i]] = { 999, 999, 999, 0 }; // temp item; overwritten later
+        plr->cold->Inven[slots[i]] = { 999, 999, 999, 0 }; // temp item; overwritten later
     }
 
     uint8_t respbuf[CN_PACKET_BUFFER_SIZE];
@@ -445,7 +507,7 @@ int MissionManager::giveMissionReward(CNSocket *sock, int task, int choice) {
         item[i].eIL = 1;
 
         // update player inventory, overwriting temporary item
-        plr->Inven[slots[i]] = item[i].sItem;
+        plr->cold->Inven[slots[i]] = item[i].sItem;
     }
 
     sock->sendPacket((void*)respbuf, P_FE2CL_REP_REWARD_ITEM, resplen);
@@ -459,7 +521,7 @@ void MissionManager::updateFusionMatter(CNSocket* sock, int fusion) {
     plr->fusionmatter += fusion;
 
     // there's a much lower FM cap in the Future
-    int fmCap = AvatarGrowth[plr->level]["m_iFMLimit"];
+    int fmCap = AvatarGrowth[plr->level].fmLimit;
     if (plr->fusionmatter > fmCap)
         plr->fusionmatter = fmCap;
     else if (plr->fusionmatter < 0) // if somehow lowered too far
@@ -474,29 +536,32 @@ void MissionManager::updateFusionMatter(CNSocket* sock, int fusion) {
         return;
 
     // check if it is enough for the nano mission
-    int fmNano = AvatarGrowth[plr->level]["m_iReqBlob_NanoCreate"];
+    int fmNano = AvatarGrowth[plr->level].reqBlobNanoCreate;
     if (plr->fusionmatter < fmNano)
         return;
 
 #ifndef ACADEMY
     // check if the nano task is already started
     for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
+        if (plr->tasks[i] == 0)
+            continue;
+
         TaskData& task = *Tasks[plr->tasks[i]];
-        if (task["m_iSTNanoID"] != 0)
+        if (task.stNanoID != 0)
             return; // nano mission was already started!
     }
 
     // start the nano mission
-    startTask(plr, AvatarGrowth[plr->level]["m_iNanoQuestTaskID"]);
+    startTask(plr, AvatarGrowth[plr->level].nanoQuestTaskID);
 
     INITSTRUCT(sP_FE2CL_REP_PC_TASK_START_SUCC, response);
-    response.iTaskNum = AvatarGrowth[plr->level]["m_iNanoQuestTaskID"];
+    response.iTaskNum = AvatarGrowth[plr->level].nanoQuestTaskID;
     sock->sendPacket((void*)&response, P_FE2CL_REP_PC_TASK_START_SUCC, sizeof(sP_FE2CL_REP_PC_TASK_START_SUCC));
 #else
     if (plr->level >= 36)
         return;
 
-    plr->fusionmatter -= (int)MissionManager::AvatarGrowth[plr->level]["m_iReqBlob_NanoCreate"];
+    plr->fusionmatter -= MissionManager::AvatarGrowth[plr->level].reqBlobNanoCreate;
     plr->level++;
 
     INITSTRUCT(sP_FE2CL_REP_PC_CHANGE_LEVEL_SUCC, response);
@@ -515,34 +580,40 @@ void MissionManager::updateFusionMatter(CNSocket* sock, int fusion) {
 }
 
 void MissionManager::mobKilled(CNSocket *sock, int mobid, int rolledQItem) {
+    // most mobs aren't part of any task
+    auto it = KillTasks.find(mobid);
+    if (it == KillTasks.end())
+        return;
+
+    std::vector<int32_t>& relevant = it->second;
     Player *plr = PlayerManager::getPlayer(sock);
 
     bool missionmob = false;
 
     for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
-        if (plr->tasks[i] == 0)
+        if (plr->tasks[i] == 0 || std::find(relevant.begin(), relevant.end(), plr->tasks[i]) == relevant.end())
             continue;
 
         // tasks[] should always have valid IDs
         TaskData& task = *Tasks[plr->tasks[i]];
 
         for (int j = 0; j < 3; j++) {
-            if (task["m_iCSUEnemyID"][j] != mobid)
+            if (task.csuEnemyID[j] != mobid)
                 continue;
 
             // acknowledge killing of mission mob...
-            if (task["m_iCSUNumToKill"][j] != 0) {
+            if (task.csuNumToKill[j] != 0) {
                 missionmob = true;
                 if (plr->RemainingNPCCount[i][j] > 0) {
                     plr->RemainingNPCCount[i][j]--;
                 }
             }
             // drop quest item
-            if (task["m_iCSUItemNumNeeded"][j] != 0 && !isQuestItemFull(sock, task["m_iCSUItemID"][j], task["m_iCSUItemNumNeeded"][j]) ) {
-                bool drop = rolledQItem % 100 < task["m_iSTItemDropRate"][j];
+            if (task.csuItemNumNeeded[j] != 0 && !isQuestItemFull(sock, task.csuItemID[j], task.csuItemNumNeeded[j]) ) {
+                bool drop = rolledQItem % 100 < task.stItemDropRate[j];
                 if (drop) {
                     // XXX: are CSUItemID and CSTItemID the same?
-                    dropQuestItem(sock, plr->tasks[i], 1, task["m_iCSUItemID"][j], mobid);
+                    dropQuestItem(sock, plr->tasks[i], 1, task.csuItemID[j], mobid);
                 } else {
                     // fail to drop (itemID == 0)
                     dropQuestItem(sock, plr->tasks[i], 1, 0, mobid);
@@ -572,7 +643,7 @@ void MissionManager::saveMission(Player* player, int missionId) {
     // Missions are stored in int64_t array
     int row = missionId / 64;
     int column = missionId % 64;
-    player->aQuestFlag[row] |= (1ULL << column);
+    player->cold->aQuestFlag[row] |= (1ULL << column);
 }
 
 bool MissionManager::isQuestItemFull(CNSocket* sock, int itemId, int itemCount) {
@@ -585,7 +656,7 @@ bool MissionManager::isQuestItemFull(CNSocket* sock, int itemId, int itemCount)
         return true;
     }
 
-    return (itemCount == plr->QInven[slot].iOpt);
+    return (itemCount == plr->cold->QInven[slot].iOpt);
 }
 
 void MissionManager::failInstancedMissions(CNSocket* sock) {
@@ -597,8 +668,8 @@ void MissionManager::failInstancedMissions(CNSocket* sock) {
             continue; // sanity check
 
         TaskData* task = MissionManager::Tasks[taskNum];
-        if (task->task["m_iRequireInstanceID"] != 0) { // mission is instanced
-            int failTaskID = task->task["m_iFOutgoingTask"];
+        if (task->requireInstanceID != 0) { // mission is instanced
+            int failTaskID = task->fOutgoingTask;
             if (failTaskID != 0) {
                 MissionManager::quitTask(sock, taskNum, false);
                 //plr->tasks[i] = failTaskID; // this causes the client to freak out and send a dupe task
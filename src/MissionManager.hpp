@@ -5,6 +5,9 @@
 
 #include "contrib/JSON.hpp"
 
+#include <unordered_map>
+#include <vector>
+
 struct Reward {
     int32_t id;
     int32_t itemTypes[4];
@@ -21,26 +24,61 @@ struct Reward {
     };
 };
 
+/*
+ * The parts of an xdt mission task the server actually uses, compiled at load.
+ * Field names follow the xdt keys they come from (m_iSTNanoID -> stNanoID).
+ */
 struct TaskData {
-    /*
-     * TODO: We'll probably want to keep only the data the server actually needs,
-     *       but for now RE/development is much easier if we have everything at
-     *       our fingertips.
-     */
-    nlohmann::json task;
+    int32_t taskID;
+    int32_t missionID;
+    int32_t taskType;
+    int32_t terminatorNPCID;
+    int32_t requireInstanceID;
+    int32_t barkerTextID[4];
+
+    // given on task start
+    int32_t stNanoID;
+    int32_t stGrantTimer;
+    int32_t stGrantWayPoint;
+    int32_t stItemID[3];
+    int32_t stItemNumNeeded[3];
+    int32_t stItemDropRate[3];
+
+    // handed out on success; suInstancename is the item count, not a name
+    int32_t suOutgoingTask;
+    int32_t suItem[3];
+    int32_t suInstancename[3];
+
+    // completion conditions
+    int32_t csuEnemyID[3];
+    int32_t csuNumToKill[3];
+    int32_t csuItemID[3];
+    int32_t csuItemNumNeeded[3];
 
-    TaskData(nlohmann::json t) : task(t) {}
+    int32_t fOutgoingTask;
 
-    // convenience
-    auto operator[](std::string s) { return task[s]; }
+    TaskData(nlohmann::json& t);
+};
+
+// per-level FM thresholds from m_pAvatarGrowData
+struct GrowthData {
+    int32_t fmLimit;
+    int32_t reqBlobNanoCreate;
+    int32_t reqBlobNanoTune;
+    int32_t nanoQuestTaskID;
 };
 
 namespace MissionManager {
     extern std::map<int32_t, Reward*> Rewards;
     extern std::map<int32_t, TaskData*> Tasks;
-    extern nlohmann::json AvatarGrowth[37];
+    extern GrowthData AvatarGrowth[37];
+    // mob type -> tasks that count kills of it or drop quest items from it
+    extern std::unordered_map<int32_t, std::vector<int32_t>> KillTasks;
     void init();
 
+    void loadTask(nlohmann::json& task);
+    void loadAvatarGrowth(nlohmann::json& growth);
+
     bool startTask(Player* plr, int TaskID);
     void taskStart(CNSocket* sock, CNPacketData* data);
     void taskEnd(CNSocket* sock, CNPacketData* data);
@@ -7,12 +7,18 @@
 #include "GroupManager.hpp"
 #include "TransportManager.hpp"
 #include "RacingManager.hpp"
+#include "WorkerPool.hpp"
+#include "Rand.hpp"
+#include "settings.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <functional>
 #include <limits.h>
 #include <assert.h>
 
-std::map<int32_t, Mob*> MobManager::Mobs;
+SlotMap<Mob*> MobManager::Mobs;
 std::queue<int32_t> MobManager::RemovalQueue;
 
 std::map<int32_t, MobDropChance> MobManager::MobDropChances;
@@ -21,6 +27,123 @@ std::map<int32_t, MobDrop> MobManager::MobDrops;
 std::map<int32_t, std::map<int8_t, Bullet>> MobManager::Bullets;
 
 bool MobManager::simulateMobs;
+MobStepStats MobManager::StepStats = {};
+
+/*
+ * Mobs waiting to be stepped, as (wake time, NPC ID) in a min-heap.
+ * Entries are never removed early: one whose time no longer matches its mob's
+ * wakeTime, or whose ID no longer resolves, is just skipped when it comes up.
+ *
+ * There's one heap per instance, so that each private instance can tick on
+ * its own (or be put off until the next tick).
+ */
+typedef std::pair<time_t, int32_t> MobWake;
+typedef std::priority_queue<MobWake, std::vector<MobWake>, std::greater<MobWake>> WakeQueue;
+static std::map<uint64_t, WakeQueue> wakeQueues;
+static uint64_t lastInstance = 0; // the last private instance to get its turn
+
+// aggro candidates per chunk, valid only for the tick at time
+struct AggroCache {
+    std::map<ChunkPos, AggroCandidates> chunks;
+    time_t time = 0;
+};
+static AggroCache shardAggroCache;
+
+/*
+ * One private instance's turn in a mob tick, run as a job on mobWorkers.
+ *
+ * An instance owns its mobs, its chunks and the players in them, so its tick
+ * works on those directly. Anything shared with the rest of the shard (the
+ * chunk map, NPC paths, the removal queue, buffs, kill rewards that can go to
+ * group members elsewhere, the log) is posted to the outbox instead, and the shard
+ * thread carries those out once every instance is done, in instance order.
+ * Warps and group/buddy chat are packet handlers, which only ever run on the
+ * shard thread between ticks, so they never see an instance mid-tick.
+ */
+struct InstanceTick {
+    uint64_t instance;
+    WakeQueue *queue;
+    uint64_t seed; // rolled on the shard thread, so decisions don't depend on which worker runs it
+    Xoshiro256 rng; // the tick's own damage and timing rolls, seeded from seed
+    AggroCache aggro;
+    std::vector<std::function<void()>> outbox;
+    size_t woken = 0;
+    bool deferred = false; // didn't start before the budget ran out
+};
+
+// the instance this thread is ticking, if any
+static thread_local InstanceTick *currentTick = nullptr;
+
+// spreads per-tick mob work over settings::MOBTHREADS threads
+static WorkerPool *mobWorkers = nullptr;
+
+static AggroCache& aggroCache() {
+    return currentTick != nullptr ? currentTick->aggro : shardAggroCache;
+}
+
+// runs fn right away on the shard thread; during an instance's tick, once the tick is over
+static void post(std::function<void()> fn) {
+    if (currentTick == nullptr) {
+        fn();
+        return;
+    }
+    currentTick->outbox.push_back(std::move(fn));
+}
+
+// log lines go through post() too, so workers don't print over the shard thread's output
+static void logLine(std::string line) {
+    post([line]() { std::cout << line << std::endl; });
+}
+
+// find() only, since instances tick on worker threads; unknown skills come back blank
+static const SkillData& skillData(int32_t skillID) {
+    static const SkillData none = {};
+    auto it = NanoManager::SkillTable.find(skillID);
+    return it == NanoManager::SkillTable.end() ? none : it->second;
+}
+
+// uniform in [0, bound), the same way Rand::next() does it
+static int roll(Xoshiro256& rng, int bound) {
+    return (int)(((rng.next() >> 32) * (uint64_t)bound) >> 32);
+}
+
+// Rand::next(), except that an instance's tick rolls from its own stream instead of the worker's
+static int tickRoll(Rand::Stream stream, int bound) {
+    if (currentTick == nullptr)
+        return Rand::next(stream, bound);
+    return roll(currentTick->rng, bound);
+}
+
+Mob::Mob(int x, int y, int z, int angle, uint64_t iID, int type, const MobTemplate *t, int32_t id)
+    : BaseNPC(x, y, z, angle, iID, type, id),
+      maxHealth(t->maxHealth),
+      sightRange(t->sightRange) {
+    state = MobState::ROAMING;
+
+    tmpl = t;
+
+    regenTime = tmpl->regenTime;
+    idleRange = tmpl->idleRange;
+    dropType = tmpl->dropType;
+    level = tmpl->level;
+
+    roamX = spawnX = appearanceData.iX;
+    roamY = spawnY = appearanceData.iY;
+    roamZ = spawnZ = appearanceData.iZ;
+
+    offsetX = 0;
+    offsetY = 0;
+
+    appearanceData.iConditionBitFlag = 0;
+
+    // NOTE: there appear to be discrepancies in the dump
+    appearanceData.iHP = maxHealth;
+
+    npcClass = NPC_MOB;
+
+    // have a first look at it on the next step; it settles its own schedule from there
+    MobManager::wakeMob(this);
+}
 
 void MobManager::init() {
     REGISTER_SHARD_TIMER(step, 200);
@@ -38,6 +161,11 @@ void MobManager::init() {
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_PC_ROCKET_STYLE_HIT, projectileHit);
 
     simulateMobs = settings::SIMULATEMOBS;
+
+    int threads = std::max(settings::MOBTHREADS, 1);
+    mobWorkers = new WorkerPool(threads);
+    if (threads > 1)
+        std::cout << "[INFO] Mob AI and private instances spread over " << threads << " threads" << std::endl;
 }
 
 void MobManager::pcAttackNpcs(CNSocket *sock, CNPacketData *data) {
@@ -88,8 +216,8 @@ void MobManager::pcAttackNpcs(CNSocket *sock, CNPacketData *data) {
         else
             damage.first = plr->pointDamage;
 
-        int difficulty = (int)mob->data["m_iNpcLevel"];
-        damage = getDamage(damage.first, (int)mob->data["m_iProtection"], true, (plr->batteryW > 6 + difficulty), NanoManager::nanoStyle(plr->activeNano), (int)mob->data["m_iNpcStyle"], difficulty);
+        int difficulty = mob->tmpl->level;
+        damage = getDamage(damage.first, mob->tmpl->protection, true, (plr->batteryW > 6 + difficulty), NanoManager::nanoStyle(plr->activeNano), mob->tmpl->npcStyle, difficulty);
         
         if (plr->batteryW >= 6 + difficulty)
             plr->batteryW -= 6 + difficulty;
@@ -128,7 +256,7 @@ void MobManager::npcAttackPc(Mob *mob, time_t currTime) {
     sP_FE2CL_NPC_ATTACK_PCs *pkt = (sP_FE2CL_NPC_ATTACK_PCs*)respbuf;
     sAttackResult *atk = (sAttackResult*)(respbuf + sizeof(sP_FE2CL_NPC_ATTACK_PCs));
 
-    auto damage = getDamage(450 + (int)mob->data["m_iPower"], plr->defense, false, false, -1, -1, 0);
+    auto damage = getDamage(450 + mob->tmpl->power, plr->defense, false, false, -1, -1, 0);
 
     if (!(plr->iSpecialState & CN_SPECIAL_STATE_FLAG__INVULNERABLE))
         plr->HP -= damage.first;
@@ -246,7 +374,7 @@ void MobManager::giveReward(CNSocket *sock, Mob* mob, int rolledBoosts, int roll
         item->eIL = 1; // Inventory Location. 1 means player inventory.
 
         // update player
-        plr->Inven[slot] = item->sItem;
+        plr->cold->Inven[slot] = item->sItem;
 
         sock->sendPacket((void*)respbuf, P_FE2CL_REP_REWARD_ITEM, resplen);
     }
@@ -278,7 +406,7 @@ void MobManager::getReward(sItemBase *reward, MobDrop* drop, MobDropChance* chan
 
 void MobManager::giveEventReward(CNSocket* sock, Player* player, int rolled) {
     // random drop chance
-    if (rand() % 100 > settings::EVENTCRATECHANCE)
+    if (Rand::next(Rand::LOOT, 100) > settings::EVENTCRATECHANCE)
         return;
 
     // no slot = no reward
@@ -327,7 +455,7 @@ void MobManager::giveEventReward(CNSocket* sock, Player* player, int rolled) {
     item->eIL = 1; // Inventory Location. 1 means player inventory.
 
     // update player
-    player->Inven[slot] = item->sItem;
+    player->cold->Inven[slot] = item->sItem;
     sock->sendPacket((void*)respbuf, P_FE2CL_REP_REWARD_ITEM, resplen);
 }
 
@@ -346,6 +474,7 @@ int MobManager::hitMob(CNSocket *sock, Mob *mob, int damage) {
         mob->state = MobState::COMBAT;
         mob->nextMovement = getTime();
         mob->nextAttack = 0;
+        wakeMob(mob);
 
         mob->roamX = mob->appearanceData.iX;
         mob->roamY = mob->appearanceData.iY;
@@ -381,33 +510,31 @@ void MobManager::killMob(CNSocket *sock, Mob *mob) {
     mob->skillStyle = -1;
     mob->unbuffTimes.clear();
     mob->killedTime = getTime(); // XXX: maybe introduce a shard-global time for each step?
+    wakeMob(mob);
 
     // check for the edge case where hitting the mob did not aggro it
     if (sock != nullptr) {
         Player* plr = PlayerManager::getPlayer(sock);
 
-        int rolledBoosts = rand();
-        int rolledPotions = rand();
-        int rolledCrate = rand();
-        int rolledCrateType = rand();
-        int rolledEvent = rand();
-        int rolledQItem = rand();
-
-        if (plr->groupCnt == 1 && plr->iIDGroup == plr->iID) {
+        // every drop table gets its roll up front, and the whole group shares them
+        int32_t rolls[6];
+        Rand::fill(Rand::LOOT, rolls, 6);
+        int rolledBoosts = rolls[0];
+        int rolledPotions = rolls[1];
+        int rolledCrate = rolls[2];
+        int rolledCrateType = rolls[3];
+        int rolledEvent = rolls[4];
+        int rolledQItem = rolls[5];
+
+        if (plr->group == nullptr) {
             giveReward(sock, mob, rolledBoosts, rolledPotions, rolledCrate, rolledCrateType, rolledEvent);
             MissionManager::mobKilled(sock, mob->appearanceData.iNPCType, rolledQItem);
         } else {
-            Player* otherPlayer = PlayerManager::getPlayerFromID(plr->iIDGroup);
-
-            if (otherPlayer == nullptr)
-                return;
+            Group* group = plr->group;
 
-            for (int i = 0; i < otherPlayer->groupCnt; i++) {
-                CNSocket* sockTo = PlayerManager::getSockFromID(otherPlayer->groupIDs[i]);
-                if (sockTo == nullptr)
-                    continue;
-
-                Player *otherPlr = PlayerManager::getPlayer(sockTo);
+            for (size_t i = 0; i < group->members.size(); i++) {
+                CNSocket* sockTo = group->socks[i];
+                Player *otherPlr = group->members[i];
 
                 // only contribute to group members' kills if they're close enough
                 int dist = std::hypot(plr->x - otherPlr->x + 1, plr->y - otherPlr->y + 1);
@@ -428,29 +555,24 @@ void MobManager::killMob(CNSocket *sock, Mob *mob) {
         if (event.trigger == ON_KILLED && event.npcType == mob->appearanceData.iNPCType)
             event.handler(sock, mob);
 
-    auto it = TransportManager::NPCQueues.find(mob->appearanceData.iNPC_ID);
-    if (it == TransportManager::NPCQueues.end() || it->second.empty())
+    auto it = TransportManager::NPCPaths.find(mob->appearanceData.iNPC_ID);
+    if (it == TransportManager::NPCPaths.end() || it->second.path->length == 0)
         return;
 
-    // rewind or empty the movement queue
+    // rewind or drop the path
     if (mob->staticPath) {
         /*
-         * This is inelegant, but we wind forward in the path until we find the point that
-         * corresponds with the Mob's spawn point.
+         * Static paths start at the Mob's spawn point.
          *
-         * IMPORTANT: The check in TableData::loadPaths() must pass or else this will loop forever.
+         * IMPORTANT: This relies on the check in TableData::loadPaths().
          */
-        auto& queue = it->second;
-        for (auto point = queue.front(); point.x != mob->spawnX || point.y != mob->spawnY; point = queue.front()) {
-            queue.pop();
-            queue.push(point);
-        }
+        it->second.tick = 0;
     } else {
-        TransportManager::NPCQueues.erase(mob->appearanceData.iNPC_ID);
+        TransportManager::NPCPaths.erase(mob->appearanceData.iNPC_ID);
     }
 }
 
-void MobManager::deadStep(Mob *mob, time_t currTime) {
+void MobManager::deadStep(Mob *mob, time_t currTime, MobPlan& plan) {
     // despawn the mob after a short delay
     if (mob->killedTime != 0 && !mob->despawned && currTime - mob->killedTime > 2000) {
         mob->despawned = true;
@@ -463,8 +585,9 @@ void MobManager::deadStep(Mob *mob, time_t currTime) {
 
         // if it was summoned, mark it for removal
         if (mob->summoned) {
-            std::cout << "[INFO] Queueing killed summoned mob for removal" << std::endl;
-            RemovalQueue.push(mob->appearanceData.iNPC_ID);
+            logLine("[INFO] Queueing killed summoned mob for removal");
+            int32_t id = mob->appearanceData.iNPC_ID;
+            post([id]() { RemovalQueue.push(id); });
             return;
         }
 
@@ -476,12 +599,12 @@ void MobManager::deadStep(Mob *mob, time_t currTime) {
 
     // to guide their groupmates, group leaders still need to move despite being dead
     if (mob->groupLeader == mob->appearanceData.iNPC_ID)
-        roamingStep(mob, currTime);
+        roamingStep(mob, currTime, plan);
 
     if (mob->killedTime != 0 && currTime - mob->killedTime < mob->regenTime * 100)
         return;
 
-    std::cout << "respawning mob " << mob->appearanceData.iNPC_ID << " with HP = " << mob->maxHealth << std::endl;
+    logLine("respawning mob " + std::to_string(mob->appearanceData.iNPC_ID) + " with HP = " + std::to_string(mob->maxHealth));
 
     mob->appearanceData.iHP = mob->maxHealth;
     mob->state = MobState::ROAMING;
@@ -494,7 +617,7 @@ void MobManager::deadStep(Mob *mob, time_t currTime) {
             mob->appearanceData.iY = leaderMob->appearanceData.iY + mob->offsetY;
             mob->appearanceData.iZ = leaderMob->appearanceData.iZ;
         } else {
-            std::cout << "[WARN] deadStep: mob cannot find it's leader!" << std::endl;
+            logLine("[WARN] deadStep: mob cannot find it's leader!");
         }
     }
 
@@ -506,7 +629,7 @@ void MobManager::deadStep(Mob *mob, time_t currTime) {
     NPCManager::sendToViewable(mob, &pkt, P_FE2CL_NPC_NEW, sizeof(sP_FE2CL_NPC_NEW));
 }
 
-void MobManager::combatStep(Mob *mob, time_t currTime) {
+void MobManager::combatStep(Mob *mob, time_t currTime, MobPlan& plan) {
     assert(mob->target != nullptr);
 
     // lose aggro if the player lost connection
@@ -520,9 +643,10 @@ void MobManager::combatStep(Mob *mob, time_t currTime) {
 
     Player *plr = PlayerManager::getPlayer(mob->target);
 
-    // lose aggro if the player became invulnerable or died
+    // lose aggro if the player became invulnerable, died or warped out
     if (plr->HP <= 0
-     || (plr->iSpecialState & CN_SPECIAL_STATE_FLAG__INVULNERABLE)) {
+     || (plr->iSpecialState & CN_SPECIAL_STATE_FLAG__INVULNERABLE)
+     || plr->instanceID != mob->instanceID) {
         mob->target = nullptr;
         mob->state = MobState::RETREAT;
         if (!aggroCheck(mob, currTime))
@@ -567,17 +691,17 @@ void MobManager::combatStep(Mob *mob, time_t currTime) {
     }
 
     int distance = hypot(plr->x - mob->appearanceData.iX, plr->y - mob->appearanceData.iY);
-    int mobRange = (int)mob->data["m_iAtkRange"] + (int)mob->data["m_iRadius"];
+    int mobRange = mob->tmpl->atkRange + mob->tmpl->radius;
 
     if (currTime >= mob->nextAttack) {
-        if (mob->skillStyle != -1 || distance <= mobRange || rand() % 20 == 0) // while not in attack range, 1 / 20 chance.
-            useAbilities(mob, currTime);
+        if (mob->skillStyle != -1 || distance <= mobRange || roll(plan.rng, 20) == 0) // while not in attack range, 1 / 20 chance.
+            useAbilities(mob, currTime, plan);
         if (mob->target == nullptr)
             return;
     }
 
     int distanceToTravel = INT_MAX;
-    int speed = mob->data["m_iRunSpeed"];
+    int speed = mob->tmpl->runSpeed;
     // movement logic: move when out of range but don't move while casting a skill
     if (distance > mobRange && mob->skillStyle == -1) {
         if (mob->nextMovement != 0 && currTime < mob->nextMovement)
@@ -602,7 +726,14 @@ void MobManager::combatStep(Mob *mob, time_t currTime) {
         if (distanceToTravel < speed*2/5 && currTime >= mob->nextAttack)
             mob->nextAttack = 0;
 
-        NPCManager::updateNPCPosition(mob->appearanceData.iNPC_ID, targ.first, targ.second, mob->appearanceData.iZ, mob->instanceID, mob->appearanceData.iAngle);
+        // crossing into another chunk touches the shared chunk map
+        int32_t id = mob->appearanceData.iNPC_ID;
+        int z = mob->appearanceData.iZ, angle = mob->appearanceData.iAngle;
+        uint64_t instance = mob->instanceID;
+        if (ChunkManager::chunkPosAt(targ.first, targ.second, instance) == mob->chunkPos)
+            NPCManager::updateNPCPosition(id, targ.first, targ.second, z, instance, angle);
+        else
+            post([id, targ, z, instance, angle]() { NPCManager::updateNPCPosition(id, targ.first, targ.second, z, instance, angle); });
 
         INITSTRUCT(sP_FE2CL_NPC_MOVE, pkt);
 
@@ -623,15 +754,15 @@ void MobManager::combatStep(Mob *mob, time_t currTime) {
      */
     if (distance <= mobRange || distanceToTravel < speed*2/5) {
         if (mob->nextAttack == 0 || currTime >= mob->nextAttack) {
-            mob->nextAttack = currTime + (int)mob->data["m_iDelayTime"] * 100;
+            mob->nextAttack = currTime + mob->tmpl->delayTime * 100;
             npcAttackPc(mob, currTime);
         }
     }
 
     // retreat if the player leaves combat range
-    int xyDistance = hypot(plr->x - mob->roamX, plr->y - mob->roamY);
-    distance = hypot(xyDistance, plr->z - mob->roamZ);
-    if (distance >= mob->data["m_iCombatRange"]) {
+    int64_t dx = plr->x - mob->roamX, dy = plr->y - mob->roamY, dz = plr->z - mob->roamZ;
+    int64_t combatRange = mob->tmpl->combatRange;
+    if (dx*dx + dy*dy + dz*dz >= combatRange*combatRange) {
         mob->target = nullptr;
         mob->state = MobState::RETREAT;
         clearDebuff(mob);
@@ -642,21 +773,16 @@ void MobManager::incNextMovement(Mob *mob, time_t currTime) {
     if (currTime == 0)
         currTime = getTime();
 
-    int delay = (int)mob->data["m_iDelayTime"] * 1000;
-    mob->nextMovement = currTime + delay/2 + rand() % (delay/2);
+    int delay = mob->tmpl->delayTime * 1000;
+    mob->nextMovement = currTime + delay/2 + tickRoll(Rand::AI, delay/2);
 }
 
-void MobManager::roamingStep(Mob *mob, time_t currTime) {
-    /*
-     * We reuse nextAttack to avoid scanning for players all the time, but to still
-     * do so more often than if we waited for nextMovement (which is way too slow).
-     * In the case of group leaders, this step will be called by dead mobs, so disable attack.
-     */
-    if (mob->state != MobState::DEAD && (mob->nextAttack == 0 || currTime >= mob->nextAttack)) {
-        mob->nextAttack = currTime + 500;
-        if (aggroCheck(mob, currTime))
-            return;
-    }
+/*
+ * Where a roaming mob (or a dead group leader) sets off to this tick, and the
+ * paths for it and its followers. Only reads, so it can run on any thread.
+ */
+void MobManager::planRoam(Mob *mob, time_t currTime, MobPlan& plan) {
+    plan.roamPlanned = true;
 
     // no random roaming if the mob already has a set path
     if (mob->staticPath)
@@ -672,11 +798,14 @@ void MobManager::roamingStep(Mob *mob, time_t currTime) {
      */
     if (mob->nextMovement != 0 && currTime < mob->nextMovement)
         return;
-    incNextMovement(mob, currTime);
+
+    // same as incNextMovement()
+    int delay = mob->tmpl->delayTime * 1000;
+    plan.nextMovement = currTime + delay/2 + roll(plan.rng, delay/2);
 
     int xStart = mob->spawnX - mob->idleRange/2;
     int yStart = mob->spawnY - mob->idleRange/2;
-    int speed = mob->data["m_iWalkSpeed"];
+    int speed = mob->tmpl->walkSpeed;
 
     // some mobs don't move (and we mustn't divide/modulus by zero)
     if (mob->idleRange == 0 || speed == 0)
@@ -686,8 +815,8 @@ void MobManager::roamingStep(Mob *mob, time_t currTime) {
     int minDistance = mob->idleRange / 2;
 
     // pick a random destination
-    farX = xStart + rand() % mob->idleRange;
-    farY = yStart + rand() % mob->idleRange;
+    farX = xStart + roll(plan.rng, mob->idleRange);
+    farY = yStart + roll(plan.rng, mob->idleRange);
 
     distance = std::abs(std::max(farX - mob->appearanceData.iX, farY - mob->appearanceData.iY));
     if (distance == 0)
@@ -705,13 +834,13 @@ void MobManager::roamingStep(Mob *mob, time_t currTime) {
     if (mob->appearanceData.iConditionBitFlag & CSB_BIT_DN_MOVE_SPEED)
         speed /= 2;
 
-    std::queue<WarpLocation> queue;
+    auto path = std::make_shared<TransportPath>();
     WarpLocation from = { mob->appearanceData.iX, mob->appearanceData.iY, mob->appearanceData.iZ };
     WarpLocation to = { farX, farY, mob->appearanceData.iZ };
 
-    // add a route to the queue; to be processed in TransportManager::stepNPCPathing()
-    TransportManager::lerp(&queue, from, to, speed);
-    TransportManager::NPCQueues[mob->appearanceData.iNPC_ID] = queue;
+    // set out along a one-leg path; to be processed in TransportManager::stepNPCPathing()
+    path->addSegment(from, to, speed);
+    plan.paths.push_back(std::make_pair(mob->appearanceData.iNPC_ID, path));
 
     if (mob->groupLeader != 0 && mob->groupLeader == mob->appearanceData.iNPC_ID) {
         // make followers follow this npc.
@@ -719,21 +848,44 @@ void MobManager::roamingStep(Mob *mob, time_t currTime) {
             if (mob->groupMember[i] == 0)
                 break;
 
-            if (Mobs.find(mob->groupMember[i]) == Mobs.end()) {
-                std::cout << "[WARN] roamingStep: leader can't find a group member!" << std::endl;
+            auto it = Mobs.find(mob->groupMember[i]);
+            if (it == Mobs.end()) {
+                plan.missingFollowers++;
                 continue;
             }
 
-            std::queue<WarpLocation> queue2;
-            Mob* followerMob = Mobs[mob->groupMember[i]];
+            auto path2 = std::make_shared<TransportPath>();
+            Mob* followerMob = it->second;
             from = { followerMob->appearanceData.iX, followerMob->appearanceData.iY, followerMob->appearanceData.iZ };
             to = { farX + followerMob->offsetX, farY + followerMob->offsetY, followerMob->appearanceData.iZ };
-            TransportManager::lerp(&queue2, from, to, speed);
-            TransportManager::NPCQueues[followerMob->appearanceData.iNPC_ID] = queue2;
+            path2->addSegment(from, to, speed);
+            plan.paths.push_back(std::make_pair(followerMob->appearanceData.iNPC_ID, path2));
         }
     }
 }
 
+void MobManager::roamingStep(Mob *mob, time_t currTime, MobPlan& plan) {
+    // roaming mobs have already looked for players this tick, in aggroStep()
+
+    // it wasn't roaming yet when the plans were made
+    if (!plan.roamPlanned)
+        planRoam(mob, currTime, plan);
+
+    if (plan.nextMovement != 0)
+        mob->nextMovement = plan.nextMovement;
+
+    if (!plan.paths.empty()) {
+        auto paths = std::move(plan.paths);
+        post([paths]() {
+            for (auto& pair : paths)
+                TransportManager::NPCPaths[pair.first] = { pair.second, 0 };
+        });
+    }
+
+    for (int i = 0; i < plan.missingFollowers; i++)
+        logLine("[WARN] roamingStep: leader can't find a group member!");
+}
+
 void MobManager::retreatStep(Mob *mob, time_t currTime) {
     if (mob->nextMovement != 0 && currTime < mob->nextMovement)
         return;
@@ -743,14 +895,14 @@ void MobManager::retreatStep(Mob *mob, time_t currTime) {
     // distance between spawn point and current location
     int distance = hypot(mob->appearanceData.iX - mob->roamX, mob->appearanceData.iY - mob->roamY);
 
-    //if (distance > mob->data["m_iIdleRange"]) {
+    //if (distance > mob->tmpl->idleRange) {
     if (distance > 10) {
         INITSTRUCT(sP_FE2CL_NPC_MOVE, pkt);
 
-        auto targ = lerp(mob->appearanceData.iX, mob->appearanceData.iY, mob->roamX, mob->roamY, (int)mob->data["m_iRunSpeed"]*4/5);
+        auto targ = lerp(mob->appearanceData.iX, mob->appearanceData.iY, mob->roamX, mob->roamY, mob->tmpl->runSpeed*4/5);
 
         pkt.iNPC_ID = mob->appearanceData.iNPC_ID;
-        pkt.iSpeed = (int)mob->data["m_iRunSpeed"] * 2;
+        pkt.iSpeed = mob->tmpl->runSpeed * 2;
         pkt.iToX = mob->appearanceData.iX = targ.first;
         pkt.iToY = mob->appearanceData.iY = targ.second;
         pkt.iToZ = mob->appearanceData.iZ = mob->spawnZ;
@@ -761,7 +913,7 @@ void MobManager::retreatStep(Mob *mob, time_t currTime) {
     }
 
     // if we got there
-    //if (distance <= mob->data["m_iIdleRange"]) {
+    //if (distance <= mob->tmpl->idleRange) {
     if (distance <= 10) { // retreat back to the spawn point
         mob->state = MobState::ROAMING;
         mob->appearanceData.iHP = mob->maxHealth;
@@ -771,52 +923,439 @@ void MobManager::retreatStep(Mob *mob, time_t currTime) {
 
         // cast a return home heal spell, this is the right way(tm)
         std::vector<int> targetData = {1, 0, 0, 0, 0};
+        const SkillData& skill = skillData(110);
         for (auto& pwr : MobPowers)
-            if (pwr.skillType == NanoManager::SkillTable[110].skillType)
-                pwr.handle(mob, targetData, 110, NanoManager::SkillTable[110].durationTime[0], NanoManager::SkillTable[110].powerIntensity[0]);
+            if (pwr.skillType == skill.skillType)
+                pwr.handle(mob, targetData, 110, skill.durationTime[0], skill.powerIntensity[0]);
         // clear outlying debuffs
         clearDebuff(mob);
     }
 }
 
-void MobManager::step(CNServer *serv, time_t currTime) {
-    for (auto& pair : Mobs) {
-        if (pair.second->playersInView < 0)
-            std::cout << "[WARN] Weird playerview value " << pair.second->playersInView << std::endl;
+void MobManager::scheduleMob(Mob *mob, time_t when) {
+    // an instance's tick only gets to touch its own mobs
+    if (currentTick != nullptr && mob->instanceID != currentTick->instance) {
+        post([mob, when]() { scheduleMob(mob, when); });
+        return;
+    }
+
+    // a mob only ever has to be looked at for the earliest thing it's waiting on
+    if (when >= mob->wakeTime)
+        return;
+
+    mob->wakeTime = when;
+    WakeQueue& queue = currentTick != nullptr ? *currentTick->queue : wakeQueues[mob->instanceID];
+    queue.push(std::make_pair(when, mob->appearanceData.iNPC_ID));
+}
+
+// for anything that changes what a mob should be doing from outside its own step
+void MobManager::wakeMob(Mob *mob) {
+    scheduleMob(mob, 0);
+}
+
+// mobs that aren't simulated right now sleep until a player comes into view or AI is toggled
+static bool mobSimulated(Mob *mob) {
+    return (MobManager::simulateMobs && mob->playersInView > 0)
+        || mob->state == MobState::DEAD || mob->state == MobState::RETREAT;
+}
+
+/*
+ * The earliest time any of the step functions could act on this mob again,
+ * going by the same timers they check. Erring early is harmless, since every
+ * step re-checks its own timers.
+ */
+static time_t nextWakeTime(Mob *mob, time_t currTime) {
+    if (!mobSimulated(mob))
+        return MOB_ASLEEP;
+
+    time_t wake = MOB_ASLEEP;
+    bool leader = mob->groupLeader == mob->appearanceData.iNPC_ID;
+
+    switch (mob->state) {
+    case MobState::INACTIVE:
+        break;
+    case MobState::ROAMING:
+        // aggro checks run off nextAttack; followers and mobs on static paths don't wander
+        wake = mob->nextAttack;
+        if (!mob->staticPath && (mob->groupLeader == 0 || leader))
+            wake = std::min(wake, mob->nextMovement);
+        break;
+    case MobState::COMBAT:
+        // fights also poll for drain, debuff expiry and random pursuit; keep them on every tick
+        wake = currTime + 1;
+        break;
+    case MobState::RETREAT:
+        wake = mob->nextMovement;
+        break;
+    case MobState::DEAD:
+        wake = mob->killedTime + mob->regenTime * 100;
+        if (!mob->despawned)
+            wake = std::min(wake, mob->killedTime + 2001);
+        if (leader)
+            wake = std::min(wake, mob->nextMovement);
+        break;
+    }
+
+    return wake;
+}
+
+// collects every mob in the queue whose wake time has come
+static void popDue(WakeQueue& queue, time_t currTime, std::vector<Mob*>& due) {
+    while (!queue.empty() && queue.top().first <= currTime) {
+        MobWake entry = queue.top();
+        queue.pop();
+
+        auto it = MobManager::Mobs.find(entry.second);
+        if (it == MobManager::Mobs.end() || it->second->wakeTime != entry.first)
+            continue; // stale
+
+        it->second->wakeTime = MOB_ASLEEP;
+        due.push_back(it->second);
+    }
+}
+
+/*
+ * Works out what every due mob is going to do before any of them does it. A
+ * plan only reads the mob itself and the players and mobs around it, none of
+ * which change until the plans are carried out, so the deciding can be spread
+ * over the workers; each writes nothing but its own mob's slot. The rolls come
+ * from a stream per mob, seeded from one shard-thread roll, so the outcome is
+ * the same on any number of threads.
+ */
+void MobManager::planStep(std::vector<Mob*>& due, time_t currTime, std::vector<MobPlan>& plans) {
+    uint64_t seed;
+    if (currentTick != nullptr)
+        seed = currentTick->seed;
+    else
+        seed = (uint64_t)Rand::next(Rand::AI) << 32 | (uint64_t)Rand::next(Rand::AI);
+
+    plans.clear();
+    plans.resize(due.size());
+
+    auto decide = [&](size_t i) {
+        Mob *mob = due[i];
+        MobPlan& plan = plans[i];
+        plan.rng = Xoshiro256(seed ^ (uint64_t)mob->appearanceData.iNPC_ID);
+
+        if (!mobSimulated(mob))
+            return;
+
+        bool leader = mob->groupLeader == mob->appearanceData.iNPC_ID;
+        if (mob->state == MobState::ROAMING || (mob->state == MobState::DEAD && leader))
+            planRoam(mob, currTime, plan);
+        else if (mob->state == MobState::COMBAT && mob->skillStyle == -2 && currTime >= mob->nextAttack)
+            planEruption(mob, plan);
+    };
+
+    // a quiet instance's handful of mobs isn't worth waking the workers for
+    if (due.size() < 64) {
+        for (size_t i = 0; i < due.size(); i++)
+            decide(i);
+        return;
+    }
+    mobWorkers->parallelFor(due.size(), decide);
+}
+
+static void stepDue(std::vector<Mob*>& due, time_t currTime) {
+    // engaging can pull whole groups out of roaming, so it goes before anyone plans
+    MobManager::aggroStep(due, currTime);
+
+    std::vector<MobPlan> plans;
+    MobManager::planStep(due, currTime, plans);
+
+    // carried out one by one, in the order the mobs came due
+    for (size_t i = 0; i < due.size(); i++) {
+        Mob *mob = due[i];
+        if (mob->playersInView < 0)
+            logLine("[WARN] Weird playerview value " + std::to_string(mob->playersInView));
 
         // skip mob movement and combat if disabled or not in view
-        if ((!simulateMobs || pair.second->playersInView == 0) && pair.second->state != MobState::DEAD
-        && pair.second->state != MobState::RETREAT)
+        if (!mobSimulated(mob))
             continue;
 
-        switch (pair.second->state) {
+        switch (mob->state) {
         case MobState::INACTIVE:
             // no-op
             break;
         case MobState::ROAMING:
-            roamingStep(pair.second, currTime);
+            MobManager::roamingStep(mob, currTime, plans[i]);
             break;
         case MobState::COMBAT:
-            combatStep(pair.second, currTime);
+            MobManager::combatStep(mob, currTime, plans[i]);
             break;
         case MobState::RETREAT:
-            retreatStep(pair.second, currTime);
+            MobManager::retreatStep(mob, currTime);
             break;
         case MobState::DEAD:
-            deadStep(pair.second, currTime);
+            MobManager::deadStep(mob, currTime, plans[i]);
             break;
         }
     }
 
+    // before the removal queue frees anything; entries for removed mobs go stale
+    for (Mob *mob : due)
+        MobManager::scheduleMob(mob, nextWakeTime(mob, currTime));
+}
+
+/*
+ * The overworld and the shared maps are stepped in full every tick, here on the
+ * shard thread. Private instances (lairs and the like) then tick side by side,
+ * one job each on mobWorkers, starting after the one that went first last time
+ * round; see InstanceTick for what they may touch. Jobs that haven't started
+ * once settings::INSTANCESTEPBUDGET is up leave their due mobs queued and go
+ * first next tick. Once they're all done, their outboxes are carried out here.
+ */
+void MobManager::step(CNServer *serv, time_t currTime) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Mob*> due;
+    std::vector<InstanceTick> ticks;
+    size_t woken = 0;
+
+    for (auto& pair : wakeQueues) {
+        if (PLAYERID(pair.first) == 0) {
+            popDue(pair.second, currTime, due);
+            continue;
+        }
+
+        InstanceTick tick;
+        tick.instance = pair.first;
+        tick.queue = &pair.second;
+        ticks.push_back(std::move(tick));
+    }
+
+    stepDue(due, currTime);
+    woken += due.size();
+
+    // rotate so the instance after the last one to get its turn goes first
+    auto first = std::upper_bound(ticks.begin(), ticks.end(), lastInstance,
+        [](uint64_t instance, const InstanceTick& tick) { return instance < tick.instance; });
+    std::rotate(ticks.begin(), first, ticks.end());
+
+    uint64_t seed = (uint64_t)Rand::next(Rand::AI) << 32 | (uint64_t)Rand::next(Rand::AI);
+    for (InstanceTick& tick : ticks) {
+        tick.seed = seed ^ tick.instance;
+        tick.rng = Xoshiro256(tick.seed);
+    }
+
+    auto instanceStart = std::chrono::steady_clock::now();
+    mobWorkers->parallelFor(ticks.size(), [&](size_t i) {
+        InstanceTick& tick = ticks[i];
+
+        auto spent = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - instanceStart).count();
+        if (settings::INSTANCESTEPBUDGET > 0 && spent >= settings::INSTANCESTEPBUDGET) {
+            tick.deferred = true;
+            return;
+        }
+
+        std::vector<Mob*> instanceDue;
+        currentTick = &tick;
+        popDue(*tick.queue, currTime, instanceDue);
+        stepDue(instanceDue, currTime);
+        currentTick = nullptr;
+        tick.woken = instanceDue.size();
+    });
+
+    size_t firstDeferred = ticks.size();
+    for (size_t i = 0; i < ticks.size(); i++) {
+        InstanceTick& tick = ticks[i];
+        if (tick.deferred) {
+            StepStats.deferred++;
+            firstDeferred = std::min(firstDeferred, i);
+            continue;
+        }
+
+        for (auto& fn : tick.outbox)
+            fn();
+        StepStats.posted += tick.outbox.size();
+        woken += tick.woken;
+    }
+    if (firstDeferred > 0 && !ticks.empty())
+        lastInstance = ticks[firstDeferred - 1].instance;
+
     // deallocate all NPCs queued for removal
     while (RemovalQueue.size() > 0) {
         NPCManager::destroyNPC(RemovalQueue.front());
         RemovalQueue.pop();
     }
+
+    // the cached candidates hold player pointers; don't let them outlive the tick
+    shardAggroCache.chunks.clear();
+    shardAggroCache.time = 0;
+
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    StepStats.steps++;
+    StepStats.totalMicros += elapsed;
+    if (elapsed > StepStats.maxMicros)
+        StepStats.maxMicros = elapsed;
+    StepStats.wakes += woken;
+    if (woken > StepStats.maxWakes)
+        StepStats.maxWakes = woken;
+
+    // drop the queues of instances that have wound down
+    StepStats.queued = 0;
+    for (auto it = wakeQueues.begin(); it != wakeQueues.end();) {
+        StepStats.queued += it->second.size();
+        if (it->second.empty())
+            it = wakeQueues.erase(it);
+        else
+            it++;
+    }
+    StepStats.instances = wakeQueues.size();
+}
+
+/*
+ * Aggro checks for the roaming mobs due this tick, batched per chunk: the players around a
+ * chunk are gathered once and every mob due for a check there is tested
+ * against them together.
+ */
+void MobManager::aggroStep(std::vector<Mob*>& due, time_t currTime) {
+    std::map<ChunkPos, MobBatch> batches;
+    AggroCache& cache = aggroCache();
+
+    cache.chunks.clear();
+    cache.time = currTime;
+
+    for (Mob *mob : due) {
+        if (!simulateMobs || mob->playersInView == 0 || mob->state != MobState::ROAMING)
+            continue;
+
+        /*
+         * We reuse nextAttack to avoid scanning for players all the time, but to still
+         * do so more often than if we waited for nextMovement (which is way too slow).
+         */
+        if (mob->nextAttack != 0 && currTime < mob->nextAttack)
+            continue;
+        mob->nextAttack = currTime + 500;
+
+        MobBatch& batch = batches[mob->chunkPos];
+        batch.x.push_back(mob->appearanceData.iX);
+        batch.y.push_back(mob->appearanceData.iY);
+        batch.z.push_back(mob->appearanceData.iZ);
+        batch.sightRange.push_back(mob->sightRange);
+        batch.mobs.push_back(mob);
+    }
+
+    /*
+     * Deciding is read-only, so each chunk's candidate snapshot and target
+     * picks can be worked out on any thread; the picks land in that chunk's
+     * own slot. Engaging then happens here, in chunk order, exactly as if it
+     * had all run serially.
+     */
+    std::vector<std::pair<MobBatch*, AggroCandidates*>> work;
+    for (auto& pair : batches)
+        work.push_back(std::make_pair(&pair.second, &cache.chunks[pair.first]));
+
+    std::vector<std::vector<int>> targets(work.size());
+    mobWorkers->parallelFor(work.size(), [&](size_t i) {
+        MobBatch& batch = *work[i].first;
+
+        // mobs in the same chunk see the same chunks
+        buildAggroCandidates(batch.mobs[0]->viewableChunks, *work[i].second);
+        nearestAggroTargets(batch, *work[i].second, targets[i]);
+    });
+
+    for (size_t b = 0; b < work.size(); b++) {
+        MobBatch& batch = *work[b].first;
+        AggroCandidates& cands = *work[b].second;
+
+        for (size_t i = 0; i < batch.mobs.size(); i++) {
+            // an earlier group leader may have already pulled this one into combat
+            if (targets[b][i] == -1 || batch.mobs[i]->state != MobState::ROAMING)
+                continue;
+
+            engageTarget(batch.mobs[i], cands.socks[targets[b][i]], currTime);
+        }
+    }
+}
+
+void MobManager::buildAggroCandidates(std::set<Chunk*>* chunks, AggroCandidates& out) {
+    for (Chunk *chunk : *chunks) {
+        for (CNSocket *s : chunk->players) {
+            Player *plr = PlayerManager::getPlayer(s);
+
+            if (plr->HP <= 0)
+                continue;
+
+            float scale = 1.0f;
+
+            if (plr->iConditionBitFlag & CSB_BIT_UP_STEALTH
+            || RacingManager::EPRaces.find(s) != RacingManager::EPRaces.end())
+                scale = 1.0f / 3;
+
+            if (plr->iSpecialState & (CN_SPECIAL_STATE_FLAG__INVISIBLE|CN_SPECIAL_STATE_FLAG__INVULNERABLE))
+                scale = -1.0f;
+
+            out.x.push_back(plr->x);
+            out.y.push_back(plr->y);
+            out.z.push_back(plr->z);
+            out.rangeScale.push_back(scale);
+            out.socks.push_back(s);
+            out.players.push_back(plr);
+        }
+    }
 }
 
 /*
- * Dynamic lerp; distinct from TransportManager::lerp(). This one doesn't care about height and
+ * For every mob in the batch, finds the index of the closest candidate within
+ * its sight range, or -1. Height counts twice because of platforming.
+ *
+ * The inner loop is kept branch-free over plain float arrays, in fixed-width
+ * blocks so the compiler vectorizes it even at -O2; comparing squared
+ * distances also drops the two hypot() calls the scalar version needed per pair.
+ */
+#define AGGRO_LANES 4
+
+static void aggroDistances(const float *__restrict cx, const float *__restrict cy, const float *__restrict cz,
+    const float *__restrict scale, float *__restrict d, size_t n, float mx, float my, float mz, float sight) {
+    for (size_t i = 0; i < n; i += AGGRO_LANES) {
+        for (int k = 0; k < AGGRO_LANES; k++) {
+            float dx = cx[i+k] - mx;
+            float dy = cy[i+k] - my;
+            float dz = (cz[i+k] - mz) * 2;
+            float range = sight * scale[i+k];
+            float d2 = dx*dx + dy*dy + dz*dz;
+            bool inRange = (range >= 0) & (d2 <= range*range);
+
+            d[i+k] = inRange ? d2 : INFINITY;
+        }
+    }
+}
+
+void MobManager::nearestAggroTargets(MobBatch& batch, AggroCandidates& cands, std::vector<int>& out) {
+    // pad the candidates out to whole blocks with untargetable dummies
+    while (cands.x.size() % AGGRO_LANES != 0) {
+        cands.x.push_back(0);
+        cands.y.push_back(0);
+        cands.z.push_back(0);
+        cands.rangeScale.push_back(-1.0f);
+        cands.socks.push_back(nullptr);
+        cands.players.push_back(nullptr);
+    }
+
+    size_t mobCount = batch.x.size();
+    size_t n = cands.x.size();
+    std::vector<float> dist(n);
+    float *d = dist.data();
+
+    out.assign(mobCount, -1);
+
+    for (size_t m = 0; m < mobCount; m++) {
+        aggroDistances(cands.x.data(), cands.y.data(), cands.z.data(), cands.rangeScale.data(), d, n,
+            batch.x[m], batch.y[m], batch.z[m], batch.sightRange[m]);
+
+        float closest = INFINITY;
+        for (size_t i = 0; i < n; i++) {
+            // HP is re-checked since a player might have died earlier this tick (padding never gets here)
+            if (d[i] < closest && cands.players[i]->HP > 0) {
+                closest = d[i];
+                out[m] = i;
+            }
+        }
+    }
+}
+
+/*
+ * Dynamic lerp; distinct from TransportPath. This one doesn't care about height and
  * only returns the first step, since the rest will need to be recalculated anyway if chasing player.
  */
 std::pair<int,int> MobManager::lerp(int x1, int y1, int x2, int y2, int speed) {
@@ -854,7 +1393,7 @@ void MobManager::combatBegin(CNSocket *sock, CNPacketData *data) {
 
     resp.iPC_ID = plr->iID;
     resp.iEquipSlotNum = 0;
-    resp.EquipSlotItem = plr->Equip[0];
+    resp.EquipSlotItem = plr->cold->Equip[0];
 
     PlayerManager::sendToViewable(sock, (void*)&resp, P_FE2CL_PC_EQUIP_CHANGE, sizeof(sP_FE2CL_PC_EQUIP_CHANGE));
 }
@@ -934,15 +1473,15 @@ void MobManager::dealGooDamage(CNSocket *sock, int amount) {
 void MobManager::playerTick(CNServer *serv, time_t currTime) {
     static time_t lastHealTime = 0;
 
+    // group ticks
+    for (auto& pair : GroupManager::Groups)
+        GroupManager::groupTickInfo(pair.second);
+
     for (auto& pair : PlayerManager::players) {
         CNSocket *sock = pair.first;
         Player *plr = pair.second;
         bool transmit = false;
 
-        // group ticks
-        if (plr->groupCnt > 1)
-            GroupManager::groupTickInfo(plr);
-
         // do not tick dead players
         if (plr->HP <= 0)
             continue;
@@ -1015,7 +1554,7 @@ std::pair<int,int> MobManager::getDamage(int attackPower, int defensePower, bool
     // base calculation
     int damage = attackPower * attackPower / (attackPower + defensePower);
     damage = std::max(10 + attackPower / 10, damage - (defensePower - attackPower / 6) * difficulty / 100);
-    damage = damage * (rand() % 40 + 80) / 100;
+    damage = damage * (tickRoll(Rand::COMBAT, 40) + 80) / 100;
 
     // Adaptium/Blastons/Cosmix
     if (attackerStyle != -1 && defenderStyle != -1 && attackerStyle != defenderStyle) {
@@ -1036,7 +1575,7 @@ std::pair<int,int> MobManager::getDamage(int attackPower, int defensePower, bool
     ret.first = damage;
     ret.second = 1;
 
-    if (shouldCrit && rand() % 20 == 0) {
+    if (shouldCrit && tickRoll(Rand::COMBAT, 20) == 0) {
         ret.first *= 2; // critical hit
         ret.second = 2;
     }
@@ -1074,14 +1613,7 @@ void MobManager::pcAttackChars(CNSocket *sock, CNPacketData *data) {
 
     for (int i = 0; i < pkt->iTargetCnt; i++) {
         if (pktdata[i*2+1] == 1) { // eCT == 1; attack player
-            Player *target = nullptr;
-
-            for (auto& pair : PlayerManager::players) {
-                if (pair.second->iID == pktdata[i*2]) {
-                    target = pair.second;
-                    break;
-                }
-            }
+            Player *target = PlayerManager::getPlayerFromID(pktdata[i*2]);
 
             if (target == nullptr) {
                 // you shall not pass
@@ -1125,10 +1657,10 @@ void MobManager::pcAttackChars(CNSocket *sock, CNPacketData *data) {
             else
                 damage.first = plr->pointDamage;
 
-            int difficulty = (int)mob->data["m_iNpcLevel"];
+            int difficulty = mob->tmpl->level;
 
-            damage = getDamage(damage.first, (int)mob->data["m_iProtection"], true, (plr->batteryW > 6 + difficulty),
-                NanoManager::nanoStyle(plr->activeNano), (int)mob->data["m_iNpcStyle"], difficulty);
+            damage = getDamage(damage.first, mob->tmpl->protection, true, (plr->batteryW > 6 + difficulty),
+                NanoManager::nanoStyle(plr->activeNano), mob->tmpl->npcStyle, difficulty);
 
             if (plr->batteryW >= 6 + difficulty)
                 plr->batteryW -= 6 + difficulty;
@@ -1178,8 +1710,11 @@ void MobManager::drainMobHP(Mob *mob, int amount) {
 
     NPCManager::sendToViewable(mob, (void*)&respbuf, P_FE2CL_CHAR_TIME_BUFF_TIME_TICK, resplen);
 
-    if (mob->appearanceData.iHP <= 0)
-        killMob(mob->target, mob);
+    // rewards can go to group members outside the instance
+    if (mob->appearanceData.iHP <= 0) {
+        CNSocket *killer = mob->target;
+        post([killer, mob]() { killMob(killer, mob); });
+    }
 }
 
 /*
@@ -1188,57 +1723,51 @@ void MobManager::drainMobHP(Mob *mob, int amount) {
  * as the mob, since it might be near a chunk boundary.
  */
 bool MobManager::aggroCheck(Mob *mob, time_t currTime) {
-    CNSocket *closest = nullptr;
-    int closestDistance = INT_MAX;
-
-    for (auto it = mob->viewableChunks->begin(); it != mob->viewableChunks->end(); it++) {
-        Chunk* chunk = *it;
-        for (CNSocket *s : chunk->players) {
-            Player *plr = PlayerManager::getPlayer(s);
-
-            if (plr->HP <= 0)
-                continue;
-
-            int mobRange = mob->sightRange;
-
-            if (plr->iConditionBitFlag & CSB_BIT_UP_STEALTH
-            || RacingManager::EPRaces.find(s) != RacingManager::EPRaces.end())
-                mobRange /= 3;
-
-            if (plr->iSpecialState & (CN_SPECIAL_STATE_FLAG__INVISIBLE|CN_SPECIAL_STATE_FLAG__INVULNERABLE))
-                mobRange = -1;
+    AggroCandidates local;
+    AggroCandidates *cands = &local;
+
+    // within a tick, reuse the candidates gathered for this chunk
+    AggroCache& cache = aggroCache();
+    if (currTime == cache.time) {
+        auto it = cache.chunks.find(mob->chunkPos);
+        if (it == cache.chunks.end()) {
+            it = cache.chunks.emplace(mob->chunkPos, AggroCandidates()).first;
+            buildAggroCandidates(mob->viewableChunks, it->second);
+        }
+        cands = &it->second;
+    } else
+        buildAggroCandidates(mob->viewableChunks, local);
 
-            // height is relevant for aggro distance because of platforming
-            int xyDistance = hypot(mob->appearanceData.iX - plr->x, mob->appearanceData.iY - plr->y);
-            int distance = hypot(xyDistance, (mob->appearanceData.iZ - plr->z) * 2); // difference in Z counts twice
+    MobBatch batch;
+    batch.x.push_back(mob->appearanceData.iX);
+    batch.y.push_back(mob->appearanceData.iY);
+    batch.z.push_back(mob->appearanceData.iZ);
+    batch.sightRange.push_back(mob->sightRange);
+    batch.mobs.push_back(mob);
 
-            if (distance > mobRange || distance > closestDistance)
-                continue;
+    std::vector<int> target;
+    nearestAggroTargets(batch, *cands, target);
 
-            // found a player
-            closest = s;
-            closestDistance = distance;
-        }
-    }
+    if (target[0] == -1)
+        return false;
 
-    if (closest != nullptr) {
-        // found closest player. engage.
-        mob->target = closest;
-        mob->state = MobState::COMBAT;
-        mob->nextMovement = currTime;
-        mob->nextAttack = 0;
+    engageTarget(mob, cands->socks[target[0]], currTime);
+    return true;
+}
 
-        mob->roamX = mob->appearanceData.iX;
-        mob->roamY = mob->appearanceData.iY;
-        mob->roamZ = mob->appearanceData.iZ;
+void MobManager::engageTarget(Mob *mob, CNSocket *target, time_t currTime) {
+    mob->target = target;
+    mob->state = MobState::COMBAT;
+    mob->nextMovement = currTime;
+    mob->nextAttack = 0;
+    wakeMob(mob);
 
-        if (mob->groupLeader != 0)
-            followToCombat(mob);
+    mob->roamX = mob->appearanceData.iX;
+    mob->roamY = mob->appearanceData.iY;
+    mob->roamZ = mob->appearanceData.iZ;
 
-        return true;
-    }
-
-    return false;
+    if (mob->groupLeader != 0)
+        followToCombat(mob);
 }
 
 void MobManager::clearDebuff(Mob *mob) {
@@ -1294,7 +1823,7 @@ void MobManager::rocketFire(CNSocket* sock, CNPacketData* data) {
 
     resp.iBulletID = addBullet(plr, false);
     // we have to send it weapon id
-    resp.Bullet.iID = plr->Equip[0].iID;
+    resp.Bullet.iID = plr->cold->Equip[0].iID;
     resp.iBatteryW = plr->batteryW;
 
     sock->sendPacket(&resp, P_FE2CL_REP_PC_GRENADE_STYLE_FIRE_SUCC, sizeof(sP_FE2CL_REP_PC_GRENADE_STYLE_FIRE_SUCC));
@@ -1331,12 +1860,12 @@ int8_t MobManager::addBullet(Player* plr, bool isGrenade) {
     toAdd.pointDamage = plr->pointDamage;
     toAdd.groupDamage = plr->groupDamage;
     // for grenade we need to send 1, for rocket - weapon id
-    toAdd.bulletType = isGrenade ? 1 : plr->Equip[0].iID;
+    toAdd.bulletType = isGrenade ? 1 : plr->cold->Equip[0].iID;
 
     // temp solution Jade fix plz
     toAdd.weaponBoost = plr->batteryW > 0;
     if (toAdd.weaponBoost) {
-        int boostCost = rand() % 11 + 20;
+        int boostCost = Rand::next(Rand::COMBAT, 11) + 20;
         plr->batteryW = boostCost > plr->batteryW ? 0 : plr->batteryW - boostCost;
     }
 
@@ -1406,8 +1935,8 @@ void MobManager::projectileHit(CNSocket* sock, CNPacketData* data) {
 
         damage.first = pkt->iTargetCnt > 1 ? bullet->groupDamage : bullet->pointDamage;
 
-        int difficulty = (int)mob->data["m_iNpcLevel"];
-        damage = getDamage(damage.first, (int)mob->data["m_iProtection"], true, bullet->weaponBoost, NanoManager::nanoStyle(plr->activeNano), (int)mob->data["m_iNpcStyle"], difficulty);
+        int difficulty = mob->tmpl->level;
+        damage = getDamage(damage.first, mob->tmpl->protection, true, bullet->weaponBoost, NanoManager::nanoStyle(plr->activeNano), mob->tmpl->npcStyle, difficulty);
 
         damage.first = hitMob(sock, mob, damage.first);
 
@@ -1434,7 +1963,7 @@ void MobManager::followToCombat(Mob *mob) {
                 break;
 
             if (Mobs.find(leadMob->groupMember[i]) == Mobs.end()) {
-                std::cout << "[WARN] roamingStep: leader can't find a group member!" << std::endl;
+                logLine("[WARN] roamingStep: leader can't find a group member!");
                 continue;
             }
             Mob* followerMob = Mobs[leadMob->groupMember[i]];
@@ -1446,6 +1975,7 @@ void MobManager::followToCombat(Mob *mob) {
             followerMob->state = MobState::COMBAT;
             followerMob->nextMovement = getTime();
             followerMob->nextAttack = 0;
+            wakeMob(followerMob);
 
             followerMob->roamX = followerMob->appearanceData.iX;
             followerMob->roamY = followerMob->appearanceData.iY;
@@ -1459,6 +1989,7 @@ void MobManager::followToCombat(Mob *mob) {
         leadMob->state = MobState::COMBAT;
         leadMob->nextMovement = getTime();
         leadMob->nextAttack = 0;
+        wakeMob(leadMob);
 
         leadMob->roamX = leadMob->appearanceData.iX;
         leadMob->roamY = leadMob->appearanceData.iY;
@@ -1466,7 +1997,7 @@ void MobManager::followToCombat(Mob *mob) {
     }
 }
 
-void MobManager::useAbilities(Mob *mob, time_t currTime) {
+void MobManager::useAbilities(Mob *mob, time_t currTime, MobPlan& plan) {
     /*
      * targetData approach
      * first integer is the count
@@ -1476,7 +2007,7 @@ void MobManager::useAbilities(Mob *mob, time_t currTime) {
     Player *plr = PlayerManager::getPlayer(mob->target);
 
     if (mob->skillStyle >= 0) { // corruption hit
-        int skillID = (int)mob->data["m_iCorruptionType"];
+        int skillID = mob->tmpl->corruptionType;
         std::vector<int> targetData = {1, plr->iID, 0, 0, 0};
         int temp = mob->skillStyle;
         mob->skillStyle = -3; // corruption cooldown
@@ -1486,31 +2017,26 @@ void MobManager::useAbilities(Mob *mob, time_t currTime) {
     }
 
     if (mob->skillStyle == -2) { // eruption hit
-        int skillID = (int)mob->data["m_iMegaType"];
+        int skillID = mob->tmpl->megaType;
         std::vector<int> targetData = {0, 0, 0, 0, 0};
 
-        // find the players within range of eruption
-        for (auto it = mob->viewableChunks->begin(); it != mob->viewableChunks->end(); it++) {
-            Chunk* chunk = *it;
-            for (CNSocket *s : chunk->players) {
-                Player *plr = PlayerManager::getPlayer(s);
+        if (!plan.eruptionPlanned)
+            planEruption(mob, plan);
 
-                if (plr->HP <= 0)
-                    continue;
+        // anyone caught in it may have gone down to another mob since the plans were made
+        for (int32_t id : plan.eruptionTargets) {
+            Player *target = PlayerManager::getPlayerFromID(id);
+            if (target == nullptr || target->HP <= 0 || target->instanceID != mob->instanceID)
+                continue;
 
-                int distance = hypot(mob->hitX - plr->x, mob->hitY - plr->y);
-                if (distance < NanoManager::SkillTable[skillID].effectArea) {
-                    targetData[0] += 1;
-                    targetData[targetData[0]] = plr->iID;
-                    if (targetData[0] > 3) // make sure not to have more than 4
-                        break;
-                }
-            }
+            targetData[0] += 1;
+            targetData[targetData[0]] = id;
         }
 
+        const SkillData& skill = skillData(skillID);
         for (auto& pwr : MobPowers)
-            if (pwr.skillType == NanoManager::SkillTable[skillID].skillType)
-                pwr.handle(mob, targetData, skillID, NanoManager::SkillTable[skillID].durationTime[0], NanoManager::SkillTable[skillID].powerIntensity[0]);
+            if (pwr.skillType == skill.skillType)
+                pwr.handle(mob, targetData, skillID, skill.durationTime[0], skill.powerIntensity[0]);
         mob->skillStyle = -3; // eruption cooldown
         mob->nextAttack = currTime + 1000;
         return;
@@ -1521,26 +2047,27 @@ void MobManager::useAbilities(Mob *mob, time_t currTime) {
         return;
     }
 
-    int random = rand() % 2000 * 1000;
-    int prob1 = (int)mob->data["m_iActiveSkill1Prob"]; // active skill probability
-    int prob2 = (int)mob->data["m_iCorruptionTypeProb"]; // corruption probability
-    int prob3 = (int)mob->data["m_iMegaTypeProb"]; // eruption probability
+    int random = roll(plan.rng, 2000) * 1000;
+    int prob1 = mob->tmpl->activeSkill1Prob; // active skill probability
+    int prob2 = mob->tmpl->corruptionTypeProb; // corruption probability
+    int prob3 = mob->tmpl->megaTypeProb; // eruption probability
 
     if (random < prob1) { // active skill hit
-        int skillID = (int)mob->data["m_iActiveSkill1"];
+        int skillID = mob->tmpl->activeSkill1;
         std::vector<int> targetData = {1, plr->iID, 0, 0, 0};
+        const SkillData& skill = skillData(skillID);
         for (auto& pwr : MobPowers)
-            if (pwr.skillType == NanoManager::SkillTable[skillID].skillType) {
+            if (pwr.skillType == skill.skillType) {
                 if (pwr.bitFlag != 0 && (plr->iConditionBitFlag & pwr.bitFlag))
                     return; // prevent debuffing a player twice
-                pwr.handle(mob, targetData, skillID, NanoManager::SkillTable[skillID].durationTime[0], NanoManager::SkillTable[skillID].powerIntensity[0]);
+                pwr.handle(mob, targetData, skillID, skill.durationTime[0], skill.powerIntensity[0]);
             }
-        mob->nextAttack = currTime + (int)mob->data["m_iDelayTime"] * 100;
+        mob->nextAttack = currTime + mob->tmpl->delayTime * 100;
         return;
     }
 
     if (random < prob1 + prob2) { // corruption windup
-        int skillID = (int)mob->data["m_iCorruptionType"];
+        int skillID = mob->tmpl->corruptionType;
         INITSTRUCT(sP_FE2CL_NPC_SKILL_CORRUPTION_READY, pkt);
         pkt.iNPC_ID = mob->appearanceData.iNPC_ID;
         pkt.iSkillID = skillID;
@@ -1551,7 +2078,7 @@ void MobManager::useAbilities(Mob *mob, time_t currTime) {
         if (mob->skillStyle == -1)
             mob->skillStyle = 2;
         if (mob->skillStyle == -2)
-            mob->skillStyle = rand() % 3;
+            mob->skillStyle = roll(plan.rng, 3);
         pkt.iStyle = mob->skillStyle;
         NPCManager::sendToViewable(mob, &pkt, P_FE2CL_NPC_SKILL_CORRUPTION_READY, sizeof(sP_FE2CL_NPC_SKILL_CORRUPTION_READY));
         mob->nextAttack = currTime + 1800;
@@ -1559,7 +2086,7 @@ void MobManager::useAbilities(Mob *mob, time_t currTime) {
     }
 
     if (random < prob1 + prob2 + prob3) { // eruption windup
-        int skillID = (int)mob->data["m_iMegaType"];
+        int skillID = mob->tmpl->megaType;
         INITSTRUCT(sP_FE2CL_NPC_SKILL_READY, pkt);
         pkt.iNPC_ID = mob->appearanceData.iNPC_ID;
         pkt.iSkillID = skillID;
@@ -1575,6 +2102,35 @@ void MobManager::useAbilities(Mob *mob, time_t currTime) {
     return;
 }
 
+/*
+ * The players within range of the eruption a mob is winding up, up to four.
+ * Only reads, so it can run on any thread.
+ */
+void MobManager::planEruption(Mob *mob, MobPlan& plan) {
+    plan.eruptionPlanned = true;
+
+    // find() only; operator[] could insert while another worker reads
+    auto skill = NanoManager::SkillTable.find(mob->tmpl->megaType);
+    if (skill == NanoManager::SkillTable.end())
+        return;
+
+    for (Chunk *chunk : *mob->viewableChunks) {
+        for (CNSocket *s : chunk->players) {
+            Player *plr = PlayerManager::getPlayer(s);
+
+            if (plr->HP <= 0)
+                continue;
+
+            int distance = hypot(mob->hitX - plr->x, mob->hitY - plr->y);
+            if (distance < skill->second.effectArea) {
+                plan.eruptionTargets.push_back(plr->iID);
+                if (plan.eruptionTargets.size() == 4) // make sure not to have more than 4
+                    return;
+            }
+        }
+    }
+}
+
 void MobManager::dealCorruption(Mob *mob, std::vector<int> targetData, int skillID, int style) {
     Player *plr = PlayerManager::getPlayer(mob->target);
 
@@ -1582,7 +2138,7 @@ void MobManager::dealCorruption(Mob *mob, std::vector<int> targetData, int skill
 
     // validate response packet
     if (!validOutVarPacket(sizeof(sP_FE2CL_NPC_SKILL_CORRUPTION_HIT), targetData[0], sizeof(sCAttackResult))) {
-        std::cout << "[WARN] bad sP_FE2CL_NPC_SKILL_CORRUPTION_HIT packet size" << std::endl;
+        logLine("[WARN] bad sP_FE2CL_NPC_SKILL_CORRUPTION_HIT packet size");
         return;
     }
 
@@ -1601,20 +2157,12 @@ void MobManager::dealCorruption(Mob *mob, std::vector<int> targetData, int skill
     resp->iTargetCnt = targetData[0];
 
     for (int i = 0; i < targetData[0]; i++) {
-        CNSocket *sock = nullptr;
-        Player *plr = nullptr;
-
-        for (auto& pair : PlayerManager::players) {
-            if (pair.second->iID == targetData[i+1]) {
-                sock = pair.first;
-                plr = pair.second;
-                break;
-            }
-        }
+        CNSocket *sock = PlayerManager::getSockFromID(targetData[i+1]);
+        Player *plr = sock != nullptr ? PlayerManager::getPlayer(sock) : nullptr;
 
         // player not found
         if (plr == nullptr) {
-            std::cout << "[WARN] dealCorruption: player ID not found" << std::endl;
+            logLine("[WARN] dealCorruption: player ID not found");
             return;
         }
 
@@ -1631,7 +2179,7 @@ void MobManager::dealCorruption(Mob *mob, std::vector<int> targetData, int skill
         int style2 = NanoManager::nanoStyle(plr->activeNano);
         if (style2 == -1) { // no nano
             respdata[i].iHitFlag = 8;
-            respdata[i].iDamage = NanoManager::SkillTable[skillID].powerIntensity[0] * PC_MAXHEALTH((int)mob->data["m_iNpcLevel"]) / 1500;
+            respdata[i].iDamage = skillData(skillID).powerIntensity[0] * PC_MAXHEALTH(mob->tmpl->level) / 1500;
         } else if (style == style2) {
             respdata[i].iHitFlag = 8; // tie
             respdata[i].iDamage = 0;
@@ -1642,14 +2190,18 @@ void MobManager::dealCorruption(Mob *mob, std::vector<int> targetData, int skill
             respdata[i].iNanoStamina = plr->Nanos[plr->activeNano].iStamina += 45;
             if (plr->Nanos[plr->activeNano].iStamina > 150)
                 respdata[i].iNanoStamina = plr->Nanos[plr->activeNano].iStamina = 150;
-            // fire damage power disguised as a corruption attack back at the enemy
+            // fire damage power disguised as a corruption attack back at the enemy;
+            // that can kill it, and kill rewards can go to group members outside the instance
             std::vector<int> targetData2 = {1, mob->appearanceData.iNPC_ID, 0, 0, 0};
-            for (auto& pwr : NanoManager::NanoPowers)
-                if (pwr.skillType == EST_DAMAGE)
-                    pwr.handle(sock, targetData2, plr->activeNano, skillID, 0, 200);
+            int16_t nanoID = plr->activeNano;
+            post([sock, targetData2, nanoID, skillID]() {
+                for (auto& pwr : NanoManager::NanoPowers)
+                    if (pwr.skillType == EST_DAMAGE)
+                        pwr.handle(sock, targetData2, nanoID, skillID, 0, 200);
+            });
         } else {
             respdata[i].iHitFlag = 16; // lose
-            respdata[i].iDamage = NanoManager::SkillTable[skillID].powerIntensity[0] * PC_MAXHEALTH((int)mob->data["m_iNpcLevel"]) / 1500;
+            respdata[i].iDamage = skillData(skillID).powerIntensity[0] * PC_MAXHEALTH(mob->tmpl->level) / 1500;
             respdata[i].iNanoStamina = plr->Nanos[plr->activeNano].iStamina -= 90;
             if (plr->Nanos[plr->activeNano].iStamina < 0) {
                 respdata[i].bNanoDeactive = 1;
@@ -1677,20 +2229,12 @@ void MobManager::dealCorruption(Mob *mob, std::vector<int> targetData, int skill
 #pragma region Mob Powers
 namespace MobManager {
 bool doDamageNDebuff(Mob *mob, sSkillResult_Damage_N_Debuff *respdata, int i, int32_t targetID, int32_t bitFlag, int16_t timeBuffID, int16_t duration, int16_t amount) {
-    CNSocket *sock = nullptr;
-    Player *plr = nullptr;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == targetID) {
-            sock = pair.first;
-            plr = pair.second;
-            break;
-        }
-    }
+    CNSocket *sock = PlayerManager::getSockFromID(targetID);
+    Player *plr = sock != nullptr ? PlayerManager::getPlayer(sock) : nullptr;
 
     // player not found
     if (plr == nullptr) {
-        std::cout << "[WARN] doDamageNDebuff: player ID not found" << std::endl;
+        logLine("[WARN] doDamageNDebuff: player ID not found");
         return false;
     }
 
@@ -1715,7 +2259,7 @@ bool doDamageNDebuff(Mob *mob, sSkillResult_Damage_N_Debuff *respdata, int i, in
         respdata[i].bProtected = 0;
         std::pair<CNSocket*, int32_t> key = std::make_pair(sock, bitFlag);
         time_t until = getTime() + (time_t)duration * 100;
-        NPCManager::EggBuffs[key] = until;
+        post([key, until]() { NPCManager::EggBuffs[key] = until; });
     }
     respdata[i].iConditionBitFlag = plr->iConditionBitFlag;
 
@@ -1744,22 +2288,15 @@ bool doHeal(Mob *mob, sSkillResult_Heal_HP *respdata, int i, int32_t targetID, i
 }
 
 bool doDamage(Mob *mob, sSkillResult_Damage *respdata, int i, int32_t targetID, int32_t bitFlag, int16_t timeBuffID, int16_t duration, int16_t amount) {
-    Player *plr = nullptr;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == targetID) {
-            plr = pair.second;
-            break;
-        }
-    }
+    Player *plr = PlayerManager::getPlayerFromID(targetID);
 
     // player not found
     if (plr == nullptr) {
-        std::cout << "[WARN] doDamage: player ID not found" << std::endl;
+        logLine("[WARN] doDamage: player ID not found");
         return false;
     }
 
-    int damage = amount * PC_MAXHEALTH((int)mob->data["m_iNpcLevel"]) / 1500;
+    int damage = amount * PC_MAXHEALTH(mob->tmpl->level) / 1500;
 
     if (plr->iSpecialState & CN_SPECIAL_STATE_FLAG__INVULNERABLE)
         damage = 0;
@@ -1782,7 +2319,7 @@ bool doDamage(Mob *mob, sSkillResult_Damage *respdata, int i, int32_t targetID,
 bool doLeech(Mob *mob, sSkillResult_Heal_HP *healdata, int i, int32_t targetID, int32_t bitFlag, int16_t timeBuffID, int16_t duration, int16_t amount) {
     // this sanity check is VERY important
     if (i != 0) {
-        std::cout << "[WARN] Mob attempted to leech more than one player!" << std::endl;
+        logLine("[WARN] Mob attempted to leech more than one player!");
         return false;
     }
 
@@ -1798,18 +2335,11 @@ bool doLeech(Mob *mob, sSkillResult_Heal_HP *healdata, int i, int32_t targetID,
     healdata->iHP = mob->appearanceData.iHP;
     healdata->iHealHP = healedAmount;
 
-    Player *plr = nullptr;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == targetID) {
-            plr = pair.second;
-            break;
-        }
-    }
+    Player *plr = PlayerManager::getPlayerFromID(targetID);
 
     // player not found
     if (plr == nullptr) {
-        std::cout << "[WARN] doLeech: player ID not found" << std::endl;
+        logLine("[WARN] doLeech: player ID not found");
         return false;
     }
 
@@ -1834,18 +2364,11 @@ bool doLeech(Mob *mob, sSkillResult_Heal_HP *healdata, int i, int32_t targetID,
 }
 
 bool doBatteryDrain(Mob *mob, sSkillResult_BatteryDrain *respdata, int i, int32_t targetID, int32_t bitFlag, int16_t timeBuffID, int16_t duration, int16_t amount) {
-    Player *plr = nullptr;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == targetID) {
-            plr = pair.second;
-            break;
-        }
-    }
+    Player *plr = PlayerManager::getPlayerFromID(targetID);
 
     // player not found
     if (plr == nullptr) {
-        std::cout << "[WARN] doBatteryDrain: player ID not found" << std::endl;
+        logLine("[WARN] doBatteryDrain: player ID not found");
         return false;
     }
 
@@ -1858,8 +2381,8 @@ bool doBatteryDrain(Mob *mob, sSkillResult_BatteryDrain *respdata, int i, int32_
         respdata[i].iDrainN = 0;
     } else {
         respdata[i].bProtected = 0;
-        respdata[i].iDrainW = amount * (18 + (int)mob->data["m_iNpcLevel"]) / 36;
-        respdata[i].iDrainN = amount * (18 + (int)mob->data["m_iNpcLevel"]) / 36;
+        respdata[i].iDrainW = amount * (18 + mob->tmpl->level) / 36;
+        respdata[i].iDrainN = amount * (18 + mob->tmpl->level) / 36;
     }
 
     respdata[i].iBatteryW = plr->batteryW -= (respdata[i].iDrainW < plr->batteryW) ? respdata[i].iDrainW : plr->batteryW;
@@ -1884,7 +2407,7 @@ void mobPower(Mob *mob, std::vector<int> targetData,
 
     // validate response packet
     if (!validOutVarPacket(sizeof(sP_FE2CL_NPC_SKILL_HIT), targetData[0], sizeof(sPAYLOAD))) {
-        std::cout << "[WARN] bad sP_FE2CL_NPC_SKILL_HIT packet size" << std::endl;
+        logLine("[WARN] bad sP_FE2CL_NPC_SKILL_HIT packet size");
         return;
     }
 
@@ -4,12 +4,21 @@
 #include "CNShared.hpp"
 #include "CNShardServer.hpp"
 #include "NPC.hpp"
+#include "SlotMap.hpp"
+#include "Rand.hpp"
 
 #include "contrib/JSON.hpp"
 
 #include <map>
 #include <unordered_map>
 #include <queue>
+#include <limits>
+#include <memory>
+
+struct TransportPath;
+
+// wakeTime of a mob that isn't waiting on a timer, only on being woken up
+#define MOB_ASLEEP std::numeric_limits<time_t>::max()
 
 enum class MobState {
     INACTIVE,
@@ -30,6 +39,9 @@ struct Mob : public BaseNPC {
 
     std::unordered_map<int32_t,time_t> unbuffTimes;
 
+    // when MobManager::step() next has to look at this mob
+    time_t wakeTime = MOB_ASLEEP;
+
     // dead
     time_t killedTime = 0;
     time_t regenTime;
@@ -58,48 +70,19 @@ struct Mob : public BaseNPC {
     int offsetX, offsetY;
     int groupMember[4] = {0, 0, 0, 0};
 
-    // temporary; until we're sure what's what
-    nlohmann::json data;
-
-    Mob(int x, int y, int z, int angle, uint64_t iID, int type, nlohmann::json d, int32_t id)
-        : BaseNPC(x, y, z, angle, iID, type, id),
-          maxHealth(d["m_iHP"]),
-          sightRange(d["m_iSightRange"]) {
-        state = MobState::ROAMING;
-
-        data = d;
-
-        regenTime = data["m_iRegenTime"];
-        idleRange = (int)data["m_iIdleRange"];
-        dropType = data["m_iDropType"];
-        level = data["m_iNpcLevel"];
-
-        roamX = spawnX = appearanceData.iX;
-        roamY = spawnY = appearanceData.iY;
-        roamZ = spawnZ = appearanceData.iZ;
+    // shared, immutable stats for this NPC type
+    const MobTemplate *tmpl;
 
-        offsetX = 0;
-        offsetY = 0;
-
-        appearanceData.iConditionBitFlag = 0;
-
-        // NOTE: there appear to be discrepancies in the dump
-        appearanceData.iHP = maxHealth;
-
-        npcClass = NPC_MOB;
-    }
+    // defined in MobManager.cpp, since new mobs have to be scheduled
+    Mob(int x, int y, int z, int angle, uint64_t iID, int type, const MobTemplate *t, int32_t id);
 
     // constructor for /summon
-    Mob(int x, int y, int z, uint64_t iID, int type, nlohmann::json d, int32_t id)
-        : Mob(x, y, z, 0, iID, type, d, id) {
+    Mob(int x, int y, int z, uint64_t iID, int type, const MobTemplate *t, int32_t id)
+        : Mob(x, y, z, 0, iID, type, t, id) {
         summoned = true; // will be despawned and deallocated when killed
     }
 
     ~Mob() {}
-
-    auto operator[](std::string s) {
-        return data[s];
-    }
 };
 
 struct MobDropChance {
@@ -122,6 +105,47 @@ struct Bullet {
     int bulletType;
 };
 
+/*
+ * Potential aggro targets around a chunk, kept as parallel arrays so the
+ * distance kernel runs over contiguous floats. Built once per chunk per tick
+ * and shared by every mob in that chunk.
+ */
+struct AggroCandidates {
+    std::vector<float> x, y, z;
+    std::vector<float> rangeScale; // scales a mob's sight range; negative means untargetable
+    std::vector<CNSocket*> socks;
+    std::vector<Player*> players;
+};
+
+/*
+ * The slice of mob state the aggro kernel reads, one entry per mob,
+ * gathered for all mobs due for an aggro check in the same chunk.
+ */
+struct MobBatch {
+    std::vector<float> x, y, z;
+    std::vector<float> sightRange;
+    std::vector<Mob*> mobs;
+};
+
+/*
+ * What a due mob is going to do this tick, decided in MobManager::planStep()
+ * and carried out by its step function. Anything a step needs that wasn't
+ * planned (because the mob's state changed in between) it works out itself.
+ */
+struct MobPlan {
+    Xoshiro256 rng; // every roll the mob makes this tick
+
+    // roaming, and dead group leaders
+    bool roamPlanned = false;
+    time_t nextMovement = 0; // 0 leaves it as it is
+    std::vector<std::pair<int32_t, std::shared_ptr<TransportPath>>> paths; // its own, then its followers'
+    int missingFollowers = 0;
+
+    // combat
+    bool eruptionPlanned = false;
+    std::vector<int32_t> eruptionTargets; // player IDs; the HP check is repeated when it goes off
+};
+
 typedef void (*MobPowerHandler)(Mob*, std::vector<int>, int16_t, int16_t, int16_t, int16_t, int32_t, int16_t);
 
 struct MobPower {
@@ -140,23 +164,41 @@ struct MobPower {
     }
 };
 
+// wall-clock cost of MobManager::step(), for /mobinfo
+struct MobStepStats {
+    uint64_t steps;
+    uint64_t totalMicros;
+    uint64_t maxMicros;
+    uint64_t wakes; // mobs actually stepped
+    uint64_t maxWakes;
+    size_t queued; // wake queue entries left after the last step, stale ones included
+    size_t instances; // instances with queued mobs
+    uint64_t deferred; // private instance turns put off to the next step
+    uint64_t posted; // operations instance ticks handed back to the shard thread
+};
+
 namespace MobManager {
-    extern std::map<int32_t, Mob*> Mobs;
+    extern SlotMap<Mob*> Mobs;
     extern std::queue<int32_t> RemovalQueue;
     extern std::map<int32_t, MobDropChance> MobDropChances;
     extern std::map<int32_t, MobDrop> MobDrops;
     extern std::map<int32_t, std::map<int8_t, Bullet>> Bullets;
     extern bool simulateMobs;
     extern std::vector<MobPower> MobPowers;
+    extern MobStepStats StepStats;
 
     void init();
     void step(CNServer*, time_t);
     void playerTick(CNServer*, time_t);
 
-    void deadStep(Mob*, time_t);
-    void combatStep(Mob*, time_t);
+    void planStep(std::vector<Mob*>& due, time_t currTime, std::vector<MobPlan>& plans);
+    void planRoam(Mob *mob, time_t currTime, MobPlan& plan);
+    void planEruption(Mob *mob, MobPlan& plan);
+
+    void deadStep(Mob*, time_t, MobPlan&);
+    void combatStep(Mob*, time_t, MobPlan&);
     void retreatStep(Mob*, time_t);
-    void roamingStep(Mob*, time_t);
+    void roamingStep(Mob*, time_t, MobPlan&);
 
     void pcAttackNpcs(CNSocket *sock, CNPacketData *data);
     void combatBegin(CNSocket *sock, CNPacketData *data);
@@ -177,7 +219,13 @@ namespace MobManager {
     void pcAttackChars(CNSocket *sock, CNPacketData *data);
     void drainMobHP(Mob *mob, int amount);
     void incNextMovement(Mob *mob, time_t currTime=0);
+    void scheduleMob(Mob *mob, time_t when);
+    void wakeMob(Mob *mob);
     bool aggroCheck(Mob *mob, time_t currTime);
+    void aggroStep(std::vector<Mob*>& due, time_t currTime);
+    void buildAggroCandidates(std::set<Chunk*>* chunks, AggroCandidates& out);
+    void nearestAggroTargets(MobBatch& batch, AggroCandidates& cands, std::vector<int>& out);
+    void engageTarget(Mob *mob, CNSocket *target, time_t currTime);
     void clearDebuff(Mob *mob);
 
     void grenadeFire(CNSocket* sock, CNPacketData* data);
@@ -187,6 +235,6 @@ namespace MobManager {
     int8_t addBullet(Player* plr, bool isGrenade);
 
     void followToCombat(Mob *mob);
-    void useAbilities(Mob *mob, time_t currTime);
+    void useAbilities(Mob *mob, time_t currTime, MobPlan& plan);
     void dealCorruption(Mob *mob, std::vector<int> targetData, int skillID, int style);
 }
@@ -3,6 +3,40 @@
 #include "CNStructs.hpp"
 #include "ChunkManager.hpp"
 
+/*
+ * Typed copy of an NPC type's xdt entry, compiled once at load time so that
+ * mob AI doesn't do string-keyed JSON lookups every step.
+ * Indexed by NPC type in NPCManager::MobTemplates; mobs point into it.
+ */
+struct MobTemplate {
+    int type;
+    int team;
+    int maxHealth;
+    int level;
+    int regenTime;
+    int dropType;
+
+    // ranges
+    int sightRange;
+    int idleRange;
+    int combatRange;
+    int atkRange;
+    int radius;
+
+    // movement
+    int walkSpeed;
+    int runSpeed;
+    int delayTime; // in tenths of a second
+
+    // combat
+    int power;
+    int protection;
+    int npcStyle;
+    int activeSkill1, activeSkill1Prob;
+    int corruptionType, corruptionTypeProb;
+    int megaType, megaTypeProb;
+};
+
 class BaseNPC {
 public:
     sNPCAppearanceData appearanceData;
@@ -9,6 +9,7 @@
 #include "ChatManager.hpp"
 #include "GroupManager.hpp"
 #include "RacingManager.hpp"
+#include "Rand.hpp"
 
 #include <cmath>
 #include <algorithm>
@@ -20,23 +21,14 @@
 
 #include "contrib/JSON.hpp"
 
-std::map<int32_t, BaseNPC*> NPCManager::NPCs;
+SlotMap<BaseNPC*> NPCManager::NPCs;
 std::map<int32_t, WarpLocation> NPCManager::Warps;
 std::vector<WarpLocation> NPCManager::RespawnPoints;
 /// sock, CBFlag -> until
 std::map<std::pair<CNSocket*, int32_t>, time_t> NPCManager::EggBuffs;
 std::unordered_map<int, EggType> NPCManager::EggTypes;
 std::unordered_map<int, Egg*> NPCManager::Eggs;
-nlohmann::json NPCManager::NPCData;
-
-
-
-/*
- * Initialized at the end of TableData::init().
- * This allows us to summon and kill mobs in arbitrary order without
- * NPC ID collisions.
- */
-int32_t NPCManager::nextId;
+std::vector<MobTemplate> NPCManager::MobTemplates;
 
 void NPCManager::init() {
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_PC_WARP_USE_NPC, npcWarpHandler);
@@ -56,14 +48,65 @@ void NPCManager::init() {
     REGISTER_SHARD_TIMER(eggStep, 1000);
 }
 
+/*
+ * Compiles the xdt NPC table into MobTemplates, keeping the table's order so
+ * NPC types index it directly. Missing fields default to 0.
+ */
+void NPCManager::loadMobTemplates(nlohmann::json& npcData) {
+    size_t jsonBytes = 0;
+
+    MobTemplates.clear();
+    MobTemplates.reserve(npcData.size());
+
+    for (nlohmann::json& td : npcData) {
+        MobTemplate t = {};
+
+        t.type = td.value("m_iNpcNumber", 0);
+        t.team = td.value("m_iTeam", 0);
+        t.maxHealth = td.value("m_iHP", 0);
+        t.level = td.value("m_iNpcLevel", 0);
+        t.regenTime = td.value("m_iRegenTime", 0);
+        t.dropType = td.value("m_iDropType", 0);
+
+        t.sightRange = td.value("m_iSightRange", 0);
+        t.idleRange = td.value("m_iIdleRange", 0);
+        t.combatRange = td.value("m_iCombatRange", 0);
+        t.atkRange = td.value("m_iAtkRange", 0);
+        t.radius = td.value("m_iRadius", 0);
+
+        t.walkSpeed = td.value("m_iWalkSpeed", 0);
+        t.runSpeed = td.value("m_iRunSpeed", 0);
+        t.delayTime = td.value("m_iDelayTime", 0);
+
+        t.power = td.value("m_iPower", 0);
+        t.protection = td.value("m_iProtection", 0);
+        t.npcStyle = td.value("m_iNpcStyle", 0);
+        t.activeSkill1 = td.value("m_iActiveSkill1", 0);
+        t.activeSkill1Prob = td.value("m_iActiveSkill1Prob", 0);
+        t.corruptionType = td.value("m_iCorruptionType", 0);
+        t.corruptionTypeProb = td.value("m_iCorruptionTypeProb", 0);
+        t.megaType = td.value("m_iMegaType", 0);
+        t.megaTypeProb = td.value("m_iMegaTypeProb", 0);
+
+        MobTemplates.push_back(t);
+        jsonBytes += td.dump().size();
+    }
+
+    // each mob used to carry its own copy of its type's JSON entry
+    std::cout << "[INFO] Compiled " << MobTemplates.size() << " mob templates ("
+        << MobTemplates.size() * sizeof(MobTemplate) << " bytes; average serialized entry was "
+        << (MobTemplates.empty() ? 0 : jsonBytes / MobTemplates.size()) << " bytes per mob)" << std::endl;
+}
+
 void NPCManager::destroyNPC(int32_t id) {
-    // sanity check
-    if (NPCs.find(id) == NPCs.end()) {
+    // sanity check; also catches stale IDs whose slot has since been reused
+    auto it = NPCs.find(id);
+    if (it == NPCs.end()) {
         std::cout << "npc not found: " << id << std::endl;
         return;
     }
 
-    BaseNPC* entity = NPCs[id];
+    BaseNPC* entity = it->second;
 
     // sanity check
     if (!ChunkManager::chunkExists(entity->chunkPos)) {
@@ -78,8 +121,7 @@ void NPCManager::destroyNPC(int32_t id) {
     ChunkManager::removeNPCFromChunks(ChunkManager::getViewableChunks(entity->chunkPos), id);
 
     // remove from mob manager
-    if (MobManager::Mobs.find(id) != MobManager::Mobs.end())
-        MobManager::Mobs.erase(id);
+    MobManager::Mobs.erase(id);
 
     // remove from eggs
     if (Eggs.find(id) != Eggs.end())
@@ -154,7 +196,7 @@ void NPCManager::npcVendorBuy(CNSocket* sock, CNPacketData* data) {
     INITSTRUCT(sP_FE2CL_REP_PC_VENDOR_ITEM_BUY_SUCC, resp);
 
     plr->money = plr->money - itemCost;
-    plr->Inven[slot] = req->Item;
+    plr->cold->Inven[slot] = req->Item;
 
     resp.iCandy = plr->money;
     resp.iInvenSlotNum = slot;
@@ -178,7 +220,7 @@ void NPCManager::npcVendorSell(CNSocket* sock, CNPacketData* data) {
         return;
     }
 
-    sItemBase* item = &plr->Inven[req->iInvenSlotNum];
+    sItemBase* item = &plr->cold->Inven[req->iInvenSlotNum];
     ItemManager::Item* itemData = ItemManager::getItemData(item->iID, item->iType);
 
     if (itemData == nullptr || !itemData->sellable) { // sanity + sellable check
@@ -200,7 +242,7 @@ void NPCManager::npcVendorSell(CNSocket* sock, CNPacketData* data) {
     plr->money = plr->money + sellValue;
 
     // modify item
-    if (plr->Inven[req->iInvenSlotNum].iOpt - req->iItemCnt > 0) { // selling part of a stack
+    if (plr->cold->Inven[req->iInvenSlotNum].iOpt - req->iItemCnt > 0) { // selling part of a stack
         item->iOpt -= req->iItemCnt;
         original.iOpt = req->iItemCnt;
     } else { // selling entire slot
@@ -254,7 +296,7 @@ void NPCManager::npcVendorBuyback(CNSocket* sock, CNPacketData* data) {
     }
 
     plr->money = plr->money - itemCost;
-    plr->Inven[slot] = req->Item;
+    plr->cold->Inven[slot] = req->Item;
 
     INITSTRUCT(sP_FE2CL_REP_PC_VENDOR_ITEM_RESTORE_BUY_SUCC, resp);
     // response parameters
@@ -363,8 +405,8 @@ void NPCManager::npcCombineItems(CNSocket* sock, CNPacketData* data) {
         return;
     }
 
-    sItemBase* itemStats = &plr->Inven[req->iStatItemSlot];
-    sItemBase* itemLooks = &plr->Inven[req->iCostumeItemSlot];
+    sItemBase* itemStats = &plr->cold->Inven[req->iStatItemSlot];
+    sItemBase* itemLooks = &plr->cold->Inven[req->iCostumeItemSlot];
     ItemManager::Item* itemStatsDat = ItemManager::getItemData(itemStats->iID, itemStats->iType);
     ItemManager::Item* itemLooksDat = ItemManager::getItemData(itemLooks->iID, itemLooks->iType);
 
@@ -401,7 +443,7 @@ void NPCManager::npcCombineItems(CNSocket* sock, CNPacketData* data) {
         break;
     }
 
-    float rolled = (rand() * 1.0f / RAND_MAX) * 100.0f; // success chance out of 100
+    float rolled = Rand::nextFloat(Rand::LOOT) * 100.0f; // success chance out of 100
     //std::cout << rolled << " vs " << successChance << std::endl;
     plr->money -= cost;
 
@@ -442,8 +484,8 @@ void NPCManager::npcBarkHandler(CNSocket* sock, CNPacketData* data) {
     TaskData* td = MissionManager::Tasks[req->iMissionTaskID];
     std::vector<int> barks;
     for (int i = 0; i < 4; i++) {
-        if (td->task["m_iHBarkerTextID"][i] != 0) // non-zeroes only
-            barks.push_back(td->task["m_iHBarkerTextID"][i]);
+        if (td->barkerTextID[i] != 0) // non-zeroes only
+            barks.push_back(td->barkerTextID[i]);
     }
 
     if (barks.empty())
@@ -451,7 +493,7 @@ void NPCManager::npcBarkHandler(CNSocket* sock, CNPacketData* data) {
 
     INITSTRUCT(sP_FE2CL_REP_BARKER, resp);
     resp.iNPC_ID = req->iNPC_ID;
-    resp.iMissionStringID = barks[rand() % barks.size()];
+    resp.iMissionStringID = barks[Rand::next(Rand::MISC, barks.size())];
     sock->sendPacket((void*)&resp, P_FE2CL_REP_BARKER, sizeof(sP_FE2CL_REP_BARKER));
 }
 
@@ -473,13 +515,12 @@ BaseNPC *NPCManager::summonNPC(int x, int y, int z, uint64_t instance, int type,
     uint64_t inst = baseInstance ? MAPNUM(instance) : instance;
 #define EXTRA_HEIGHT 0
 
-    assert(nextId < INT32_MAX);
-    int id = nextId++;
-    int team = NPCData[type]["m_iTeam"];
+    // IDs of destroyed NPCs get recycled under a new generation
+    int32_t id = NPCs.allocate();
     BaseNPC *npc = nullptr;
 
-    if (team == 2) {
-        npc = new Mob(x, y, z + EXTRA_HEIGHT, inst, type, NPCData[type], id);
+    if (MobTemplates[type].team == 2) {
+        npc = new Mob(x, y, z + EXTRA_HEIGHT, inst, type, &MobTemplates[type], id);
         MobManager::Mobs[id] = (Mob*)npc;
 
         // re-enable respawning, if desired
@@ -499,7 +540,7 @@ void NPCManager::npcSummonHandler(CNSocket* sock, CNPacketData* data) {
     sP_CL2FE_REQ_NPC_SUMMON* req = (sP_CL2FE_REQ_NPC_SUMMON*)data->buf;
     Player* plr = PlayerManager::getPlayer(sock);
 
-    int limit = NPCData.back()["m_iNpcNumber"];
+    int limit = MobTemplates.back().type;
 
     // permission & sanity check
     if (plr->accountLevel > 30 || req->iNPCType >= limit || req->iNPCCnt > 100)
@@ -553,7 +594,7 @@ void NPCManager::handleWarp(CNSocket* sock, int32_t warpId) {
 
         // if warp requires you to be on a mission, it's gotta be a unique instance
         if (Warps[warpId].limitTaskID != 0 || instanceID == 14) { // 14 is a special case for the Time Lab
-            instanceID += ((uint64_t)plr->iIDGroup << 32); // upper 32 bits are leader ID
+            instanceID += ((uint64_t)GroupManager::getLeaderID(plr) << 32); // upper 32 bits are leader ID
             ChunkManager::createInstance(instanceID);
 
             // save Lair entrance coords as a pseudo-Resurrect 'Em
@@ -563,17 +604,14 @@ void NPCManager::handleWarp(CNSocket* sock, int32_t warpId) {
             plr->recallInstance = instanceID;
         }
 
-        if (plr->iID == plr->iIDGroup && plr->groupCnt == 1)
+        if (plr->group == nullptr)
             PlayerManager::sendPlayerTo(sock, Warps[warpId].x, Warps[warpId].y, Warps[warpId].z, instanceID);
         else {
-            Player* leaderPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
+            Group* group = plr->group;
 
-            for (int i = 0; i < leaderPlr->groupCnt; i++) {
-                Player* otherPlr = PlayerManager::getPlayerFromID(leaderPlr->groupIDs[i]);
-                CNSocket* sockTo = PlayerManager::getSockFromID(leaderPlr->groupIDs[i]);
-
-                if (otherPlr == nullptr || sockTo == nullptr)
-                    continue;
+            for (size_t i = 0; i < group->members.size(); i++) {
+                Player* otherPlr = group->members[i];
+                CNSocket* sockTo = group->socks[i];
 
                 // save Lair entrance coords for everyone else as well
                 otherPlr->recallX = Warps[warpId].x;
@@ -645,9 +683,7 @@ BaseNPC* NPCManager::getNearestNPC(std::set<Chunk*>* chunks, int X, int Y, int Z
 
 int NPCManager::eggBuffPlayer(CNSocket* sock, int skillId, int eggId) {
     Player* plr = PlayerManager::getPlayer(sock);
-    Player* otherPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
-
-    int bitFlag = GroupManager::getGroupFlags(otherPlr);
+    int bitFlag = GroupManager::getGroupFlags(plr);
     int CBFlag = NanoManager::applyBuff(sock, skillId, 1, 3, bitFlag);
 
     size_t resplen; 
@@ -726,9 +762,7 @@ void NPCManager::eggStep(CNServer* serv, time_t currTime) {
             CNSocket* sock = it->first.first;
             int32_t CBFlag = it->first.second;
             Player* plr = PlayerManager::getPlayer(sock);
-            Player* otherPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
-
-            int groupFlags = GroupManager::getGroupFlags(otherPlr);
+            int groupFlags = GroupManager::getGroupFlags(plr);
             for (auto& pwr : NanoManager::NanoPowers) {
                 if (pwr.bitFlag == CBFlag) { // pick the power with the right flag and unbuff
                     INITSTRUCT(sP_FE2CL_PC_BUFF_UPDATE, resp);
@@ -869,7 +903,7 @@ void NPCManager::eggPickup(CNSocket* sock, CNPacketData* data) {
             item->eIL = 1; // Inventory Location. 1 means player inventory.
 
             // update player
-            plr->Inven[slot] = item->sItem;
+            plr->cold->Inven[slot] = item->sItem;
             sock->sendPacket((void*)respbuf, P_FE2CL_REP_REWARD_ITEM, resplen);
         }
     }
@@ -3,6 +3,7 @@
 #include "CNProtocol.hpp"
 #include "PlayerManager.hpp"
 #include "NPC.hpp"
+#include "SlotMap.hpp"
 
 #include "contrib/JSON.hpp"
 
@@ -53,16 +54,16 @@ struct EggType {
 };
 
 namespace NPCManager {
-    extern std::map<int32_t, BaseNPC*> NPCs;
+    extern SlotMap<BaseNPC*> NPCs;
     extern std::map<int32_t, WarpLocation> Warps;
     extern std::vector<WarpLocation> RespawnPoints;
     extern std::vector<NPCEvent> NPCEvents;
     extern std::unordered_map<int, Egg*> Eggs;
     extern std::map<std::pair<CNSocket*, int32_t>, time_t> EggBuffs;
     extern std::unordered_map<int, EggType> EggTypes;
-    extern nlohmann::json NPCData;
-    extern int32_t nextId;
+    extern std::vector<MobTemplate> MobTemplates;
     void init();
+    void loadMobTemplates(nlohmann::json& npcData);
 
     void destroyNPC(int32_t);
     void updateNPCPosition(int32_t, int X, int Y, int Z, uint64_t I, int angle);
@@ -258,7 +258,7 @@ void NanoManager::addNano(CNSocket* sock, int16_t nanoID, int16_t slot, bool spe
     plr->level = level;
 
     if (spendfm)
-        MissionManager::updateFusionMatter(sock, -(int)MissionManager::AvatarGrowth[plr->level-1]["m_iReqBlob_NanoCreate"]);
+        MissionManager::updateFusionMatter(sock, -MissionManager::AvatarGrowth[plr->level-1].reqBlobNanoCreate);
 #endif
 
     // Send to client
@@ -370,7 +370,7 @@ void NanoManager::setNanoSkill(CNSocket* sock, sP_CL2FE_REQ_NANO_TUNE* skill) {
     resp.iNanoID = skill->iNanoID;
     resp.iSkillID = skill->iTuneID;
     resp.iPC_FusionMatter = plr->fusionmatter;
-    resp.aItem[9] = plr->Inven[0]; // quick fix to make sure item in slot 0 doesn't get yeeted by default
+    resp.aItem[9] = plr->cold->Inven[0]; // quick fix to make sure item in slot 0 doesn't get yeeted by default
 
 
     // check if there's any garbage in the item slot array (this'll happen when a nano station isn't used)
@@ -382,18 +382,18 @@ void NanoManager::setNanoSkill(CNSocket* sock, sP_CL2FE_REQ_NANO_TUNE* skill) {
     }
 
 #ifndef ACADEMY
-    if (plr->fusionmatter < (int)MissionManager::AvatarGrowth[plr->level]["m_iReqBlob_NanoTune"]) // sanity check
+    if (plr->fusionmatter < MissionManager::AvatarGrowth[plr->level].reqBlobNanoTune) // sanity check
         return;
 #endif
 
-    plr->fusionmatter -= (int)MissionManager::AvatarGrowth[plr->level]["m_iReqBlob_NanoTune"];
+    plr->fusionmatter -= MissionManager::AvatarGrowth[plr->level].reqBlobNanoTune;
 
     int reqItemCount = NanoTunings[skill->iTuneID].reqItemCount;
     int reqItemID = NanoTunings[skill->iTuneID].reqItems;
     int i = 0;
     while (reqItemCount > 0 && i < 10) {
 
-        sItemBase& item = plr->Inven[skill->aiNeedItemSlotNum[i]];
+        sItemBase& item = plr->cold->Inven[skill->aiNeedItemSlotNum[i]];
         if (item.iType == 7 && item.iID == reqItemID) {
             if (item.iOpt > reqItemCount) {
                 item.iOpt -= reqItemCount;
@@ -413,7 +413,7 @@ void NanoManager::setNanoSkill(CNSocket* sock, sP_CL2FE_REQ_NANO_TUNE* skill) {
     // update items clientside
     for (int i = 0; i < 10; i++) {
         if (skill->aiNeedItemSlotNum[i]) { // non-zero check
-            resp.aItem[i] = plr->Inven[skill->aiNeedItemSlotNum[i]];
+            resp.aItem[i] = plr->cold->Inven[skill->aiNeedItemSlotNum[i]];
             resp.aiItemSlotNum[i] = skill->aiNeedItemSlotNum[i];
         }
     }
@@ -446,9 +446,7 @@ void NanoManager::nanoUnbuff(CNSocket* sock, std::vector<int> targetData, int32_
 
     if (groupPower) {
         plr->iGroupConditionBitFlag &= ~bitFlag;
-        Player *leader = PlayerManager::getPlayerFromID(plr->iIDGroup);
-        if (leader != nullptr)
-            groupFlags = GroupManager::getGroupFlags(leader);
+        groupFlags = GroupManager::getGroupFlags(plr);
     }
 
     for (int i = 0; i < targetData[0]; i++) {
@@ -538,24 +536,25 @@ std::vector<int> NanoManager::findTargets(Player* plr, int skillID, CNPacketData
         tD[0] = 1;
         tD[1] = plr->iID;
     } else if (SkillTable[skillID].targetType == 3) { // entire group as target
-        Player *otherPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
-
-        if (otherPlr == nullptr)
+        if (plr->group == nullptr) { // a group of one
+            tD[0] = 1;
+            tD[1] = plr->iID;
             return tD;
+        }
+
+        std::vector<Player*>& members = plr->group->members;
 
         if (SkillTable[skillID].effectArea == 0) { // for buffs
-            tD[0] = otherPlr->groupCnt;
-            for (int i = 0; i < otherPlr->groupCnt; i++)
-                tD[i+1] = otherPlr->groupIDs[i];
+            tD[0] = members.size();
+            for (size_t i = 0; i < members.size(); i++)
+                tD[i+1] = members[i]->iID;
             return tD;
         }
 
-        for (int i = 0; i < otherPlr->groupCnt; i++) { // group heals have an area limit
-            Player *otherPlr2 = PlayerManager::getPlayerFromID(otherPlr->groupIDs[i]);
-            if (otherPlr2 == nullptr)
-                continue;
+        for (size_t i = 0; i < members.size(); i++) { // group heals have an area limit
+            Player *otherPlr2 = members[i];
             if (true) {//hypot(otherPlr2->x - plr->x, otherPlr2->y - plr->y) < SkillTable[skillID].effectArea) {
-                tD[i+1] = otherPlr->groupIDs[i];
+                tD[i+1] = otherPlr2->iID;
                 tD[0] += 1;
             }
         }
@@ -599,14 +598,7 @@ bool doDebuff(CNSocket *sock, sSkillResult_Buff *respdata, int i, int32_t target
 }
 
 bool doBuff(CNSocket *sock, sSkillResult_Buff *respdata, int i, int32_t targetID, int32_t bitFlag, int16_t timeBuffID, int16_t duration, int16_t amount) {
-    Player *plr = nullptr;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == targetID) {
-            plr = pair.second;
-            break;
-        }
-    }
+    Player *plr = PlayerManager::getPlayerFromID(targetID);
 
     // player not found
     if (plr == nullptr) {
@@ -664,14 +656,7 @@ bool doDamageNDebuff(CNSocket *sock, sSkillResult_Damage_N_Debuff *respdata, int
 }
 
 bool doHeal(CNSocket *sock, sSkillResult_Heal_HP *respdata, int i, int32_t targetID, int32_t bitFlag, int16_t timeBuffID, int16_t duration, int16_t amount) {
-    Player *plr = nullptr;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == targetID) {
-            plr = pair.second;
-            break;
-        }
-    }
+    Player *plr = PlayerManager::getPlayerFromID(targetID);
 
     // player not found
     if (plr == nullptr) {
@@ -767,14 +752,7 @@ bool doLeech(CNSocket *sock, sSkillResult_Heal_HP *healdata, int i, int32_t targ
 }
 
 bool doResurrect(CNSocket *sock, sSkillResult_Resurrect *respdata, int i, int32_t targetID, int32_t bitFlag, int16_t timeBuffID, int16_t duration, int16_t amount) {
-    Player *plr = nullptr;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == targetID) {
-            plr = pair.second;
-            break;
-        }
-    }
+    Player *plr = PlayerManager::getPlayerFromID(targetID);
 
     // player not found
     if (plr == nullptr) {
@@ -790,14 +768,7 @@ bool doResurrect(CNSocket *sock, sSkillResult_Resurrect *respdata, int i, int32_
 }
 
 bool doMove(CNSocket *sock, sSkillResult_Move *respdata, int i, int32_t targetID, int32_t bitFlag, int16_t timeBuffID, int16_t duration, int16_t amount) {
-    Player *plr = nullptr;
-
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->iID == targetID) {
-            plr = pair.second;
-            break;
-        }
-    }
+    Player *plr = PlayerManager::getPlayerFromID(targetID);
 
     // player not found
     if (plr == nullptr) {
@@ -11,65 +11,100 @@
 
 #define PC_MAXHEALTH(level) (925 + 75 * (level))
 
+struct Group;
+
+/*
+ * Owning pointer to a player's cold record. Copies are deep, so Player can
+ * still be passed around by value (CNSharedData, Database::getPlayer() into
+ * a stack Player) without the cold data being shared or leaked.
+ */
+template<typename T>
+class ColdRecord {
+    T* ptr;
+public:
+    ColdRecord() : ptr(new T()) {}
+    ColdRecord(const ColdRecord& other) : ptr(new T(*other.ptr)) {}
+    ColdRecord& operator=(const ColdRecord& other) { *ptr = *other.ptr; return *this; }
+    ~ColdRecord() { delete ptr; }
+
+    T* operator->() const { return ptr; }
+    T& operator*() const { return *ptr; }
+};
+
+/*
+ * Inventory and social state. This is only touched by item, trade, mission,
+ * buddy and DB code, so it lives outside the hot record to keep the tick
+ * loops from dragging several KB of item slots through the cache.
+ */
+struct PlayerCold {
+    sItemBase Equip[AEQUIP_COUNT];
+    sItemBase Inven[AINVEN_COUNT];
+    sItemBase Bank[ABANK_COUNT];
+    sItemBase QInven[AQINVEN_COUNT];
+    sItemTrade Trade[12];
+
+    int64_t aQuestFlag[16];
+
+    int64_t buddyIDs[50];
+    bool isBuddyBlocked[50];
+
+    uint64_t iFirstUseFlag[2];
+};
+
 struct Player {
+    // simulation state read every tick; keep this block together at the front
+    int32_t iID;
+    int x, y, z, angle;
+    uint64_t instanceID;
+    int HP;
+    int level;
+    int8_t iSpecialState;
+    int32_t iConditionBitFlag;
+    bool inCombat;
+    bool onMonkey;
+    int nanoDrainRate;
+    int healCooldown;
+    int pointDamage;
+    int groupDamage;
+    int defense;
+    int activeNano; // active nano (index into Nanos)
+    int equippedNanos[3];
+    int32_t batteryW;
+    int32_t batteryN;
+    time_t lastHeartbeat;
+    ChunkPos chunkPos;
+    std::set<Chunk*>* viewableChunks;
+
     int accountId;
     int accountLevel; // permission level (see CN_ACCOUNT_LEVEL enums)
     int64_t SerialKey;
-    int32_t iID;
     uint64_t FEKey;
 
-    int level;
-    int HP;
     int slot; // player slot, not nano slot
     int16_t mentor;
     int32_t money;
     int32_t fusionmatter;
-    int32_t batteryW;
-    int32_t batteryN;
     sPCStyle PCStyle;
     sPCStyle2 PCStyle2;
     sNano Nanos[NANO_COUNT]; // acquired nanos
-    int equippedNanos[3];
-    int activeNano; // active nano (index into Nanos)
     int8_t iPCState;
     int32_t iWarpLocationFlag;
     int64_t aSkywayLocationFlag[2];
-    int32_t iConditionBitFlag;
     int32_t iSelfConditionBitFlag;
-    int8_t iSpecialState;
 
-    int x, y, z, angle;
     int lastX, lastY, lastZ, lastAngle;
     int recallX, recallY, recallZ, recallInstance; // also Lair entrances
-    uint64_t instanceID;
-    sItemBase Equip[AEQUIP_COUNT];
-    sItemBase Inven[AINVEN_COUNT];
-    sItemBase Bank[ABANK_COUNT];
-    sItemTrade Trade[12];
     int32_t moneyInTrade;
     bool isTrading;
     bool isTradeConfirm;
 
-    bool inCombat;
-    bool onMonkey;
-    int nanoDrainRate;
-    int healCooldown;
-
-    int pointDamage;
-    int groupDamage;
-    int defense;
-
-    int64_t aQuestFlag[16];
     int tasks[ACTIVE_MISSION_COUNT];
     int RemainingNPCCount[ACTIVE_MISSION_COUNT][3];
-    sItemBase QInven[AQINVEN_COUNT];
     int32_t CurrentMissionID;
 
     sTimeLimitItemDeleteInfo2CL toRemoveVehicle;
 
-    int32_t iIDGroup;
-    int groupCnt;
-    int32_t groupIDs[4];
+    Group* group; // nullptr when not in a group
     int32_t iGroupConditionBitFlag;
 
     bool notify;
@@ -77,12 +112,7 @@ struct Player {
     bool unwarpable;
 
     bool buddiesSynced;
-    int64_t buddyIDs[50];
-    bool isBuddyBlocked[50];
-
-    uint64_t iFirstUseFlag[2];
 
-    ChunkPos chunkPos;
-    std::set<Chunk*>* viewableChunks;
-    time_t lastHeartbeat;
+    // inventory, quest flags and buddies
+    ColdRecord<PlayerCold> cold;
 };
@@ -12,6 +12,9 @@
 #include "BuddyManager.hpp"
 #include "MobManager.hpp"
 #include "RacingManager.hpp"
+#include "Rand.hpp"
+#include "SaveQueue.hpp"
+#include "Inbox.hpp"
 
 #include "settings.hpp"
 
@@ -20,9 +23,42 @@
 #include <algorithm>
 #include <vector>
 #include <cmath>
+#include <unordered_map>
+#include <type_traits>
+#include <new>
 
 std::map<CNSocket*, Player*> PlayerManager::players;
 
+/*
+ * Secondary indices over players, so lookups by ID, UID, account or name
+ * don't have to scan every player. Kept in sync by addPlayer() and
+ * removePlayer(); names only change on the login server, while the character
+ * isn't in the shard.
+ */
+static std::unordered_map<int32_t, CNSocket*> playersByID;
+static std::unordered_map<int64_t, CNSocket*> playersByUID;
+static std::unordered_map<int, CNSocket*> playersByAccount;
+static std::unordered_map<std::string, CNSocket*> playersByName;
+
+// names are matched case-insensitively
+static std::string nameKey(std::string firstname, std::string lastname) {
+    std::string key = firstname + " " + lastname;
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return std::tolower(c); });
+    return key;
+}
+
+static std::string nameKey(Player *plr) {
+    return nameKey(U16toU8(plr->PCStyle.szFirstName), U16toU8(plr->PCStyle.szLastName));
+}
+
+// only drop an index entry if it still points at this socket
+template<typename K>
+static void unindex(std::unordered_map<K, CNSocket*>& index, const K& key, CNSocket* sock) {
+    auto it = index.find(key);
+    if (it != index.end() && it->second == sock)
+        index.erase(it);
+}
+
 void PlayerManager::init() {
     // register packet types
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_PC_ENTER, enterPlayer);
@@ -54,12 +90,48 @@ void PlayerManager::init() {
     REGISTER_SHARD_PACKET(P_CL2FE_GM_REQ_TARGET_PC_TELEPORT, teleportPlayer);
 }
 
-void PlayerManager::addPlayer(CNSocket* key, Player plr) {
-    Player *p = new Player();
+/*
+ * Player records are carved out of contiguous blocks instead of being
+ * scattered across the heap, so loops over all players walk through
+ * neighbouring memory. Each record only carries the hot state inline;
+ * its cold half is a separate allocation (see PlayerCold).
+ */
+#define PLAYER_BLOCK_SIZE 64
+
+typedef std::aligned_storage<sizeof(Player), alignof(Player)>::type PlayerStorage;
+static std::vector<PlayerStorage*> playerBlocks;
+static std::vector<Player*> freePlayers;
+
+static Player *allocPlayer(const Player& plr) {
+    if (freePlayers.empty()) {
+        PlayerStorage* block = new PlayerStorage[PLAYER_BLOCK_SIZE];
+        playerBlocks.push_back(block);
+
+        // hand out the block front to back
+        for (int i = PLAYER_BLOCK_SIZE - 1; i >= 0; i--)
+            freePlayers.push_back((Player*)&block[i]);
+    }
 
-    memcpy(p, &plr, sizeof(Player));
+    Player *p = freePlayers.back();
+    freePlayers.pop_back();
+
+    return new (p) Player(plr);
+}
+
+static void freePlayer(Player *plr) {
+    plr->~Player();
+    freePlayers.push_back(plr);
+}
+
+void PlayerManager::addPlayer(CNSocket* key, Player plr) {
+    Player *p = allocPlayer(plr);
 
     players[key] = p;
+    playersByID[p->iID] = key;
+    playersByUID[p->PCStyle.iPC_UID] = key;
+    playersByAccount[p->accountId] = key;
+    playersByName[nameKey(p)] = key;
+
     p->chunkPos = std::make_tuple(0, 0, 0);
     p->viewableChunks = new std::set<Chunk*>();
     p->lastHeartbeat = 0;
@@ -81,7 +153,8 @@ void PlayerManager::removePlayer(CNSocket* key) {
     RacingManager::EPRaces.erase(key);
 
     // save player to DB
-    Database::updatePlayer(plr);
+    SaveQueue::push(plr, true);
+    Inbox::unload(plr->iID);
 
     // remove player visually and untrack
     ChunkManager::removePlayerFromChunks(ChunkManager::getViewableChunks(plr->chunkPos), key);
@@ -89,8 +162,13 @@ void PlayerManager::removePlayer(CNSocket* key) {
 
     std::cout << getPlayerName(plr) << " has left!" << std::endl;
 
+    unindex(playersByID, plr->iID, key);
+    unindex(playersByUID, plr->PCStyle.iPC_UID, key);
+    unindex(playersByAccount, plr->accountId, key);
+    unindex(playersByName, nameKey(plr), key);
+
     delete plr->viewableChunks;
-    delete plr;
+    freePlayer(plr);
     players.erase(key);
 
     // if the player was in a lair, clean it up
@@ -196,8 +274,7 @@ void PlayerManager::enterPlayer(CNSocket* sock, CNPacketData* data) {
     // TODO: check if serialkey exists, if it doesn't send sP_FE2CL_REP_PC_ENTER_FAIL
     Player plr = CNSharedData::getPlayer(enter->iEnterSerialKey);
 
-    plr.groupCnt = 1;
-    plr.iIDGroup = plr.groupIDs[0] = plr.iID;
+    plr.group = nullptr;
 
     DEBUGLOG(
         std::cout << "P_CL2FE_REQ_PC_ENTER:" << std::endl;
@@ -242,12 +319,12 @@ void PlayerManager::enterPlayer(CNSocket* sock, CNPacketData* data) {
     // response.PCLoadData2CL.PCStyle2 = plr.PCStyle2;
     // inventory
     for (int i = 0; i < AEQUIP_COUNT; i++)
-        response.PCLoadData2CL.aEquip[i] = plr.Equip[i];
+        response.PCLoadData2CL.aEquip[i] = plr.cold->Equip[i];
     for (int i = 0; i < AINVEN_COUNT; i++)
-        response.PCLoadData2CL.aInven[i] = plr.Inven[i];
+        response.PCLoadData2CL.aInven[i] = plr.cold->Inven[i];
     // quest inventory
     for (int i = 0; i < AQINVEN_COUNT; i++)
-        response.PCLoadData2CL.aQInven[i] = plr.QInven[i];
+        response.PCLoadData2CL.aQInven[i] = plr.cold->QInven[i];
     // nanos
     for (int i = 1; i < SIZEOF_NANO_BANK_SLOT; i++) {
         response.PCLoadData2CL.aNanoBank[i] = plr.Nanos[i];
@@ -263,7 +340,7 @@ void PlayerManager::enterPlayer(CNSocket* sock, CNPacketData* data) {
         response.PCLoadData2CL.aRunningQuest[i].m_aCurrTaskID = plr.tasks[i];
         TaskData &task = *MissionManager::Tasks[plr.tasks[i]];
         for (int j = 0; j < 3; j++) {
-            response.PCLoadData2CL.aRunningQuest[i].m_aKillNPCID[j] = (int)task["m_iCSUEnemyID"][j];
+            response.PCLoadData2CL.aRunningQuest[i].m_aKillNPCID[j] = task.csuEnemyID[j];
             response.PCLoadData2CL.aRunningQuest[i].m_aKillNPCCount[j] = plr.RemainingNPCCount[i][j];
             /*
              * client doesn't care about NeededItem ID and Count,
@@ -279,7 +356,7 @@ void PlayerManager::enterPlayer(CNSocket* sock, CNPacketData* data) {
     // completed missions
     // the packet requires 32 items, but the client only checks the first 16 (shrug)
     for (int i = 0; i < 16; i++) {
-        response.PCLoadData2CL.aQuestFlag[i] = plr.aQuestFlag[i];
+        response.PCLoadData2CL.aQuestFlag[i] = plr.cold->aQuestFlag[i];
     }
 
     // Computress tips
@@ -288,8 +365,8 @@ void PlayerManager::enterPlayer(CNSocket* sock, CNPacketData* data) {
         response.PCLoadData2CL.iFirstUseFlag2 = UINT64_MAX;
     }
     else {
-        response.PCLoadData2CL.iFirstUseFlag1 = plr.iFirstUseFlag[0];
-        response.PCLoadData2CL.iFirstUseFlag2 = plr.iFirstUseFlag[1];
+        response.PCLoadData2CL.iFirstUseFlag1 = plr.cold->iFirstUseFlag[0];
+        response.PCLoadData2CL.iFirstUseFlag2 = plr.cold->iFirstUseFlag[1];
     }
 
     plr.SerialKey = enter->iEnterSerialKey;
@@ -315,8 +392,16 @@ void PlayerManager::enterPlayer(CNSocket* sock, CNPacketData* data) {
 
     sendNanoBookSubset(sock);
 
-    // initial buddy sync
-    BuddyManager::refreshBuddyList(sock);
+    // initial buddy sync, from what the login server already loaded
+    std::vector<Database::PlayerSummary> buddies = CNSharedData::takeBuddies(enter->iEnterSerialKey);
+    BuddyManager::refreshBuddyList(sock, &buddies);
+
+    // their mail stays in memory until they leave
+    std::vector<Database::EmailData> emails;
+    if (CNSharedData::takeInbox(enter->iEnterSerialKey, &emails))
+        Inbox::load(plr.iID, emails);
+    else
+        Inbox::load(plr.iID);
 
     for (auto& pair : PlayerManager::players)
         if (pair.second->notify)
@@ -832,17 +917,14 @@ void PlayerManager::revivePlayer(CNSocket* sock, CNPacketData* data) {
     resp2.PCRegenDataForOtherPC.iHP = plr->HP;
     resp2.PCRegenDataForOtherPC.iAngle = plr->angle;
 
-    Player *otherPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
-    if (otherPlr != nullptr) {
-        int bitFlag = GroupManager::getGroupFlags(otherPlr);
-        resp2.PCRegenDataForOtherPC.iConditionBitFlag = plr->iConditionBitFlag = plr->iSelfConditionBitFlag | bitFlag;
+    int bitFlag = GroupManager::getGroupFlags(plr);
+    resp2.PCRegenDataForOtherPC.iConditionBitFlag = plr->iConditionBitFlag = plr->iSelfConditionBitFlag | bitFlag;
 
-        resp2.PCRegenDataForOtherPC.iPCState = plr->iPCState;
-        resp2.PCRegenDataForOtherPC.iSpecialState = plr->iSpecialState;
-        resp2.PCRegenDataForOtherPC.Nano = plr->Nanos[plr->activeNano];
+    resp2.PCRegenDataForOtherPC.iPCState = plr->iPCState;
+    resp2.PCRegenDataForOtherPC.iSpecialState = plr->iSpecialState;
+    resp2.PCRegenDataForOtherPC.Nano = plr->Nanos[plr->activeNano];
 
-        sendToViewable(sock, (void*)&resp2, P_FE2CL_PC_REGEN, sizeof(sP_FE2CL_PC_REGEN));
-    }
+    sendToViewable(sock, (void*)&resp2, P_FE2CL_PC_REGEN, sizeof(sP_FE2CL_PC_REGEN));
 
     if (!move)
         return;
@@ -854,9 +936,9 @@ void PlayerManager::revivePlayer(CNSocket* sock, CNPacketData* data) {
 void PlayerManager::enterPlayerVehicle(CNSocket* sock, CNPacketData* data) {
     Player* plr = getPlayer(sock);
 
-    bool expired = plr->Equip[8].iTimeLimit < getTimestamp() && plr->Equip[8].iTimeLimit != 0;
+    bool expired = plr->cold->Equip[8].iTimeLimit < getTimestamp() && plr->cold->Equip[8].iTimeLimit != 0;
 
-    if (plr->Equip[8].iID > 0 && !expired) {
+    if (plr->cold->Equip[8].iID > 0 && !expired) {
         INITSTRUCT(sP_FE2CL_PC_VEHICLE_ON_SUCC, response);
         sock->sendPacket((void*)&response, P_FE2CL_PC_VEHICLE_ON_SUCC, sizeof(sP_FE2CL_PC_VEHICLE_ON_SUCC));
 
@@ -975,9 +1057,9 @@ void PlayerManager::setFirstUseFlag(CNSocket* sock, CNPacketData* data) {
     }
     
     if (flag->iFlagCode <= 64)
-        plr->iFirstUseFlag[0] |= (1ULL << (flag->iFlagCode - 1));
+        plr->cold->iFirstUseFlag[0] |= (1ULL << (flag->iFlagCode - 1));
     else
-        plr->iFirstUseFlag[1] |= (1ULL << (flag->iFlagCode - 65));
+        plr->cold->iFirstUseFlag[1] |= (1ULL << (flag->iFlagCode - 65));
 }
 
 void PlayerManager::setGMSpecialOnOff(CNSocket *sock, CNPacketData *data) {
@@ -1154,16 +1236,18 @@ void PlayerManager::teleportPlayer(CNSocket *sock, CNPacketData *data) {
     case eCN_GM_TeleportMapType__Unstick:
         targetPlr = getPlayer(targetSock);
 
-        sendPlayerTo(targetSock, targetPlr->x - unstickRange/2 + rand() % unstickRange,
-            targetPlr->y - unstickRange/2 + rand() % unstickRange, targetPlr->z + 80);
+        sendPlayerTo(targetSock, targetPlr->x - unstickRange/2 + Rand::next(Rand::MISC, unstickRange),
+            targetPlr->y - unstickRange/2 + Rand::next(Rand::MISC, unstickRange), targetPlr->z + 80);
         break;
     }
 }
 
 #pragma region Helper methods
 Player *PlayerManager::getPlayer(CNSocket* key) {
-    if (players.find(key) != players.end())
-        return players[key];
+    // find() only, so mob AI worker threads can call this safely
+    auto it = players.find(key);
+    if (it != players.end())
+        return it->second;
 
     // this should never happen
     assert(false);
@@ -1202,57 +1286,49 @@ WarpLocation* PlayerManager::getRespawnPoint(Player *plr) {
 }
 
 bool PlayerManager::isAccountInUse(int accountId) {
-    std::map<CNSocket*, Player*>::iterator it;
-    for (it = PlayerManager::players.begin(); it != PlayerManager::players.end(); it++) {
-        if (it->second->accountId == accountId)
-            return true;
-    }
-    return false;
+    return getSockFromAccount(accountId) != nullptr;
 }
 
 void PlayerManager::exitDuplicate(int accountId) {
-    std::map<CNSocket*, Player*>::iterator it;
-
     // disconnect any duplicate players
-    for (it = players.begin(); it != players.end(); it++) {
-        if (it->second->accountId == accountId) {
-            CNSocket* sock = it->first;
+    CNSocket* sock = getSockFromAccount(accountId);
+    if (sock == nullptr)
+        return;
 
-            INITSTRUCT(sP_FE2CL_REP_PC_EXIT_DUPLICATE, resp);
-            resp.iErrorCode = 0;
-            sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_EXIT_DUPLICATE, sizeof(sP_FE2CL_REP_PC_EXIT_DUPLICATE));
+    INITSTRUCT(sP_FE2CL_REP_PC_EXIT_DUPLICATE, resp);
+    resp.iErrorCode = 0;
+    sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_EXIT_DUPLICATE, sizeof(sP_FE2CL_REP_PC_EXIT_DUPLICATE));
 
-            sock->kill();
-            CNShardServer::_killConnection(sock);
-            break;
-        }
-    }
+    sock->kill();
+    CNShardServer::_killConnection(sock);
 }
 
-// TODO: just call getPlayer() after getSockFromID()?
 Player *PlayerManager::getPlayerFromID(int32_t iID) {
-    for (auto& pair : players)
-        if (pair.second->iID == iID)
-            return pair.second;
+    CNSocket* sock = getSockFromID(iID);
+    if (sock == nullptr)
+        return nullptr;
 
-    return nullptr;
+    return players[sock];
 }
 
 CNSocket *PlayerManager::getSockFromID(int32_t iID) {
-    for (auto& pair : players)
-        if (pair.second->iID == iID)
-            return pair.first;
+    auto it = playersByID.find(iID);
+    return it != playersByID.end() ? it->second : nullptr;
+}
 
-    return nullptr;
+CNSocket *PlayerManager::getSockFromUID(int64_t uid) {
+    auto it = playersByUID.find(uid);
+    return it != playersByUID.end() ? it->second : nullptr;
 }
 
-CNSocket *PlayerManager::getSockFromName(std::string firstname, std::string lastname) {
-    for (auto& pair : players)
-        if (U16toU8(pair.second->PCStyle.szFirstName) == firstname
-        && U16toU8(pair.second->PCStyle.szLastName) == lastname)
-            return pair.first;
+CNSocket *PlayerManager::getSockFromAccount(int accountId) {
+    auto it = playersByAccount.find(accountId);
+    return it != playersByAccount.end() ? it->second : nullptr;
+}
 
-    return nullptr;
+CNSocket *PlayerManager::getSockFromName(std::string firstname, std::string lastname) {
+    auto it = playersByName.find(nameKey(firstname, lastname));
+    return it != playersByName.end() ? it->second : nullptr;
 }
 
 CNSocket *PlayerManager::getSockFromAny(int by, int id, int uid, std::string firstname, std::string lastname) {
@@ -1262,9 +1338,7 @@ CNSocket *PlayerManager::getSockFromAny(int by, int id, int uid, std::string fir
         return getSockFromID(id);
     case eCN_GM_TargetSearchBy__PC_UID: // account id; not player id
         assert(uid != 0);
-        for (auto& pair : players)
-            if (pair.second->accountId == uid)
-                return pair.first;
+        return getSockFromAccount(uid);
     case eCN_GM_TargetSearchBy__PC_Name:
         assert(firstname != "" && lastname != ""); // XXX: remove this if we start messing around with edited names?
         return getSockFromName(firstname, lastname);
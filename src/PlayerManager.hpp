@@ -9,6 +9,7 @@
 #include <utility>
 #include <map>
 #include <list>
+#include <string>
 
 struct WarpLocation;
 
@@ -67,6 +68,8 @@ namespace PlayerManager {
     Player *getPlayerFromID(int32_t iID);
     CNSocket *getSockFromID(int32_t iID);
     CNSocket *getSockFromName(std::string firstname, std::string lastname);
+    CNSocket *getSockFromUID(int64_t uid);
+    CNSocket *getSockFromAccount(int accountId);
     CNSocket *getSockFromAny(int by, int id, int uid, std::string firstname, std::string lastname);
 
     void sendNanoBookSubset(CNSocket *sock);
@@ -0,0 +1,254 @@
+#include "PlayerSnapshot.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+static const uint32_t MAGIC = 0x53504F46; // "FOPS" in memory order: Fusion player snapshot
+
+template<typename T>
+static void put(std::vector<uint8_t>& out, const T& val) {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots only hold plain data");
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    memcpy(out.data() + at, &val, sizeof(T));
+}
+
+struct Reader {
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool ok;
+
+    template<typename T>
+    bool get(T& val) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshots only hold plain data");
+        if (!ok || (size_t)(end - pos) < sizeof(T))
+            return ok = false;
+        memcpy(&val, pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    // reads a sparse-section header and checks it against the array it fills
+    bool count(uint16_t& n, size_t limit) {
+        return get(n) && (n <= limit || (ok = false));
+    }
+};
+
+// occupied slots only, as (slot, item) pairs
+static void putItems(std::vector<uint8_t>& out, const sItemBase* items, int size) {
+    uint16_t n = 0;
+    for (int i = 0; i < size; i++)
+        if (items[i].iID != 0)
+            n++;
+
+    put(out, n);
+    for (int i = 0; i < size; i++) {
+        if (items[i].iID == 0)
+            continue;
+        put(out, (uint16_t)i);
+        put(out, items[i]);
+    }
+}
+
+static bool getItems(Reader& in, sItemBase* items, int size) {
+    uint16_t n, slot;
+    if (!in.count(n, size))
+        return false;
+
+    for (int i = 0; i < n; i++) {
+        if (!in.get(slot) || slot >= size)
+            return in.ok = false;
+        if (!in.get(items[slot]))
+            return false;
+    }
+    return true;
+}
+
+void PlayerSnapshot::serialize(const Player* plr, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(512);
+
+    put(out, MAGIC);
+    put(out, VERSION);
+
+    // identity and appearance
+    put(out, plr->iID);
+    put(out, plr->accountId);
+    put(out, plr->accountLevel);
+    put(out, plr->slot);
+    put(out, plr->SerialKey);
+    put(out, plr->FEKey);
+    put(out, plr->PCStyle);
+    put(out, plr->PCStyle2);
+
+    // stats
+    put(out, plr->level);
+    put(out, plr->HP);
+    put(out, plr->money);
+    put(out, plr->fusionmatter);
+    put(out, plr->mentor);
+    put(out, plr->batteryW);
+    put(out, plr->batteryN);
+    put(out, plr->equippedNanos);
+
+    // position, including where to put them back after an instance
+    put(out, plr->x);
+    put(out, plr->y);
+    put(out, plr->z);
+    put(out, plr->angle);
+    put(out, plr->instanceID);
+    put(out, plr->lastX);
+    put(out, plr->lastY);
+    put(out, plr->lastZ);
+    put(out, plr->lastAngle);
+    put(out, plr->recallX);
+    put(out, plr->recallY);
+    put(out, plr->recallZ);
+    put(out, plr->recallInstance);
+
+    // flags
+    put(out, plr->iWarpLocationFlag);
+    put(out, plr->aSkywayLocationFlag);
+    put(out, plr->CurrentMissionID);
+    put(out, plr->cold->aQuestFlag);
+    put(out, plr->cold->iFirstUseFlag);
+    put(out, plr->toRemoveVehicle);
+
+    // running quests
+    uint16_t n = 0;
+    for (int i = 0; i < ACTIVE_MISSION_COUNT; i++)
+        if (plr->tasks[i] != 0)
+            n++;
+    put(out, n);
+    for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
+        if (plr->tasks[i] == 0)
+            continue;
+        put(out, (uint16_t)i);
+        put(out, plr->tasks[i]);
+        put(out, plr->RemainingNPCCount[i]);
+    }
+
+    putItems(out, plr->cold->Equip, AEQUIP_COUNT);
+    putItems(out, plr->cold->Inven, AINVEN_COUNT);
+    putItems(out, plr->cold->Bank, ABANK_COUNT);
+    putItems(out, plr->cold->QInven, AQINVEN_COUNT);
+
+    // nanos, indexed by nano ID
+    n = 0;
+    for (int i = 0; i < NANO_COUNT; i++)
+        if (plr->Nanos[i].iID != 0)
+            n++;
+    put(out, n);
+    for (int i = 0; i < NANO_COUNT; i++) {
+        if (plr->Nanos[i].iID == 0)
+            continue;
+        put(out, (uint16_t)i);
+        put(out, plr->Nanos[i]);
+    }
+
+    // buddies and blocks
+    n = 0;
+    for (int i = 0; i < 50; i++)
+        if (plr->cold->buddyIDs[i] != 0)
+            n++;
+    put(out, n);
+    for (int i = 0; i < 50; i++) {
+        if (plr->cold->buddyIDs[i] == 0)
+            continue;
+        put(out, (uint16_t)i);
+        put(out, plr->cold->buddyIDs[i]);
+        put(out, plr->cold->isBuddyBlocked[i]);
+    }
+}
+
+std::vector<uint8_t> PlayerSnapshot::serialize(const Player* plr) {
+    std::vector<uint8_t> out;
+    serialize(plr, out);
+    return out;
+}
+
+bool PlayerSnapshot::deserialize(const uint8_t* data, size_t len, Player* plr) {
+    Reader in = {data, data + len, true};
+    uint32_t magic;
+    uint16_t version;
+
+    if (!in.get(magic) || magic != MAGIC || !in.get(version) || version > VERSION)
+        return false;
+
+    *plr = Player();
+
+    in.get(plr->iID);
+    in.get(plr->accountId);
+    in.get(plr->accountLevel);
+    in.get(plr->slot);
+    in.get(plr->SerialKey);
+    in.get(plr->FEKey);
+    in.get(plr->PCStyle);
+    in.get(plr->PCStyle2);
+
+    in.get(plr->level);
+    in.get(plr->HP);
+    in.get(plr->money);
+    in.get(plr->fusionmatter);
+    in.get(plr->mentor);
+    in.get(plr->batteryW);
+    in.get(plr->batteryN);
+    in.get(plr->equippedNanos);
+
+    in.get(plr->x);
+    in.get(plr->y);
+    in.get(plr->z);
+    in.get(plr->angle);
+    in.get(plr->instanceID);
+    in.get(plr->lastX);
+    in.get(plr->lastY);
+    in.get(plr->lastZ);
+    in.get(plr->lastAngle);
+    in.get(plr->recallX);
+    in.get(plr->recallY);
+    in.get(plr->recallZ);
+    in.get(plr->recallInstance);
+
+    in.get(plr->iWarpLocationFlag);
+    in.get(plr->aSkywayLocationFlag);
+    in.get(plr->CurrentMissionID);
+    in.get(plr->cold->aQuestFlag);
+    in.get(plr->cold->iFirstUseFlag);
+    in.get(plr->toRemoveVehicle);
+
+    uint16_t n, slot;
+    if (!in.count(n, ACTIVE_MISSION_COUNT))
+        return false;
+    for (int i = 0; i < n; i++) {
+        if (!in.get(slot) || slot >= ACTIVE_MISSION_COUNT)
+            return false;
+        in.get(plr->tasks[slot]);
+        in.get(plr->RemainingNPCCount[slot]);
+    }
+
+    if (!getItems(in, plr->cold->Equip, AEQUIP_COUNT)
+        || !getItems(in, plr->cold->Inven, AINVEN_COUNT)
+        || !getItems(in, plr->cold->Bank, ABANK_COUNT)
+        || !getItems(in, plr->cold->QInven, AQINVEN_COUNT))
+        return false;
+
+    if (!in.count(n, NANO_COUNT))
+        return false;
+    for (int i = 0; i < n; i++) {
+        if (!in.get(slot) || slot >= NANO_COUNT)
+            return false;
+        in.get(plr->Nanos[slot]);
+    }
+
+    if (!in.count(n, 50))
+        return false;
+    for (int i = 0; i < n; i++) {
+        if (!in.get(slot) || slot >= 50)
+            return false;
+        in.get(plr->cold->buddyIDs[slot]);
+        in.get(plr->cold->isBuddyBlocked[slot]);
+    }
+
+    // anything left over means we misread the layout
+    return in.ok && in.pos == in.end;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Player.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Compact, versioned binary form of a Player.
+ *
+ * Only what outlives a session is written: identity, appearance, stats,
+ * position, flags, running quests, items, nanos and buddies, plus the expired
+ * vehicle the loader picked out for deletion on entry. Runtime state
+ * (chunks, group, trade, combat, buffs) isn't, and comes back zeroed. Empty
+ * item, nano, quest and buddy slots are left out, so a typical character is a
+ * small fraction of sizeof(Player) + sizeof(PlayerCold).
+ *
+ * Records are self-contained byte strings, meant to be stored as-is in a DB
+ * blob, appended to a journal or passed between servers. Integers are in host
+ * byte order; every server we ship runs little-endian.
+ */
+namespace PlayerSnapshot {
+    // bump when the layout changes; older readers reject newer records
+    const uint16_t VERSION = 1;
+
+    void serialize(const Player* plr, std::vector<uint8_t>& out);
+    std::vector<uint8_t> serialize(const Player* plr);
+
+    // false if the record is truncated, corrupt or from a newer version; plr is then left half-filled
+    bool deserialize(const uint8_t* data, size_t len, Player* plr);
+}
@@ -7,10 +7,33 @@
 #include "Database.hpp"
 #include "NPCManager.hpp"
 
+#include <functional>
+#include <set>
+#include <unordered_map>
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.mutex.h"
+#else
+    #include <mutex>
+#endif
+
 std::map<int32_t, EPInfo> RacingManager::EPData;
 std::map<CNSocket*, EPRace> RacingManager::EPRaces;
 std::map<int32_t, std::pair<std::vector<int>, std::vector<int>>> RacingManager::EPRewards;
 
+/*
+ * Each player's best result on one EPID. RaceResults keeps every run, but
+ * nothing ever looks past a player's best, so that's all we hold on to.
+ * order has the same entries sorted best first, so the leaders are its front.
+ */
+struct Leaderboard {
+    std::unordered_map<int, Database::RaceRanking> best; // by PlayerID
+    std::set<std::pair<int, int>, std::greater<std::pair<int, int>>> order; // (Score, PlayerID)
+};
+
+static std::unordered_map<int, Leaderboard> leaderboards; // by EPID
+static std::mutex leaderboardLock; // characters are deleted from the login server's thread
+
 void RacingManager::init() {
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_EP_RACE_START, racingStart);
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_EP_GET_RING, racingGetPod);
@@ -18,6 +41,73 @@ void RacingManager::init() {
     REGISTER_SHARD_PACKET(P_CL2FE_REQ_EP_RACE_END, racingEnd);
 }
 
+// caller holds leaderboardLock
+static void updateBest(const Database::RaceRanking& ranking) {
+    Leaderboard& board = leaderboards[ranking.EPID];
+
+    auto it = board.best.find(ranking.PlayerID);
+    if (it != board.best.end()) {
+        if (ranking.Score <= it->second.Score)
+            return; // the first run to reach a score keeps it
+        board.order.erase({it->second.Score, ranking.PlayerID});
+    }
+
+    board.best[ranking.PlayerID] = ranking;
+    board.order.insert({ranking.Score, ranking.PlayerID});
+}
+
+void RacingManager::loadRankings() {
+    std::vector<Database::RaceRanking> bests = Database::getRaceBests();
+
+    std::lock_guard<std::mutex> lock(leaderboardLock);
+    leaderboards.clear();
+    for (const Database::RaceRanking& ranking : bests)
+        updateBest(ranking);
+
+    std::cout << "[INFO] Loaded " << bests.size() << " race rankings over " << leaderboards.size() << " racing IZs" << std::endl;
+}
+
+void RacingManager::postRanking(const Database::RaceRanking& ranking) {
+    // the sqlite backend queues this for its I/O thread, so it doesn't hold up the race
+    Database::postRaceRanking(ranking);
+
+    std::lock_guard<std::mutex> lock(leaderboardLock);
+    updateBest(ranking);
+}
+
+Database::RaceRanking RacingManager::getBestRanking(int epID, int playerID) {
+    std::lock_guard<std::mutex> lock(leaderboardLock);
+
+    Database::RaceRanking ranking = {};
+    auto board = leaderboards.find(epID);
+    if (board == leaderboards.end())
+        return ranking; // this race hasn't been run before, so return a blank ranking
+
+    if (playerID > -1) {
+        auto it = board->second.best.find(playerID);
+        if (it != board->second.best.end())
+            ranking = it->second;
+    } else if (!board->second.order.empty()) {
+        ranking = board->second.best[board->second.order.begin()->second];
+    }
+
+    return ranking;
+}
+
+void RacingManager::forgetPlayer(int playerID) {
+    std::lock_guard<std::mutex> lock(leaderboardLock);
+
+    // their RaceResults rows go with the character
+    for (auto& pair : leaderboards) {
+        Leaderboard& board = pair.second;
+        auto it = board.best.find(playerID);
+        if (it == board.best.end())
+            continue;
+        board.order.erase({it->second.Score, playerID});
+        board.best.erase(it);
+    }
+}
+
 void RacingManager::racingStart(CNSocket* sock, CNPacketData* data) {
     if (data->size != sizeof(sP_CL2FE_REQ_EP_RACE_START))
         return; // malformed packet
@@ -107,10 +197,10 @@ void RacingManager::racingEnd(CNSocket* sock, CNPacketData* data) {
     postRanking.Score = score;
     postRanking.Time = timeDiff;
     postRanking.Timestamp = getTimestamp();
-    Database::postRaceRanking(postRanking);
+    RacingManager::postRanking(postRanking);
 
     // ...then we get the top ranking, which may or may not be what we just submitted
-    Database::RaceRanking topRankingPlayer = Database::getTopRaceRanking(EPData[mapNum].EPID, plr->iID);
+    Database::RaceRanking topRankingPlayer = getBestRanking(EPData[mapNum].EPID, plr->iID);
 
     INITSTRUCT(sP_FE2CL_REP_EP_RACE_END_SUCC, resp);
 
@@ -158,7 +248,7 @@ void RacingManager::racingEnd(CNSocket* sock, CNPacketData* data) {
 
     if (reward.iSlotNum > -1 && reward.sItem.iID != 0) {
         resp.RewardItem = reward;
-        plr->Inven[reward.iSlotNum] = item;
+        plr->cold->Inven[reward.iSlotNum] = item;
     }
 
     EPRaces.erase(sock);
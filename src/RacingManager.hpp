@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CNShardServer.hpp"
+#include "Database.hpp"
 
 struct EPInfo {
     int zoneX, zoneY, EPID, maxScore, maxTime;
@@ -17,6 +18,14 @@ namespace RacingManager {
     extern std::map<int32_t, std::pair<std::vector<int>, std::vector<int>>> EPRewards;
 
     void init();
+    // fills the leaderboards from the database; call after it's open
+    void loadRankings();
+
+    // records a finished race, in memory now and in the database behind it
+    void postRanking(const Database::RaceRanking& ranking);
+    // a player's best on the EPID, or anyone's best if playerID is -1; blank if there's none
+    Database::RaceRanking getBestRanking(int epID, int playerID);
+    void forgetPlayer(int playerID);
 
     void racingStart(CNSocket* sock, CNPacketData* data);
     void racingGetPod(CNSocket* sock, CNPacketData* data);
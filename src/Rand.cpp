@@ -0,0 +1,109 @@
+#include "Rand.hpp"
+
+#include <atomic>
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// splitmix64, the recommended way to expand one seed into xoshiro state
+static uint64_t splitmix(uint64_t& x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+Xoshiro256::Xoshiro256(uint64_t seed) {
+    for (int i = 0; i < 4; i++)
+        s[i] = splitmix(seed);
+}
+
+uint64_t Xoshiro256::next() {
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+static uint64_t baseSeed = 0;
+static std::atomic<uint64_t> seedGeneration{0};
+static std::atomic<uint32_t> threadCount{0};
+
+namespace {
+    struct ThreadStreams {
+        uint32_t thread = threadCount++;
+        uint64_t generation = ~0ULL;
+        Xoshiro256 streams[Rand::STREAM_COUNT];
+    };
+}
+
+static thread_local ThreadStreams local;
+
+/*
+ * Streams are (re)seeded lazily, from the base seed mixed with the thread and
+ * stream numbers, the first time a thread rolls after init().
+ */
+static Xoshiro256& stream(Rand::Stream s) {
+    uint64_t gen = seedGeneration.load(std::memory_order_acquire);
+    if (local.generation != gen) {
+        for (int i = 0; i < Rand::STREAM_COUNT; i++) {
+            uint64_t x = baseSeed ^ ((uint64_t)local.thread << 32) ^ (uint64_t)i;
+            local.streams[i] = Xoshiro256(splitmix(x));
+        }
+        local.generation = gen;
+    }
+
+    return local.streams[s];
+}
+
+void Rand::init(uint64_t seed) {
+    baseSeed = seed;
+    seedGeneration.fetch_add(1, std::memory_order_release);
+}
+
+int32_t Rand::next(Stream s, int32_t bound) {
+    // multiply-shift instead of modulo; no division and no modulo bias worth mentioning
+    uint64_t x = stream(s).next() >> 32;
+    return (int32_t)((x * (uint64_t)bound) >> 32);
+}
+
+int32_t Rand::next(Stream s) {
+    return (int32_t)(stream(s).next() >> 33);
+}
+
+float Rand::nextFloat(Stream s) {
+    // top 24 bits fill a float mantissa exactly
+    return (stream(s).next() >> 40) * (1.0f / (1 << 24));
+}
+
+void Rand::fill(Stream s, int32_t* out, size_t count) {
+    Xoshiro256& gen = stream(s);
+    for (size_t i = 0; i < count; i++)
+        out[i] = (int32_t)(gen.next() >> 33);
+}
+
+int Rand::weighted(Stream s, const int32_t* weights, size_t count) {
+    int64_t total = 0;
+    for (size_t i = 0; i < count; i++)
+        total += weights[i];
+
+    if (total <= 0)
+        return -1;
+
+    int64_t roll = (int64_t)((stream(s).next() >> 32) * (uint64_t)total >> 32);
+    for (size_t i = 0; i < count; i++) {
+        roll -= weights[i];
+        if (roll < 0)
+            return (int)i;
+    }
+
+    return (int)count - 1;
+}
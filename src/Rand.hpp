@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * xoshiro256** generator; small, fast and good enough for anything the game rolls.
+ * Not thread-safe on its own, which is the point: every thread gets its own.
+ */
+class Xoshiro256 {
+public:
+    explicit Xoshiro256(uint64_t seed = 0);
+
+    uint64_t next();
+
+private:
+    uint64_t s[4];
+};
+
+/*
+ * Game-wide random numbers, replacing rand()/srand().
+ *
+ * Each subsystem draws from its own stream, and each thread has its own copy of
+ * every stream, so rolling never takes a lock and one subsystem's rolls don't
+ * shift another's. With a fixed seed (randseed in config.ini) the shard thread's
+ * streams come out the same on every run, which makes benchmarks and replays
+ * repeatable; worker threads are numbered in the order they first roll.
+ */
+namespace Rand {
+    enum Stream {
+        AI,      // mob movement and skill choices
+        COMBAT,  // damage spread, crits
+        LOOT,    // drops, crates, croc pot
+        MISC,    // everything else
+        STREAM_COUNT
+    };
+
+    void init(uint64_t seed);
+
+    // uniform in [0, bound); bound must be positive
+    int32_t next(Stream stream, int32_t bound);
+    // uniform in [0, INT32_MAX], a drop-in for rand()
+    int32_t next(Stream stream);
+    // uniform in [0, 1)
+    float nextFloat(Stream stream);
+
+    // fills out with rand()-style rolls in one go, for loot tables that need several at once
+    void fill(Stream stream, int32_t* out, size_t count);
+    // picks an index with probability proportional to its weight; -1 if all weights are 0
+    int weighted(Stream stream, const int32_t* weights, size_t count);
+}
@@ -0,0 +1,2256 @@
+#include "SQLiteStorage.hpp"
+#include "CNProtocol.hpp"
+#include "CNStructs.hpp"
+#include "settings.hpp"
+#include "Player.hpp"
+#include "MissionManager.hpp"
+
+#include "contrib/JSON.hpp"
+#include "contrib/bcrypt/BCrypt.hpp"
+
+#include <string>
+#include <sqlite3.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+
+void SQLiteStorage::connect(Connection& conn, int flags) {
+    // every connection has a lock of its own, so SQLite's would be redundant
+    int rc = sqlite3_open_v2(settings::DBPATH.c_str(), &conn.db, flags | SQLITE_OPEN_NOMUTEX, NULL);
+    if (rc != SQLITE_OK) {
+        std::cout << "[FATAL] Cannot open database: " << sqlite3_errmsg(conn.db) << std::endl;
+        exit(1);
+    }
+
+    // foreign keys in sqlite are off by default; enable them
+    sqlite3_exec(conn.db, "PRAGMA foreign_keys=ON;", NULL, NULL, NULL);
+
+    // just in case a DB operation collides with an external manual modification
+    sqlite3_busy_timeout(conn.db, 2000);
+
+    std::string sql = "PRAGMA synchronous=" + settings::DBSYNCHRONOUS + ";";
+    sqlite3_exec(conn.db, sql.c_str(), NULL, NULL, NULL);
+}
+
+void SQLiteStorage::disconnect(Connection& conn) {
+    std::lock_guard<std::mutex> lock(conn.lock);
+
+    finalizeStatements(conn);
+    sqlite3_close(conn.db);
+    conn.db = nullptr;
+}
+
+SQLiteStorage::Connection& SQLiteStorage::reader() {
+    waitForQueued();
+
+    std::lock_guard<std::mutex> lock(readersLock);
+    std::unique_ptr<Connection>& conn = readers[std::this_thread::get_id()];
+    if (conn == nullptr) {
+        conn.reset(new Connection());
+        conn->cacheStatements = cacheStatements;
+        connect(*conn, SQLITE_OPEN_READONLY);
+    }
+    return *conn;
+}
+
+SQLiteStorage::Connection& SQLiteStorage::writer() {
+    waitForQueued();
+    return writeConn;
+}
+
+sqlite3_stmt* SQLiteStorage::prepare(Connection& c, const char* sql) {
+    if (c.cacheStatements) {
+        auto it = c.statements.find(sql);
+        if (it != c.statements.end()) {
+            sqlite3_reset(it->second);
+            return it->second;
+        }
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(c.db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        std::cout << "[WARN] Database: failed to prepare statement: " << sqlite3_errmsg(c.db) << std::endl;
+        return stmt;
+    }
+
+    if (c.cacheStatements)
+        c.statements[sql] = stmt;
+    return stmt;
+}
+
+void SQLiteStorage::release(Connection& c, sqlite3_stmt* stmt) {
+    if (stmt == nullptr)
+        return; // failed to prepare
+
+    if (!c.cacheStatements) {
+        sqlite3_finalize(stmt);
+        return;
+    }
+
+    // ends any read still in progress and drops bound pointers into the caller's locals
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+void SQLiteStorage::finalizeStatements(Connection& c) {
+    for (auto& pair : c.statements)
+        sqlite3_finalize(pair.second);
+    c.statements.clear();
+}
+
+void SQLiteStorage::open() {
+    connect(writeConn, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+
+    // readers and the writer stop getting in each other's way
+    sqlite3_stmt* stmt;
+    sqlite3_prepare_v2(writeConn.db, "PRAGMA journal_mode=WAL;", -1, &stmt, NULL);
+    if (sqlite3_step(stmt) != SQLITE_ROW || strcmp((const char*)sqlite3_column_text(stmt, 0), "wal") != 0)
+        std::cout << "[WARN] Database: couldn't switch to WAL mode, reads will wait for writes" << std::endl;
+    sqlite3_finalize(stmt);
+
+    checkMetaTable();
+    createTables();
+
+    // taking checkpoints off the commit path
+    if (settings::DBCHECKPOINTPAGES > 0) {
+        connect(checkpointConn, SQLITE_OPEN_READWRITE);
+        sqlite3_wal_hook(writeConn.db, walHook, this);
+    }
+
+    std::cout << "[INFO] Database in operation ";
+    int accounts = getTableSize("Accounts");
+    int players = getTableSize("Players");
+    std::string message = "";
+    if (accounts > 0) {
+        message += ": Found " + std::to_string(accounts) + " Account";
+        if (accounts > 1)
+            message += "s";
+    }
+    if (players > 0) {
+        message += " and " + std::to_string(players) + " Player Character";
+        if (players > 1)
+            message += "s";
+    }
+    std::cout << message << std::endl;
+
+    stopping = false;
+    ioThread = std::thread(&SQLiteStorage::ioLoop, this);
+}
+
+void SQLiteStorage::close() {
+    {
+        std::lock_guard<std::mutex> lock(jobLock);
+        stopping = true;
+        jobCv.notify_all();
+    }
+
+    // whatever was queued still gets written
+    if (ioThread.joinable())
+        ioThread.join();
+
+    if (groups > 0)
+        std::cout << "[INFO] Database: " << groupedWrites << " small writes in " << groups << " group commits" << std::endl;
+
+    {
+        std::lock_guard<std::mutex> lock(readersLock);
+        for (auto& pair : readers)
+            disconnect(*pair.second);
+        readers.clear();
+    }
+
+    if (checkpointConn.db != nullptr)
+        disconnect(checkpointConn);
+
+    // fold the WAL back into the database file, so it's whole on its own again
+    std::lock_guard<std::mutex> lock(writeConn.lock);
+    sqlite3_wal_checkpoint_v2(writeConn.db, NULL, SQLITE_CHECKPOINT_TRUNCATE, NULL, NULL);
+    finalizeStatements(writeConn);
+    sqlite3_close(writeConn.db);
+    writeConn.db = nullptr;
+}
+
+void SQLiteStorage::setStatementCache(bool enabled) {
+    std::lock_guard<std::mutex> lock(readersLock);
+
+    std::vector<Connection*> all = {&writeConn};
+    for (auto& pair : readers)
+        all.push_back(pair.second.get());
+
+    // a statement is in use only while its connection is locked, so none is
+    // released under a different setting than it was prepared with
+    for (Connection* conn : all) {
+        std::lock_guard<std::mutex> connLock(conn->lock);
+        finalizeStatements(*conn);
+        conn->cacheStatements = enabled;
+    }
+    cacheStatements = enabled;
+}
+
+void SQLiteStorage::submit(std::function<void()> job) {
+    std::unique_lock<std::mutex> lock(jobLock);
+
+    // nobody left to run it
+    if (!ioThread.joinable() || stopping) {
+        lock.unlock();
+        job();
+        return;
+    }
+
+    jobs.push_back({[job]() { job(); return true; }, false, ++queuedSeq, nullptr});
+    jobCv.notify_one();
+}
+
+bool SQLiteStorage::queueWrite(std::function<bool()> fn, bool wait) {
+    std::unique_lock<std::mutex> lock(jobLock);
+
+    // no I/O thread to hand it to, or this is it; write it now, in a transaction of its own
+    if (!ioThread.joinable() || stopping || std::this_thread::get_id() == ioThread.get_id()) {
+        lock.unlock();
+
+        std::lock_guard<std::mutex> writeLock(writeConn.lock);
+        sqlite3_exec(writeConn.db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+        bool ok = fn();
+        sqlite3_exec(writeConn.db, ok ? "COMMIT;" : "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        return ok;
+    }
+
+    bool result = true;
+    jobs.push_back({std::move(fn), true, ++queuedSeq, wait ? &result : nullptr});
+    lastWrite = queuedSeq;
+    jobCv.notify_one();
+
+    if (wait) {
+        uint64_t seq = queuedSeq;
+        doneCv.wait(lock, [this, seq] { return doneSeq >= seq; });
+    }
+    return result;
+}
+
+void SQLiteStorage::waitForQueued() {
+    // the I/O thread runs its queue in order; there's nothing to wait for
+    if (std::this_thread::get_id() == ioThread.get_id())
+        return;
+
+    // whoever queued them, so a login on one thread sees what was done on another
+    std::unique_lock<std::mutex> lock(jobLock);
+    uint64_t seq = lastWrite;
+    doneCv.wait(lock, [this, seq] { return doneSeq >= seq; });
+}
+
+void SQLiteStorage::runGroup(std::vector<Job>& group) {
+    std::lock_guard<std::mutex> lock(writeConn.lock);
+    std::vector<char> ok(group.size());
+
+    sqlite3_exec(writeConn.db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+    // a savepoint per write, so one that fails doesn't take the rest with it
+    for (size_t i = 0; i < group.size(); i++) {
+        sqlite3_exec(writeConn.db, "SAVEPOINT write;", NULL, NULL, NULL);
+
+        ok[i] = group[i].fn();
+        if (!ok[i])
+            sqlite3_exec(writeConn.db, "ROLLBACK TO write;", NULL, NULL, NULL);
+
+        sqlite3_exec(writeConn.db, "RELEASE write;", NULL, NULL, NULL);
+    }
+
+    if (sqlite3_exec(writeConn.db, "COMMIT;", NULL, NULL, NULL) != SQLITE_OK) {
+        std::cout << "[WARN] Database: Failed to commit queued writes: " << sqlite3_errmsg(writeConn.db) << std::endl;
+        sqlite3_exec(writeConn.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        std::fill(ok.begin(), ok.end(), false);
+    }
+
+    // read once ioLoop() marks the group done, under jobLock
+    for (size_t i = 0; i < group.size(); i++)
+        if (group[i].result != nullptr)
+            *group[i].result = ok[i];
+
+    groups++;
+    groupedWrites += group.size();
+}
+
+int SQLiteStorage::walHook(void* arg, sqlite3* db, const char* name, int pages) {
+    SQLiteStorage* storage = (SQLiteStorage*)arg;
+
+    // runs on whoever committed; just let the I/O thread know
+    std::lock_guard<std::mutex> lock(storage->jobLock);
+    storage->walPages = pages;
+    if (storage->checkpointDue())
+        storage->jobCv.notify_one();
+    return SQLITE_OK;
+}
+
+bool SQLiteStorage::checkpointDue() {
+    return settings::DBCHECKPOINTPAGES > 0 && walPages >= settings::DBCHECKPOINTPAGES;
+}
+
+void SQLiteStorage::checkpoint() {
+    std::lock_guard<std::mutex> lock(checkpointConn.lock);
+
+    // PASSIVE never waits; pages still in use by a reader are left for the next one
+    int logPages = 0, copied = 0;
+    if (sqlite3_wal_checkpoint_v2(checkpointConn.db, NULL, SQLITE_CHECKPOINT_PASSIVE, &logPages, &copied) != SQLITE_OK)
+        std::cout << "[WARN] Database: checkpoint failed: " << sqlite3_errmsg(checkpointConn.db) << std::endl;
+
+    // the next commit reports how big the WAL really is
+    walPages = 0;
+}
+
+void SQLiteStorage::ioLoop() {
+    // writes that queue up while a group is being committed go into the next one
+    const size_t GROUP_MAX = 256;
+
+    std::vector<Job> group;
+    std::unique_lock<std::mutex> lock(jobLock);
+
+    while (true) {
+        jobCv.wait(lock, [this] { return stopping || !jobs.empty() || checkpointDue(); });
+
+        if (!jobs.empty() && jobs.front().write) {
+            while (!jobs.empty() && jobs.front().write && group.size() < GROUP_MAX) {
+                group.push_back(std::move(jobs.front()));
+                jobs.pop_front();
+            }
+
+            lock.unlock();
+            runGroup(group);
+            lock.lock();
+
+            doneSeq = group.back().seq;
+            group.clear();
+            doneCv.notify_all();
+        } else if (!jobs.empty()) {
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+
+            lock.unlock();
+            job.fn();
+            lock.lock();
+
+            doneSeq = job.seq;
+            doneCv.notify_all();
+        } else if (checkpointDue()) {
+            lock.unlock();
+            checkpoint();
+            lock.lock();
+        } else {
+            break; // stopping, and nothing left to do
+        }
+    }
+}
+
+void SQLiteStorage::checkMetaTable() {
+    // first check if meta table exists
+    const char* sql = R"(
+        SELECT COUNT(*) FROM sqlite_master WHERE type='table' AND name='Meta';
+        )";
+    sqlite3_stmt* stmt;
+    sqlite3_prepare_v2(writeConn.db, sql, -1, &stmt, NULL);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        std::cout << "[FATAL] Failed to check meta table" << sqlite3_errmsg(writeConn.db) << std::endl;
+        sqlite3_finalize(stmt);
+        exit(1);
+    }
+
+    int count = sqlite3_column_int(stmt, 0);
+    if (count == 0) {
+        sqlite3_finalize(stmt);
+        // check if there's other non-internal tables first
+        sql = R"(
+            SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name NOT LIKE 'sqlite_%';
+            )";
+        sqlite3_prepare_v2(writeConn.db, sql, -1, &stmt, NULL);
+        if (sqlite3_step(stmt) != SQLITE_ROW || sqlite3_column_int(stmt, 0) != 0) {
+            sqlite3_finalize(stmt);
+            std::cout << "[FATAL] Existing DB is outdated" << std::endl;
+            exit(1);
+        }
+
+        // create meta table
+        sqlite3_finalize(stmt);
+        return createMetaTable();
+    }
+
+    sqlite3_finalize(stmt);
+
+    // check protocol version
+    sql = R"(
+        SELECT Value FROM Meta WHERE Key = 'ProtocolVersion';
+        )";
+    sqlite3_prepare_v2(writeConn.db, sql, -1, &stmt, NULL);
+
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        std::cout << "[FATAL] Failed to check DB Protocol Version: " << sqlite3_errmsg(writeConn.db) << std::endl;
+        sqlite3_finalize(stmt);
+        exit(1);
+    }
+
+    if (sqlite3_column_int(stmt, 0) != PROTOCOL_VERSION) {
+        sqlite3_finalize(stmt);
+        std::cout << "[FATAL] DB Protocol Version doesn't match Server Build" << std::endl;
+        exit(1);
+    }
+
+    sqlite3_finalize(stmt);
+
+    sql = R"(
+        SELECT Value FROM Meta WHERE Key = 'DatabaseVersion';
+        )";
+    sqlite3_prepare_v2(writeConn.db, sql, -1, &stmt, NULL);
+
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        std::cout << "[FATAL] Failed to check DB Version: " << sqlite3_errmsg(writeConn.db) << std::endl;
+        sqlite3_finalize(stmt);
+        exit(1);
+    }
+
+    int dbVersion = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+
+    if (dbVersion > DATABASE_VERSION) {
+        std::cout << "[FATAL] Server Build is incompatible with DB Version" << std::endl;
+        exit(1);
+    } else if (dbVersion < DATABASE_VERSION) {
+        // we're gonna migrate; back up the DB
+        std::cout << "[INFO] Backing up database" << std::endl;
+        // copy db file over using binary streams
+        std::ifstream  src(settings::DBPATH, std::ios::binary);
+        std::ofstream  dst(settings::DBPATH + ".old." + std::to_string(dbVersion), std::ios::binary);
+        dst << src.rdbuf();
+        src.close();
+        dst.close();
+    }
+
+    while (dbVersion != DATABASE_VERSION) {
+        // db migrations
+        std::cout << "[INFO] Migrating Database to Version " << dbVersion + 1 << std::endl;
+
+        std::string path = "sql/migration" + std::to_string(dbVersion) + ".sql";
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            std::cout << "[FATAL] Failed to migrate database: Couldn't open migration file" << std::endl;
+            exit(1);
+        }
+
+        std::ostringstream stream;
+        stream << file.rdbuf();
+        std::string sql = stream.str();
+        int rc = sqlite3_exec(writeConn.db, sql.c_str(), NULL, NULL, NULL);
+
+        if (rc != SQLITE_OK) {
+            std::cout << "[FATAL] Failed to migrate database: " << sqlite3_errmsg(writeConn.db) << std::endl;
+            exit(1);
+        }
+
+        dbVersion++;
+        std::cout << "[INFO] Successful Database Migration to Version " << dbVersion << std::endl;
+    }    
+}
+
+void SQLiteStorage::createMetaTable() {
+    std::lock_guard<std::mutex> lock(writeConn.lock);
+
+    sqlite3_exec(writeConn.db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+    const char* sql = R"(
+        CREATE TABLE Meta(
+            Key TEXT NOT NULL UNIQUE,
+            Value INTEGER NOT NULL
+        );
+        )";
+    sqlite3_stmt* stmt;
+    sqlite3_prepare_v2(writeConn.db, sql, -1, &stmt, NULL);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        std::cout << "[FATAL] Failed to create meta table: " << sqlite3_errmsg(writeConn.db) << std::endl;
+        sqlite3_finalize(stmt);
+        sqlite3_exec(writeConn.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        exit(1);
+    }
+    sqlite3_finalize(stmt);
+
+    sql = R"(
+        INSERT INTO Meta (Key, Value)
+        VALUES (?, ?);
+        )";
+    sqlite3_prepare_v2(writeConn.db, sql, -1, &stmt, NULL);
+    sqlite3_bind_text(stmt, 1, "ProtocolVersion", -1, NULL);
+    sqlite3_bind_int(stmt, 2, PROTOCOL_VERSION);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        std::cout << "[FATAL] Failed to create meta table: " << sqlite3_errmsg(writeConn.db) << std::endl;
+        sqlite3_finalize(stmt);
+        sqlite3_exec(writeConn.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        exit(1);
+    }
+
+    sqlite3_reset(stmt);
+    sqlite3_bind_text(stmt, 1, "DatabaseVersion", -1, NULL);
+    sqlite3_bind_int(stmt, 2, DATABASE_VERSION);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        std::cout << "[FATAL] Failed to create meta table: " << sqlite3_errmsg(writeConn.db) << std::endl;
+        sqlite3_exec(writeConn.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        exit(1);
+    }
+
+    sqlite3_exec(writeConn.db, "COMMIT;", NULL, NULL, NULL);
+    std::cout << "[INFO] Created new meta table" << std::endl;
+}
+
+void SQLiteStorage::createTables() {
+    std::ifstream file("sql/tables.sql");
+    if (!file.is_open()) {
+        std::cout << "[FATAL] Failed to open database scheme" << std::endl;
+        exit(1);
+    }
+
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    std::string read = stream.str();
+    const char* sql = read.c_str();
+
+    char* errMsg = 0;
+    int rc = sqlite3_exec(writeConn.db, sql, NULL, NULL, &errMsg);
+    if (rc != SQLITE_OK) {
+        std::cout << "[FATAL] Database failed to create tables: " << errMsg << std::endl;
+        exit(1);
+    }
+}
+
+int SQLiteStorage::getTableSize(std::string tableName) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    // table names can't be bound as parameters; this is only ever called with our own
+    std::string sql = "SELECT COUNT(*) FROM " + tableName + ";";
+    sqlite3_stmt* stmt;
+    stmt = prepare(c, sql.c_str());
+    sqlite3_step(stmt);
+    int result = sqlite3_column_int(stmt, 0);
+    release(c, stmt);
+    return result;
+}
+
+void SQLiteStorage::findAccount(Account* account, std::string login) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        SELECT AccountID, Password, Selected, BannedUntil, BanReason
+        FROM Accounts
+        WHERE Login = ?
+        LIMIT 1;
+        )";
+    sqlite3_stmt* stmt;
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_text(stmt, 1, login.c_str(), -1, NULL);
+
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        account->AccountID = sqlite3_column_int(stmt, 0);
+        account->Password = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+        account->Selected = sqlite3_column_int(stmt, 2);
+        account->BannedUntil = sqlite3_column_int64(stmt, 3);
+        account->BanReason = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+    }
+    release(c, stmt);
+}
+
+int SQLiteStorage::addAccount(std::string login, std::string password) {
+    Connection& c = writer();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        INSERT INTO Accounts (Login, Password, AccountLevel)
+        VALUES (?, ?, ?);
+        )";
+    sqlite3_stmt* stmt;
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_text(stmt, 1, login.c_str(), -1, NULL);
+    std::string hashedPassword = BCrypt::generateHash(password);
+    sqlite3_bind_text(stmt, 2, hashedPassword.c_str(), -1, NULL);
+    sqlite3_bind_int(stmt, 3, settings::ACCLEVEL);
+
+    int rc = sqlite3_step(stmt);
+    release(c, stmt);
+    if (rc != SQLITE_DONE) {
+        std::cout << "[WARN] Database: failed to add new account" << std::endl;
+        return 0;
+    }
+
+    return sqlite3_last_insert_rowid(c.db);
+}
+
+void SQLiteStorage::banAccount(int accountId, int days) {
+    Connection& c = writer();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        UPDATE Accounts SET
+            BannedSince = (strftime('%s', 'now')),
+            BannedUntil = (strftime('%s', 'now')) + ?
+        WHERE AccountID = ?;
+        )";
+    sqlite3_stmt* stmt;
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, days * 86400); // convert days to seconds
+    sqlite3_bind_int(stmt, 2, accountId);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        std::cout << "[WARN] Database: failed to ban player: " << sqlite3_errmsg(c.db) << std::endl;
+    }
+    release(c, stmt);
+}
+
+void SQLiteStorage::updateSelected(int accountId, int slot) {
+    if (slot < 1 || slot > 4) {
+        std::cout << "[WARN] Invalid slot number passed to updateSelected()! " << std::endl;
+        return;
+    }
+
+    queueWrite([this, accountId, slot]() {
+        Connection& c = writeConn;
+        const char* sql = R"(
+            UPDATE Accounts SET
+                Selected = ?,
+                LastLogin = (strftime('%s', 'now'))
+            WHERE AccountID = ?;
+            )";
+
+        sqlite3_stmt* stmt;
+
+        stmt = prepare(c, sql);
+        sqlite3_bind_int(stmt, 1, slot);
+        sqlite3_bind_int(stmt, 2, accountId);
+        int rc = sqlite3_step(stmt);
+        release(c, stmt);
+
+        if (rc != SQLITE_DONE)
+            std::cout << "[WARN] Database fail on updateSelected(): " << sqlite3_errmsg(c.db) << std::endl;
+        return rc == SQLITE_DONE;
+    });
+}
+
+bool SQLiteStorage::validateCharacter(int characterID, int userID) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    // query whatever
+    const char* sql = R"(
+        SELECT PlayerID
+        FROM Players
+        WHERE PlayerID = ? AND AccountID = ?
+        LIMIT 1;
+        )";
+    sqlite3_stmt* stmt;
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, characterID);
+    sqlite3_bind_int(stmt, 2, userID);
+    int rc = sqlite3_step(stmt);
+    // if we got a row back, the character is valid
+    bool result = (rc == SQLITE_ROW);
+    release(c, stmt);
+    return result;
+}
+
+bool SQLiteStorage::isNameFree(std::string firstName, std::string lastName) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        SELECT COUNT(*)
+        FROM Players
+        WHERE FirstName = ? AND LastName = ?
+        LIMIT 1;
+        )";
+    sqlite3_stmt* stmt;
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_text(stmt, 1, firstName.c_str(), -1, NULL);
+    sqlite3_bind_text(stmt, 2, lastName.c_str(),  -1, NULL);
+    int rc = sqlite3_step(stmt);
+
+    bool result = (rc == SQLITE_ROW && sqlite3_column_int(stmt, 0) == 0);
+    release(c, stmt);
+    return result;
+}
+
+bool SQLiteStorage::isSlotFree(int accountId, int slotNum) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    if (slotNum < 1 || slotNum > 4) {
+        std::cout << "[WARN] Invalid slot number passed to isSlotFree()! " << slotNum << std::endl;
+        return false;
+    }
+
+    const char* sql = R"(
+        SELECT COUNT(*)
+        FROM Players
+        WHERE AccountID = ? AND Slot = ?
+        LIMIT 1;
+        )";
+    sqlite3_stmt* stmt;
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, accountId);
+    sqlite3_bind_int(stmt, 2, slotNum);
+    int rc = sqlite3_step(stmt);
+
+    bool result = (rc == SQLITE_ROW && sqlite3_column_int(stmt, 0) == 0);
+    release(c, stmt);
+    return result;
+}
+
+int SQLiteStorage::createCharacter(sP_CL2LS_REQ_SAVE_CHAR_NAME* save, int AccountID) {
+    Connection& c = writer();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    sqlite3_exec(c.db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+    const char* sql = R"(
+        INSERT INTO Players
+            (AccountID, Slot, FirstName, LastName,
+             XCoordinates, YCoordinates, ZCoordinates, Angle,
+             HP, NameCheck, Quests, SkywayLocationFlag, FirstUseFlag)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+        )";
+    sqlite3_stmt* stmt;
+    std::string firstName = U16toU8(save->szFirstName);
+    std::string lastName =  U16toU8(save->szLastName);
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, AccountID);
+    sqlite3_bind_int(stmt, 2, save->iSlotNum);
+    sqlite3_bind_text(stmt, 3, firstName.c_str(), -1, NULL);
+    sqlite3_bind_text(stmt, 4, lastName.c_str(), -1, NULL);
+    sqlite3_bind_int(stmt, 5, settings::SPAWN_X);
+    sqlite3_bind_int(stmt, 6, settings::SPAWN_Y);
+    sqlite3_bind_int(stmt, 7, settings::SPAWN_Z);
+    sqlite3_bind_int(stmt, 8, settings::SPAWN_ANGLE);
+    sqlite3_bind_int(stmt, 9, PC_MAXHEALTH(1));
+
+    // if FNCode isn't 0, it's a wheel name
+    int nameCheck = (settings::APPROVEALLNAMES || save->iFNCode) ? 1 : 0;
+    sqlite3_bind_int(stmt, 10, nameCheck);
+
+    // blobs
+    unsigned char blobBuffer[sizeof(PlayerCold::aQuestFlag)] = { 0 };
+    sqlite3_bind_blob(stmt, 11, blobBuffer, sizeof(PlayerCold::aQuestFlag), NULL);
+    sqlite3_bind_blob(stmt, 12, blobBuffer, sizeof(Player::aSkywayLocationFlag), NULL);
+    sqlite3_bind_blob(stmt, 13, blobBuffer, sizeof(PlayerCold::iFirstUseFlag), NULL);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        release(c, stmt);
+        sqlite3_exec(c.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        return 0;
+    }
+
+    int playerId = sqlite3_last_insert_rowid(c.db);
+
+    release(c, stmt);
+
+    sql = R"(
+        INSERT INTO Appearances (PlayerID)
+        VALUES (?);
+        )";
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, playerId);
+
+    int rc = sqlite3_step(stmt);
+    release(c, stmt);
+    if (rc != SQLITE_DONE) {
+        sqlite3_exec(c.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        return 0;
+    }
+
+    sqlite3_exec(c.db, "COMMIT;", NULL, NULL, NULL);
+    return playerId;
+}
+
+bool SQLiteStorage::finishCharacter(sP_CL2LS_REQ_CHAR_CREATE* character, int accountId) {
+    Connection& c = writer();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    sqlite3_exec(c.db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+    const char* sql = R"(
+        UPDATE Players
+        SET AppearanceFlag = 1
+        WHERE PlayerID = ? AND AccountID = ? AND AppearanceFlag = 0;
+        )";
+    sqlite3_stmt* stmt;
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, character->PCStyle.iPC_UID);
+    sqlite3_bind_int(stmt, 2, accountId);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        release(c, stmt);
+        sqlite3_exec(c.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        return false;
+    }
+
+    release(c, stmt);
+
+    sql = R"(
+        UPDATE Appearances
+        SET
+            Body = ?,
+            EyeColor = ?,
+            FaceStyle = ?,
+            Gender = ?,
+            HairColor = ?,
+            HairStyle = ?,
+            Height = ?,
+            SkinColor = ?
+        WHERE PlayerID = ?;
+        )";
+    stmt = prepare(c, sql);
+
+    sqlite3_bind_int(stmt, 1, character->PCStyle.iBody);
+    sqlite3_bind_int(stmt, 2, character->PCStyle.iEyeColor);
+    sqlite3_bind_int(stmt, 3, character->PCStyle.iFaceStyle);
+    sqlite3_bind_int(stmt, 4, character->PCStyle.iGender);
+    sqlite3_bind_int(stmt, 5, character->PCStyle.iHairColor);
+    sqlite3_bind_int(stmt, 6, character->PCStyle.iHairStyle);
+    sqlite3_bind_int(stmt, 7, character->PCStyle.iHeight);
+    sqlite3_bind_int(stmt, 8, character->PCStyle.iSkinColor);
+    sqlite3_bind_int(stmt, 9, character->PCStyle.iPC_UID);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        release(c, stmt);
+        sqlite3_exec(c.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        return false;
+    }
+
+    release(c, stmt);
+
+    sql = R"(
+        INSERT INTO Inventory (PlayerID, Slot, ID, Type, Opt)
+        VALUES (?, ?, ?, ?, 1);
+        )";
+    stmt = prepare(c, sql);
+
+    int items[3] = { character->sOn_Item.iEquipUBID, character->sOn_Item.iEquipLBID, character->sOn_Item.iEquipFootID };
+    for (int i = 0; i < 3; i++) {
+        sqlite3_bind_int(stmt, 1, character->PCStyle.iPC_UID);
+        sqlite3_bind_int(stmt, 2, i+1);
+        sqlite3_bind_int(stmt, 3, items[i]);
+        sqlite3_bind_int(stmt, 4, i+1);
+
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            release(c, stmt);
+            sqlite3_exec(c.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+            return false;
+        }
+        sqlite3_reset(stmt);
+    }
+
+    release(c, stmt);
+    sqlite3_exec(c.db, "COMMIT;", NULL, NULL, NULL);
+    return true;
+}
+
+bool SQLiteStorage::finishTutorial(int playerID, int accountID) {
+    Connection& c = writer();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    sqlite3_exec(c.db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+    const char* sql = R"(
+        UPDATE Players SET
+            TutorialFlag = 1,
+            Nano1 = ?,
+            Quests = ?
+        WHERE PlayerID = ? AND AccountID = ? AND TutorialFlag = 0;
+        )";
+    sqlite3_stmt* stmt;
+    stmt = prepare(c, sql);
+
+    unsigned char questBuffer[128] = { 0 };
+
+#ifndef ACADEMY
+    // save missions nr 1 & 2; equip Buttercup
+    questBuffer[0] = 3;
+    sqlite3_bind_int(stmt, 1, 1);
+#else
+    // no, none of that
+    sqlite3_bind_int(stmt, 1, 0);
+#endif
+
+    sqlite3_bind_blob(stmt, 2, questBuffer, sizeof(questBuffer), NULL);
+    sqlite3_bind_int(stmt, 3, playerID);
+    sqlite3_bind_int(stmt, 4, accountID);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        release(c, stmt);
+        sqlite3_exec(c.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        return false;
+    }
+
+    release(c, stmt);
+
+#ifndef ACADEMY
+    // Lightning Gun
+    sql = R"(
+        INSERT INTO Inventory
+            (PlayerID, Slot, ID, Type, Opt)
+        VALUES (?, 0, 328, 0, 1);
+        )";
+    stmt = prepare(c, sql);
+
+    sqlite3_bind_int(stmt, 1, playerID);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        release(c, stmt);
+        sqlite3_exec(c.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        return false;
+    }
+
+    release(c, stmt);
+
+    // Nano Buttercup
+    sql = R"(
+        INSERT INTO Nanos
+            (PlayerID, ID, Skill)
+        VALUES (?, 1, 1);
+        )";
+    stmt = prepare(c, sql);
+
+    sqlite3_bind_int(stmt, 1, playerID);
+
+    int rc = sqlite3_step(stmt);
+    release(c, stmt);
+
+    if (rc != SQLITE_DONE) {
+        sqlite3_exec(c.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        return false;
+    }
+#endif
+
+    sqlite3_exec(c.db, "COMMIT;", NULL, NULL, NULL);
+    return true;
+}
+
+int SQLiteStorage::deleteCharacter(int characterID, int userID) {
+    Connection& c = writer();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        SELECT Slot
+        FROM Players
+        WHERE AccountID = ? AND PlayerID = ?
+        LIMIT 1;
+        )";
+
+    sqlite3_stmt* stmt;
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, userID);
+    sqlite3_bind_int(stmt, 2, characterID);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        release(c, stmt);
+        return 0;
+    }
+    int slot = sqlite3_column_int(stmt, 0);
+
+    release(c, stmt);
+
+    sql = R"(
+        DELETE FROM Players
+        WHERE AccountID = ? AND PlayerID = ?;
+        )";
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, userID);
+    sqlite3_bind_int(stmt, 2, characterID);
+    int rc = sqlite3_step(stmt);
+    release(c, stmt);
+
+    if (rc != SQLITE_DONE)
+        return 0;
+
+    return slot;
+}
+
+void SQLiteStorage::getCharInfo(std::vector <sP_LS2CL_REP_CHAR_INFO>* result, int userID) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        SELECT
+            p.PlayerID, p.Slot, p.FirstName, p.LastName, p.Level, p.AppearanceFlag, p.TutorialFlag, p.PayZoneFlag,
+            p.XCoordinates, p.YCoordinates, p.ZCoordinates, p.NameCheck,
+            a.Body, a.EyeColor, a.FaceStyle, a.Gender, a.HairColor, a.HairStyle, a.Height, a.SkinColor
+        FROM Players as p
+        INNER JOIN Appearances as a ON p.PlayerID = a.PlayerID
+        WHERE p.AccountID = ?;
+        )";
+    sqlite3_stmt* stmt;
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, userID);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        sP_LS2CL_REP_CHAR_INFO toAdd = {};
+        toAdd.sPC_Style.iPC_UID = sqlite3_column_int(stmt, 0);
+        toAdd.iSlot = sqlite3_column_int(stmt, 1);
+
+        // parsing const unsigned char* to char16_t
+        std::string placeHolder = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
+        U8toU16(placeHolder, toAdd.sPC_Style.szFirstName, sizeof(toAdd.sPC_Style.szFirstName));
+        placeHolder = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
+        U8toU16(placeHolder, toAdd.sPC_Style.szLastName, sizeof(toAdd.sPC_Style.szLastName));
+
+        toAdd.iLevel = sqlite3_column_int(stmt, 4);
+        toAdd.sPC_Style2.iAppearanceFlag = sqlite3_column_int(stmt, 5);
+        toAdd.sPC_Style2.iTutorialFlag = sqlite3_column_int(stmt, 6);
+        toAdd.sPC_Style2.iPayzoneFlag = sqlite3_column_int(stmt, 7);
+        toAdd.iX = sqlite3_column_int(stmt, 8);
+        toAdd.iY = sqlite3_column_int(stmt, 9);
+        toAdd.iZ = sqlite3_column_int(stmt, 10);
+        toAdd.sPC_Style.iNameCheck = sqlite3_column_int(stmt, 11);
+        toAdd.sPC_Style.iBody = sqlite3_column_int(stmt, 12);
+        toAdd.sPC_Style.iEyeColor = sqlite3_column_int(stmt, 13);
+        toAdd.sPC_Style.iFaceStyle = sqlite3_column_int(stmt, 14);
+        toAdd.sPC_Style.iGender = sqlite3_column_int(stmt, 15);
+        toAdd.sPC_Style.iHairColor = sqlite3_column_int(stmt, 16);
+        toAdd.sPC_Style.iHairStyle = sqlite3_column_int(stmt, 17);
+        toAdd.sPC_Style.iHeight = sqlite3_column_int(stmt, 18);
+        toAdd.sPC_Style.iSkinColor = sqlite3_column_int(stmt, 19);
+
+        // request aEquip
+        const char* sql2 = R"(
+            SELECT Slot, Type, ID, Opt, TimeLimit
+            FROM Inventory
+            WHERE PlayerID = ? AND Slot < ?;
+            )";
+        sqlite3_stmt* stmt2;
+
+        stmt2 = prepare(c, sql2);
+        sqlite3_bind_int(stmt2, 1, toAdd.sPC_Style.iPC_UID);
+        sqlite3_bind_int(stmt2, 2, AEQUIP_COUNT);
+
+        while (sqlite3_step(stmt2) == SQLITE_ROW) {
+            sItemBase* item = &toAdd.aEquip[sqlite3_column_int(stmt2, 0)];
+            item->iType = sqlite3_column_int(stmt2, 1);
+            item->iID = sqlite3_column_int(stmt2, 2);
+            item->iOpt = sqlite3_column_int(stmt2, 3);
+            item->iTimeLimit = sqlite3_column_int(stmt2, 4);
+        }
+        release(c, stmt2);
+
+        result->push_back(toAdd);
+    }
+    release(c, stmt);
+}
+
+// NOTE: This is currently never called.
+void SQLiteStorage::evaluateCustomName(int characterID, CustomName decision) {
+    Connection& c = writer();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        UPDATE Players
+        SET NameCheck = ?
+        WHERE PlayerID = ?;
+        )";
+    sqlite3_stmt* stmt;
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, int(decision));
+    sqlite3_bind_int(stmt, 2, characterID);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE)
+        std::cout << "[WARN] Database: Failed to update nameCheck: " << sqlite3_errmsg(c.db) << std::endl;
+    release(c, stmt);
+}
+
+bool SQLiteStorage::changeName(sP_CL2LS_REQ_CHANGE_CHAR_NAME* save, int accountId) {
+    Connection& c = writer();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        UPDATE Players
+        SET
+            FirstName = ?,
+            LastName = ?,
+            NameCheck = ?
+        WHERE PlayerID = ? AND AccountID = ?;
+        )";
+    sqlite3_stmt* stmt;
+    stmt = prepare(c, sql);
+
+    std::string firstName = U16toU8(save->szFirstName);
+    std::string lastName = U16toU8(save->szLastName);
+
+    sqlite3_bind_text(stmt, 1, firstName.c_str(), -1, NULL);
+    sqlite3_bind_text(stmt, 2, lastName.c_str(), -1, NULL);
+    // if FNCode isn't 0, it's a wheel name
+    int nameCheck = (settings::APPROVEALLNAMES || save->iFNCode) ? 1 : 0;
+    sqlite3_bind_int(stmt, 3, nameCheck);
+    sqlite3_bind_int(stmt, 4, save->iPCUID);
+    sqlite3_bind_int(stmt, 5, accountId);
+
+    int rc = sqlite3_step(stmt);
+    release(c, stmt);
+    return rc == SQLITE_DONE;
+}
+
+// the body of getPlayer(); the caller holds c.lock and an open read transaction
+void SQLiteStorage::loadPlayer(Connection& c, Player* plr, int id) {
+    const char* sql = R"(
+        SELECT
+            p.AccountID, p.Slot, p.FirstName, p.LastName,
+            p.Level, p.Nano1, p.Nano2, p.Nano3,
+            p.AppearanceFlag, p.TutorialFlag, p.PayZoneFlag,
+            p.XCoordinates, p.YCoordinates, p.ZCoordinates, p.NameCheck,
+            p.Angle, p.HP, acc.AccountLevel, p.FusionMatter, p.Taros, p.Quests,
+            p.BatteryW, p.BatteryN, p.Mentor, p.WarpLocationFlag,
+            p.SkywayLocationFlag, p.CurrentMissionID, p.FirstUseFlag,
+            a.Body, a.EyeColor, a.FaceStyle, a.Gender, a.HairColor, a.HairStyle, a.Height, a.SkinColor
+        FROM Players as p
+        INNER JOIN Appearances as a ON p.PlayerID = a.PlayerID
+        INNER JOIN Accounts as acc ON p.AccountID = acc.AccountID
+        WHERE p.PlayerID = ?;
+        )";
+    sqlite3_stmt* stmt;
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, id);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        release(c, stmt);
+        std::cout << "[WARN] Database: Failed to load character [" << id << "]: " << sqlite3_errmsg(c.db) << std::endl;
+        return;
+    }
+
+    plr->iID = id;
+    plr->PCStyle.iPC_UID = id;
+
+    plr->accountId = sqlite3_column_int(stmt, 0);
+    plr->slot = sqlite3_column_int(stmt, 1);
+
+    // parsing const unsigned char* to char16_t
+    std::string placeHolder = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
+    U8toU16(placeHolder, plr->PCStyle.szFirstName, sizeof(plr->PCStyle.szFirstName));
+    placeHolder = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
+    U8toU16(placeHolder, plr->PCStyle.szLastName, sizeof(plr->PCStyle.szLastName));
+
+    plr->level = sqlite3_column_int(stmt, 4);
+    plr->equippedNanos[0] = sqlite3_column_int(stmt, 5);
+    plr->equippedNanos[1] = sqlite3_column_int(stmt, 6);
+    plr->equippedNanos[2] = sqlite3_column_int(stmt, 7);
+
+    plr->PCStyle2.iAppearanceFlag = sqlite3_column_int(stmt, 8);
+    plr->PCStyle2.iTutorialFlag = sqlite3_column_int(stmt, 9);
+    plr->PCStyle2.iPayzoneFlag = sqlite3_column_int(stmt, 10);
+
+    plr->x = sqlite3_column_int(stmt, 11);
+    plr->y = sqlite3_column_int(stmt, 12);
+    plr->z = sqlite3_column_int(stmt, 13);
+    plr->PCStyle.iNameCheck = sqlite3_column_int(stmt, 14);
+
+    plr->angle = sqlite3_column_int(stmt, 15);
+    plr->HP = sqlite3_column_int(stmt, 16);
+    plr->accountLevel = sqlite3_column_int(stmt, 17);
+    plr->fusionmatter = sqlite3_column_int(stmt, 18);
+    plr->money = sqlite3_column_int(stmt, 19);
+
+    memcpy(plr->cold->aQuestFlag, sqlite3_column_blob(stmt, 20), sizeof(plr->cold->aQuestFlag));
+
+    plr->batteryW = sqlite3_column_int(stmt, 21);
+    plr->batteryN = sqlite3_column_int(stmt, 22);
+    plr->mentor = sqlite3_column_int(stmt, 23);
+    plr->iWarpLocationFlag = sqlite3_column_int(stmt, 24);
+
+    memcpy(plr->aSkywayLocationFlag, sqlite3_column_blob(stmt, 25), sizeof(plr->aSkywayLocationFlag));
+
+    plr->CurrentMissionID = sqlite3_column_int(stmt, 26);
+
+    memcpy(plr->cold->iFirstUseFlag, sqlite3_column_blob(stmt, 27), sizeof(plr->cold->iFirstUseFlag));
+
+    plr->PCStyle.iBody = sqlite3_column_int(stmt, 28);
+    plr->PCStyle.iEyeColor = sqlite3_column_int(stmt, 29);
+    plr->PCStyle.iFaceStyle = sqlite3_column_int(stmt, 30);
+    plr->PCStyle.iGender = sqlite3_column_int(stmt, 31);
+    plr->PCStyle.iHairColor = sqlite3_column_int(stmt, 32);
+    plr->PCStyle.iHairStyle = sqlite3_column_int(stmt, 33);
+    plr->PCStyle.iHeight = sqlite3_column_int(stmt, 34);
+    plr->PCStyle.iSkinColor = sqlite3_column_int(stmt, 35);
+
+    release(c, stmt);
+
+    // get inventory
+    sql = R"(
+        SELECT Slot, Type, ID, Opt, TimeLimit
+        FROM Inventory
+        WHERE PlayerID = ?;
+        )";
+
+    stmt = prepare(c, sql);
+
+    sqlite3_bind_int(stmt, 1, id);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int slot = sqlite3_column_int(stmt, 0);
+
+        // for extra safety
+        if (slot > AEQUIP_COUNT + AINVEN_COUNT + ABANK_COUNT) {
+            std::cout << "[WARN] Database: Invalid item slot in db?! " << std::endl;
+            continue;
+        }
+
+        sItemBase* item;
+        if (slot < AEQUIP_COUNT) {
+            // equipment
+            item = &plr->cold->Equip[slot];
+        } else if (slot < (AEQUIP_COUNT + AINVEN_COUNT)) {
+            // inventory
+            item = &plr->cold->Inven[slot - AEQUIP_COUNT];
+        } else {
+            // bank
+            item = &plr->cold->Bank[slot - AEQUIP_COUNT - AINVEN_COUNT];
+        }
+
+        item->iType = sqlite3_column_int(stmt, 1);
+        item->iID = sqlite3_column_int(stmt, 2);
+        item->iOpt = sqlite3_column_int(stmt, 3);
+        item->iTimeLimit = sqlite3_column_int(stmt, 4);
+    }
+
+    release(c, stmt);
+
+    Database::removeExpiredVehicles(plr);
+
+    // get quest inventory
+    sql = R"(
+        SELECT Slot, ID, Opt
+        FROM QuestItems
+        WHERE PlayerID = ?;
+        )";
+
+    stmt = prepare(c, sql);
+
+    sqlite3_bind_int(stmt, 1, id);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int slot = sqlite3_column_int(stmt, 0);
+
+        sItemBase* item = &plr->cold->QInven[slot];
+        item->iType = 8;
+        item->iID = sqlite3_column_int(stmt, 1);
+        item->iOpt = sqlite3_column_int(stmt, 2);
+    }
+
+    release(c, stmt);
+
+    // get nanos
+    sql = R"(
+        SELECT ID, Skill, Stamina
+        FROM Nanos
+        WHERE PlayerID = ?;
+        )";
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, id);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+
+        // for extra safety
+        if (id > NANO_COUNT)
+            continue;
+
+        sNano* nano = &plr->Nanos[id];
+        nano->iID = id;
+        nano->iSkillID = sqlite3_column_int(stmt, 1);
+        nano->iStamina = sqlite3_column_int(stmt, 2);
+    }
+
+    release(c, stmt);
+
+    // get active quests
+    sql = R"(
+        SELECT
+            TaskID,
+            RemainingNPCCount1,
+            RemainingNPCCount2,
+            RemainingNPCCount3
+        FROM RunningQuests
+        WHERE PlayerID = ?;
+        )";
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, id);
+
+    std::set<int> tasksSet; // used to prevent duplicate tasks from loading in
+    for (int i = 0; sqlite3_step(stmt) == SQLITE_ROW && i < ACTIVE_MISSION_COUNT; i++) {
+
+        int taskID = sqlite3_column_int(stmt, 0);
+        if (tasksSet.find(taskID) != tasksSet.end())
+            continue;
+
+        plr->tasks[i] = taskID;
+        tasksSet.insert(taskID);
+        plr->RemainingNPCCount[i][0] = sqlite3_column_int(stmt, 1);
+        plr->RemainingNPCCount[i][1] = sqlite3_column_int(stmt, 2);
+        plr->RemainingNPCCount[i][2] = sqlite3_column_int(stmt, 3);
+    }
+
+    release(c, stmt);
+
+    // get buddies
+    sql = R"(
+        SELECT PlayerAID, PlayerBID
+        FROM Buddyships
+        WHERE PlayerAID = ? OR PlayerBID = ?;
+        )";
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, id);
+    sqlite3_bind_int(stmt, 2, id);
+
+    int i = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW && i < 50) {
+        int PlayerAId = sqlite3_column_int(stmt, 0);
+        int PlayerBId = sqlite3_column_int(stmt, 1);
+
+        plr->cold->buddyIDs[i] = id == PlayerAId ? PlayerBId : PlayerAId;
+        plr->cold->isBuddyBlocked[i] = false;
+        i++;
+    }
+
+    release(c, stmt);
+
+    // get blocked players
+    sql = R"(
+        SELECT BlockedPlayerID FROM Blocks
+        WHERE PlayerID = ?;
+        )";
+
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, id);
+
+    // i retains its value from after the loop over Buddyships
+    while (sqlite3_step(stmt) == SQLITE_ROW && i < 50) {
+        plr->cold->buddyIDs[i] = sqlite3_column_int(stmt, 0);
+        plr->cold->isBuddyBlocked[i] = true;
+        i++;
+    }
+
+    release(c, stmt);
+}
+
+void SQLiteStorage::getPlayer(Player* plr, int id) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    // one transaction for all the tables, so a save can't land halfway through the load
+    sqlite3_exec(c.db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+    loadPlayer(c, plr, id);
+    sqlite3_exec(c.db, "COMMIT;", NULL, NULL, NULL);
+}
+
+std::vector<Database::PlayerSummary> SQLiteStorage::getPlayerSummaries(const std::vector<int>& ids) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+    std::vector<PlayerSummary> result;
+
+    // one query per chunk of IDs; buddy lists never get near the limit, but SQLite has one
+    const size_t CHUNK = 50;
+    for (size_t start = 0; start < ids.size(); start += CHUNK) {
+        size_t count = std::min(CHUNK, ids.size() - start);
+
+        std::string sql = R"(
+            SELECT
+                p.PlayerID, p.FirstName, p.LastName, p.NameCheck, p.Level,
+                p.AppearanceFlag, p.TutorialFlag, p.PayZoneFlag,
+                a.Body, a.EyeColor, a.FaceStyle, a.Gender, a.HairColor, a.HairStyle, a.Height, a.SkinColor
+            FROM Players as p
+            INNER JOIN Appearances as a ON p.PlayerID = a.PlayerID
+            WHERE p.PlayerID IN (?)";
+        for (size_t i = 1; i < count; i++)
+            sql += ", ?";
+        sql += ");";
+
+        sqlite3_stmt* stmt = prepare(c, sql.c_str());
+        for (size_t i = 0; i < count; i++)
+            sqlite3_bind_int(stmt, i + 1, ids[start + i]);
+
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            PlayerSummary summary = {};
+            summary.PlayerID = sqlite3_column_int(stmt, 0);
+            summary.PCStyle.iPC_UID = summary.PlayerID;
+
+            std::string placeHolder = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+            U8toU16(placeHolder, summary.PCStyle.szFirstName, sizeof(summary.PCStyle.szFirstName));
+            placeHolder = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
+            U8toU16(placeHolder, summary.PCStyle.szLastName, sizeof(summary.PCStyle.szLastName));
+
+            summary.PCStyle.iNameCheck = sqlite3_column_int(stmt, 3);
+            summary.Level = sqlite3_column_int(stmt, 4);
+            summary.PCStyle2.iAppearanceFlag = sqlite3_column_int(stmt, 5);
+            summary.PCStyle2.iTutorialFlag = sqlite3_column_int(stmt, 6);
+            summary.PCStyle2.iPayzoneFlag = sqlite3_column_int(stmt, 7);
+
+            summary.PCStyle.iBody = sqlite3_column_int(stmt, 8);
+            summary.PCStyle.iEyeColor = sqlite3_column_int(stmt, 9);
+            summary.PCStyle.iFaceStyle = sqlite3_column_int(stmt, 10);
+            summary.PCStyle.iGender = sqlite3_column_int(stmt, 11);
+            summary.PCStyle.iHairColor = sqlite3_column_int(stmt, 12);
+            summary.PCStyle.iHairStyle = sqlite3_column_int(stmt, 13);
+            summary.PCStyle.iHeight = sqlite3_column_int(stmt, 14);
+            summary.PCStyle.iSkinColor = sqlite3_column_int(stmt, 15);
+
+            result.push_back(summary);
+        }
+
+        release(c, stmt);
+    }
+
+    return result;
+}
+
+static bool sameItem(const sItemBase& a, const sItemBase& b) {
+    return a.iID == b.iID && a.iType == b.iType && a.iOpt == b.iOpt && a.iTimeLimit == b.iTimeLimit;
+}
+
+// Inventory slots are numbered equip, then inventory, then bank
+static const sItemBase& inventorySlot(const Player* player, int slot) {
+    if (slot < AEQUIP_COUNT)
+        return player->cold->Equip[slot];
+    slot -= AEQUIP_COUNT;
+    if (slot < AINVEN_COUNT)
+        return player->cold->Inven[slot];
+    return player->cold->Bank[slot - AINVEN_COUNT];
+}
+
+// where the player gets saved; instances and monkeys put them back where they came from
+static void savedPosition(const Player* player, int pos[4]) {
+    if (player->instanceID == 0 && !player->onMonkey) {
+        pos[0] = player->x;
+        pos[1] = player->y;
+        pos[2] = player->z;
+        pos[3] = player->angle;
+    } else {
+        pos[0] = player->lastX;
+        pos[1] = player->lastY;
+        pos[2] = player->lastZ;
+        pos[3] = player->lastAngle;
+    }
+}
+
+// compares everything that goes into the Players row
+static bool sameRow(const Player* a, const Player* b) {
+    int posA[4], posB[4];
+    savedPosition(a, posA);
+    savedPosition(b, posB);
+
+    return memcmp(posA, posB, sizeof(posA)) == 0
+        && a->level == b->level
+        && memcmp(a->equippedNanos, b->equippedNanos, sizeof(a->equippedNanos)) == 0
+        && a->HP == b->HP
+        && a->fusionmatter == b->fusionmatter
+        && a->money == b->money
+        && memcmp(a->cold->aQuestFlag, b->cold->aQuestFlag, sizeof(a->cold->aQuestFlag)) == 0
+        && a->batteryW == b->batteryW
+        && a->batteryN == b->batteryN
+        && a->iWarpLocationFlag == b->iWarpLocationFlag
+        && memcmp(a->aSkywayLocationFlag, b->aSkywayLocationFlag, sizeof(a->aSkywayLocationFlag)) == 0
+        && a->CurrentMissionID == b->CurrentMissionID
+        && a->PCStyle2.iPayzoneFlag == b->PCStyle2.iPayzoneFlag
+        && memcmp(a->cold->iFirstUseFlag, b->cold->iFirstUseFlag, sizeof(a->cold->iFirstUseFlag)) == 0
+        && a->mentor == b->mentor;
+}
+
+static bool sameRunningQuests(const Player* a, const Player* b) {
+    return memcmp(a->tasks, b->tasks, sizeof(a->tasks)) == 0
+        && memcmp(a->RemainingNPCCount, b->RemainingNPCCount, sizeof(a->RemainingNPCCount)) == 0;
+}
+
+// steps a write and readies the statement for the next row
+bool SQLiteStorage::stepWrite(Connection& c, sqlite3_stmt* stmt, int& rows) {
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        std::cout << "[WARN] Database: Failed to save player to database: " << sqlite3_errmsg(c.db) << std::endl;
+        release(c, stmt);
+        return false;
+    }
+
+    rows++;
+    sqlite3_reset(stmt);
+    return true;
+}
+
+/*
+ * Writes one player; the caller holds c.lock and owns the transaction.
+ *
+ * previous is the state last written for this player. When it's given, only
+ * the tables and slots that differ from it are touched, so a player who just
+ * stood around costs no writes at all. Without it everything is rewritten.
+ */
+bool SQLiteStorage::savePlayer(Connection& c, const Player* player, const Player* previous, int& rows) {
+    const char* sql;
+    sqlite3_stmt* stmt;
+
+    if (previous == nullptr || !sameRow(player, previous)) {
+        sql = R"(
+            UPDATE Players
+            SET
+                Level = ? , Nano1 = ?, Nano2 = ?, Nano3 = ?,
+                XCoordinates = ?, YCoordinates = ?, ZCoordinates = ?,
+                Angle = ?, HP = ?, FusionMatter = ?, Taros = ?, Quests = ?,
+                BatteryW = ?, BatteryN = ?, WarplocationFlag = ?,
+                SkywayLocationFlag = ?, CurrentMissionID = ?,
+                PayZoneFlag = ?, FirstUseFlag = ?, Mentor = ?
+            WHERE PlayerID = ?;
+            )";
+        stmt = prepare(c, sql);
+
+        int pos[4];
+        savedPosition(player, pos);
+
+        sqlite3_bind_int(stmt, 1, player->level);
+        sqlite3_bind_int(stmt, 2, player->equippedNanos[0]);
+        sqlite3_bind_int(stmt, 3, player->equippedNanos[1]);
+        sqlite3_bind_int(stmt, 4, player->equippedNanos[2]);
+        sqlite3_bind_int(stmt, 5, pos[0]);
+        sqlite3_bind_int(stmt, 6, pos[1]);
+        sqlite3_bind_int(stmt, 7, pos[2]);
+        sqlite3_bind_int(stmt, 8, pos[3]);
+        sqlite3_bind_int(stmt, 9, player->HP);
+        sqlite3_bind_int(stmt, 10, player->fusionmatter);
+        sqlite3_bind_int(stmt, 11, player->money);
+        sqlite3_bind_blob(stmt, 12, player->cold->aQuestFlag, sizeof(player->cold->aQuestFlag), NULL);
+        sqlite3_bind_int(stmt, 13, player->batteryW);
+        sqlite3_bind_int(stmt, 14, player->batteryN);
+        sqlite3_bind_int(stmt, 15, player->iWarpLocationFlag);
+        sqlite3_bind_blob(stmt, 16, player->aSkywayLocationFlag, sizeof(player->aSkywayLocationFlag), NULL);
+        sqlite3_bind_int(stmt, 17, player->CurrentMissionID);
+        sqlite3_bind_int(stmt, 18, player->PCStyle2.iPayzoneFlag);
+        sqlite3_bind_blob(stmt, 19, player->cold->iFirstUseFlag, sizeof(player->cold->iFirstUseFlag), NULL);
+        sqlite3_bind_int(stmt, 20, player->mentor);
+        sqlite3_bind_int(stmt, 21, player->iID);
+
+        if (!stepWrite(c, stmt, rows))
+            return false;
+        release(c, stmt);
+
+        // the character is gone (deleted while a journal record was waiting, say); don't leave orphaned rows
+        if (sqlite3_changes(c.db) == 0) {
+            std::cout << "[WARN] Database: no character " << player->iID << " to save" << std::endl;
+            return false;
+        }
+    }
+
+    // a full save starts from empty tables, so every occupied slot counts as changed
+    if (previous == nullptr) {
+        const char* clear[] = {
+            "DELETE FROM Inventory WHERE PlayerID = ?;",
+            "DELETE FROM QuestItems WHERE PlayerID = ?;",
+            "DELETE FROM Nanos WHERE PlayerID = ?;"
+        };
+
+        for (const char* query : clear) {
+            stmt = prepare(c, query);
+            sqlite3_bind_int(stmt, 1, player->iID);
+            if (!stepWrite(c, stmt, rows))
+                return false;
+            release(c, stmt);
+        }
+    }
+
+    // update inventory (equip, inventory and bank share the table)
+    sqlite3_stmt* upsert = prepare(c, R"(
+        INSERT OR REPLACE INTO Inventory
+            (PlayerID, Slot, Type, Opt, ID, Timelimit)
+        VALUES (?, ?, ?, ?, ?, ?);
+        )");
+    sqlite3_stmt* remove = prepare(c, R"(
+        DELETE FROM Inventory WHERE PlayerID = ? AND Slot = ?;
+        )");
+
+    for (int i = 0; i < AEQUIP_COUNT + AINVEN_COUNT + ABANK_COUNT; i++) {
+        const sItemBase& item = inventorySlot(player, i);
+        if (previous != nullptr && sameItem(item, inventorySlot(previous, i)))
+            continue;
+
+        bool ok = true;
+        if (item.iID != 0) {
+            sqlite3_bind_int(upsert, 1, player->iID);
+            sqlite3_bind_int(upsert, 2, i);
+            sqlite3_bind_int(upsert, 3, item.iType);
+            sqlite3_bind_int(upsert, 4, item.iOpt);
+            sqlite3_bind_int(upsert, 5, item.iID);
+            sqlite3_bind_int(upsert, 6, item.iTimeLimit);
+            ok = stepWrite(c, upsert, rows);
+        } else if (previous != nullptr) {
+            sqlite3_bind_int(remove, 1, player->iID);
+            sqlite3_bind_int(remove, 2, i);
+            ok = stepWrite(c, remove, rows);
+        }
+
+        if (!ok) {
+            // stepWrite(c, ) released the one that failed
+            release(c, item.iID != 0 ? remove : upsert);
+            return false;
+        }
+    }
+
+    release(c, upsert);
+    release(c, remove);
+
+    // Update Quest Inventory
+    upsert = prepare(c, R"(
+        INSERT OR REPLACE INTO QuestItems (PlayerID, Slot, Opt, ID)
+        VALUES (?, ?, ?, ?);
+        )");
+    remove = prepare(c, R"(
+        DELETE FROM QuestItems WHERE PlayerID = ? AND Slot = ?;
+        )");
+
+    for (int i = 0; i < AQINVEN_COUNT; i++) {
+        const sItemBase& item = player->cold->QInven[i];
+        if (previous != nullptr && sameItem(item, previous->cold->QInven[i]))
+            continue;
+
+        bool ok = true;
+        if (item.iID != 0) {
+            sqlite3_bind_int(upsert, 1, player->iID);
+            sqlite3_bind_int(upsert, 2, i);
+            sqlite3_bind_int(upsert, 3, item.iOpt);
+            sqlite3_bind_int(upsert, 4, item.iID);
+            ok = stepWrite(c, upsert, rows);
+        } else if (previous != nullptr) {
+            sqlite3_bind_int(remove, 1, player->iID);
+            sqlite3_bind_int(remove, 2, i);
+            ok = stepWrite(c, remove, rows);
+        }
+
+        if (!ok) {
+            release(c, item.iID != 0 ? remove : upsert);
+            return false;
+        }
+    }
+
+    release(c, upsert);
+    release(c, remove);
+
+    // Update Nanos; rows are keyed by nano ID, which is also the index into Nanos
+    upsert = prepare(c, R"(
+        INSERT OR REPLACE INTO Nanos (PlayerID, ID, SKill, Stamina)
+        VALUES (?, ?, ?, ?);
+        )");
+    remove = prepare(c, R"(
+        DELETE FROM Nanos WHERE PlayerID = ? AND ID = ?;
+        )");
+
+    for (int i = 0; i < NANO_COUNT; i++) {
+        const sNano& nano = player->Nanos[i];
+        if (previous != nullptr) {
+            const sNano& old = previous->Nanos[i];
+            if (nano.iID == old.iID && nano.iSkillID == old.iSkillID && nano.iStamina == old.iStamina)
+                continue;
+        }
+
+        bool ok = true;
+        if (nano.iID != 0) {
+            sqlite3_bind_int(upsert, 1, player->iID);
+            sqlite3_bind_int(upsert, 2, nano.iID);
+            sqlite3_bind_int(upsert, 3, nano.iSkillID);
+            sqlite3_bind_int(upsert, 4, nano.iStamina);
+            ok = stepWrite(c, upsert, rows);
+        } else if (previous != nullptr && previous->Nanos[i].iID != 0) {
+            sqlite3_bind_int(remove, 1, player->iID);
+            sqlite3_bind_int(remove, 2, previous->Nanos[i].iID);
+            ok = stepWrite(c, remove, rows);
+        }
+
+        if (!ok) {
+            release(c, nano.iID != 0 ? remove : upsert);
+            return false;
+        }
+    }
+
+    release(c, upsert);
+    release(c, remove);
+
+    // Update Running Quests; there's no key to diff by and only a handful of rows, so rewrite them
+    if (previous != nullptr && sameRunningQuests(player, previous))
+        return true;
+
+    stmt = prepare(c, R"(
+        DELETE FROM RunningQuests WHERE PlayerID = ?;
+        )");
+    sqlite3_bind_int(stmt, 1, player->iID);
+    if (!stepWrite(c, stmt, rows))
+        return false;
+    release(c, stmt);
+
+    sql = R"(
+        INSERT INTO RunningQuests
+            (PlayerID, TaskID, RemainingNPCCount1, RemainingNPCCount2, RemainingNPCCount3)
+        VALUES (?, ?, ?, ?, ?);
+        )";
+    stmt = prepare(c, sql);
+
+    for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
+        if (player->tasks[i] == 0)
+            continue;
+        sqlite3_bind_int(stmt, 1, player->iID);
+        sqlite3_bind_int(stmt, 2, player->tasks[i]);
+        sqlite3_bind_int(stmt, 3, player->RemainingNPCCount[i][0]);
+        sqlite3_bind_int(stmt, 4, player->RemainingNPCCount[i][1]);
+        sqlite3_bind_int(stmt, 5, player->RemainingNPCCount[i][2]);
+
+        if (!stepWrite(c, stmt, rows))
+            return false;
+    }
+
+    release(c, stmt);
+    return true;
+}
+
+void SQLiteStorage::updatePlayer(const Player* player) {
+    Connection& c = writer();
+    std::lock_guard<std::mutex> lock(c.lock);
+    int rows = 0;
+
+    sqlite3_exec(c.db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+    if (savePlayer(c, player, nullptr, rows))
+        sqlite3_exec(c.db, "COMMIT;", NULL, NULL, NULL);
+    else
+        sqlite3_exec(c.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+}
+
+void SQLiteStorage::updatePlayers(std::vector<PlayerSave>& saves) {
+    Connection& c = writer();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    sqlite3_exec(c.db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+    // a savepoint per player, so one bad row doesn't throw away the whole batch
+    for (PlayerSave& save : saves) {
+        save.rows = 0;
+        sqlite3_exec(c.db, "SAVEPOINT player;", NULL, NULL, NULL);
+
+        save.ok = savePlayer(c, save.player, save.previous, save.rows);
+        if (!save.ok)
+            sqlite3_exec(c.db, "ROLLBACK TO player;", NULL, NULL, NULL);
+
+        sqlite3_exec(c.db, "RELEASE player;", NULL, NULL, NULL);
+    }
+
+    if (sqlite3_exec(c.db, "COMMIT;", NULL, NULL, NULL) != SQLITE_OK) {
+        std::cout << "[WARN] Database: Failed to commit player saves: " << sqlite3_errmsg(c.db) << std::endl;
+        sqlite3_exec(c.db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        for (PlayerSave& save : saves)
+            save.ok = false;
+    }
+}
+
+// buddies
+// returns num of buddies + blocked players
+int SQLiteStorage::getNumBuddies(Player* player) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        SELECT COUNT(*)
+        FROM Buddyships
+        WHERE PlayerAID = ? OR PlayerBID = ?;
+        )";
+    sqlite3_stmt* stmt;
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, player->iID);
+    sqlite3_bind_int(stmt, 2, player->iID);
+    sqlite3_step(stmt);
+    int result = sqlite3_column_int(stmt, 0);
+
+    release(c, stmt);
+
+    sql = R"(
+        SELECT COUNT(*)
+        FROM Blocks
+        WHERE PlayerID = ?;
+        )";
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, player->iID);
+    sqlite3_step(stmt);
+    result += sqlite3_column_int(stmt, 0);
+
+    release(c, stmt);
+
+    // again, for peace of mind
+    return result > 50 ? 50 : result;
+}
+
+void SQLiteStorage::addBuddyship(int playerA, int playerB) {
+    queueWrite([this, playerA, playerB]() {
+        Connection& c = writeConn;
+        const char* sql = R"(
+            INSERT INTO Buddyships (PlayerAID, PlayerBID)
+            VALUES (?, ?);
+            )";
+        sqlite3_stmt* stmt;
+        stmt = prepare(c, sql);
+        sqlite3_bind_int(stmt, 1, playerA);
+        sqlite3_bind_int(stmt, 2, playerB);
+
+        int rc = sqlite3_step(stmt);
+        if (rc != SQLITE_DONE)
+            std::cout << "[WARN] Database: failed to add buddyship: " << sqlite3_errmsg(c.db) << std::endl;
+        release(c, stmt);
+        return rc == SQLITE_DONE;
+    });
+}
+
+void SQLiteStorage::removeBuddyship(int playerA, int playerB) {
+    queueWrite([this, playerA, playerB]() {
+        Connection& c = writeConn;
+        const char* sql = R"(
+            DELETE FROM Buddyships
+            WHERE (PlayerAID = ? AND PlayerBID = ?) OR (PlayerAID = ? AND PlayerBID = ?);
+            )";
+        sqlite3_stmt* stmt;
+        stmt = prepare(c, sql);
+        sqlite3_bind_int(stmt, 1, playerA);
+        sqlite3_bind_int(stmt, 2, playerB);
+        sqlite3_bind_int(stmt, 3, playerB);
+        sqlite3_bind_int(stmt, 4, playerA);
+
+        int rc = sqlite3_step(stmt);
+        release(c, stmt);
+        return rc == SQLITE_DONE;
+    });
+}
+
+// blocking
+void SQLiteStorage::addBlock(int playerId, int blockedPlayerId) {
+    queueWrite([this, playerId, blockedPlayerId]() {
+        Connection& c = writeConn;
+        const char* sql = R"(
+            INSERT INTO Blocks (PlayerID, BlockedPlayerID)
+            VALUES (?, ?);
+            )";
+        sqlite3_stmt* stmt;
+        stmt = prepare(c, sql);
+        sqlite3_bind_int(stmt, 1, playerId);
+        sqlite3_bind_int(stmt, 2, blockedPlayerId);
+
+        int rc = sqlite3_step(stmt);
+        if (rc != SQLITE_DONE)
+            std::cout << "[WARN] Database: failed to block player: " << sqlite3_errmsg(c.db) << std::endl;
+        release(c, stmt);
+        return rc == SQLITE_DONE;
+    });
+}
+
+void SQLiteStorage::removeBlock(int playerId, int blockedPlayerId) {
+    queueWrite([this, playerId, blockedPlayerId]() {
+        Connection& c = writeConn;
+        const char* sql = R"(
+            DELETE FROM Blocks
+            WHERE PlayerID = ? AND BlockedPlayerID = ?;
+            )";
+        sqlite3_stmt* stmt;
+        stmt = prepare(c, sql);
+        sqlite3_bind_int(stmt, 1, playerId);
+        sqlite3_bind_int(stmt, 2, blockedPlayerId);
+
+        int rc = sqlite3_step(stmt);
+        release(c, stmt);
+        return rc == SQLITE_DONE;
+    });
+}
+
+// email
+int SQLiteStorage::getUnreadEmailCount(int playerID) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        SELECT COUNT(*) FROM EmailData
+        WHERE PlayerID = ? AND ReadFlag = 0;
+        )";
+    sqlite3_stmt* stmt;
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, playerID);
+    sqlite3_step(stmt);
+    int ret = sqlite3_column_int(stmt, 0);
+
+    release(c, stmt);
+
+    return ret;
+}
+
+std::vector<Database::EmailData> SQLiteStorage::getEmails(int playerID, int before, int count) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    std::vector<Database::EmailData> emails;
+
+    // seeks straight to before on the (PlayerID, MsgIndex) index, where OFFSET would walk every row above it
+    const char* sql = R"(
+        SELECT
+            MsgIndex, ItemFlag, ReadFlag, SenderID,
+            SenderFirstName, SenderLastName, SubjectLine,
+            Taros, SendTime, DeleteTime
+        FROM EmailData
+        WHERE PlayerID = ? AND MsgIndex < ?
+        ORDER BY MsgIndex DESC
+        LIMIT ?;
+        )";
+    sqlite3_stmt* stmt;
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, playerID);
+    sqlite3_bind_int(stmt, 2, before);
+    sqlite3_bind_int(stmt, 3, count); // sqlite reads a negative LIMIT as none
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        Database::EmailData toAdd;
+        toAdd.PlayerId = playerID;
+        toAdd.MsgIndex = sqlite3_column_int(stmt, 0);
+        toAdd.ItemFlag = sqlite3_column_int(stmt, 1);
+        toAdd.ReadFlag = sqlite3_column_int(stmt, 2);
+        toAdd.SenderId = sqlite3_column_int(stmt, 3);
+        toAdd.SenderFirstName = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)));
+        toAdd.SenderLastName = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5)));
+        toAdd.SubjectLine = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6)));
+        toAdd.Taros = sqlite3_column_int(stmt, 7);
+        toAdd.SendTime = sqlite3_column_int64(stmt, 8);
+        toAdd.DeleteTime = sqlite3_column_int64(stmt, 9);
+
+        emails.push_back(toAdd);
+    }
+    release(c, stmt);
+
+    return emails;
+}
+
+Database::EmailData SQLiteStorage::getEmail(int playerID, int index) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        SELECT
+            ItemFlag, ReadFlag, SenderID, SenderFirstName,
+            SenderLastName, SubjectLine, MsgBody,
+            Taros, SendTime, DeleteTime
+        FROM EmailData
+        WHERE PlayerID = ? AND MsgIndex = ?;
+        )";
+    sqlite3_stmt* stmt;
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, playerID);
+    sqlite3_bind_int(stmt, 2, index);
+
+    Database::EmailData result;
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        std::cout << "[WARN] Database: Email not found!" << std::endl;
+        release(c, stmt);
+        return result;
+    }
+
+    result.PlayerId = playerID;
+    result.MsgIndex = index;
+    result.ItemFlag = sqlite3_column_int(stmt, 0);
+    result.ReadFlag = sqlite3_column_int(stmt, 1);
+    result.SenderId = sqlite3_column_int(stmt, 2);
+    result.SenderFirstName = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
+    result.SenderLastName = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)));
+    result.SubjectLine = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5)));
+    result.MsgBody = std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6)));
+    result.Taros = sqlite3_column_int(stmt, 7);
+    result.SendTime = sqlite3_column_int64(stmt, 8);
+    result.DeleteTime = sqlite3_column_int64(stmt, 9);
+
+    release(c, stmt);
+    return result;
+}
+
+sItemBase* SQLiteStorage::getEmailAttachments(int playerID, int index) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    sItemBase* items = new sItemBase[4];
+    for (int i = 0; i < 4; i++)
+        items[i] = { 0, 0, 0, 0 };
+
+    const char* sql = R"(
+        SELECT Slot, ID, Type, Opt, TimeLimit
+        FROM EmailItems
+        WHERE PlayerID = ? AND MsgIndex = ?;
+        )";
+    sqlite3_stmt* stmt;
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, playerID);
+    sqlite3_bind_int(stmt, 2, index);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int slot = sqlite3_column_int(stmt, 0) - 1;
+        if (slot < 0 || slot > 3) {
+            std::cout << "[WARN] Email item has invalid slot number ?!" << std::endl;
+            continue;
+        }
+
+        items[slot].iID = sqlite3_column_int(stmt, 1);
+        items[slot].iType = sqlite3_column_int(stmt, 2);
+        items[slot].iOpt = sqlite3_column_int(stmt, 3);
+        items[slot].iTimeLimit = sqlite3_column_int(stmt, 4);
+    }
+
+    release(c, stmt);
+    return items;
+}
+
+void SQLiteStorage::updateEmailContent(EmailData* data) {
+    EmailData email = *data;
+    queueWrite([this, email]() {
+        Connection& c = writeConn;
+        const char* sql = R"(
+            UPDATE EmailData
+            SET
+                PlayerID = ?,
+                MsgIndex = ?,
+                ReadFlag = ?,
+                ItemFlag = ?,
+                SenderID = ?,
+                SenderFirstName = ?,
+                SenderLastName = ?,
+                SubjectLine = ?,
+                MsgBody = ?,
+                Taros = ?,
+                SendTime = ?,
+                DeleteTime = ?
+            WHERE PlayerID = ? AND MsgIndex = ?;
+            )";
+        sqlite3_stmt* stmt;
+        stmt = prepare(c, sql);
+        sqlite3_bind_int(stmt, 1, email.PlayerId);
+        sqlite3_bind_int(stmt, 2, email.MsgIndex);
+        sqlite3_bind_int(stmt, 3, email.ReadFlag);
+        sqlite3_bind_int(stmt, 4, email.ItemFlag);
+        sqlite3_bind_int(stmt, 5, email.SenderId);
+        sqlite3_bind_text(stmt, 6, email.SenderFirstName.c_str(), -1, NULL);
+        sqlite3_bind_text(stmt, 7, email.SenderLastName.c_str(), -1, NULL);
+        sqlite3_bind_text(stmt, 8, email.SubjectLine.c_str(), -1, NULL);
+        sqlite3_bind_text(stmt, 9, email.MsgBody.c_str(), -1, NULL);
+        sqlite3_bind_int(stmt, 10, email.Taros);
+        sqlite3_bind_int64(stmt, 11, email.SendTime);
+        sqlite3_bind_int64(stmt, 12, email.DeleteTime);
+        sqlite3_bind_int(stmt, 13, email.PlayerId);
+        sqlite3_bind_int(stmt, 14, email.MsgIndex);
+
+        int rc = sqlite3_step(stmt);
+        if (rc != SQLITE_DONE)
+            std::cout << "[WARN] Database: failed to update email: " << sqlite3_errmsg(c.db) << std::endl;
+
+        release(c, stmt);
+        return rc == SQLITE_DONE;
+    });
+}
+
+void SQLiteStorage::deleteEmailAttachments(int playerID, int index, int slot) {
+    queueWrite([this, playerID, index, slot]() {
+        Connection& c = writeConn;
+        sqlite3_stmt* stmt;
+
+        std::string sql(R"(
+            DELETE FROM EmailItems
+            WHERE PlayerID = ? AND MsgIndex = ?
+            )");
+
+        if (slot != -1)
+            sql += " AND \"Slot\" = ? ";
+        sql += ";";
+
+        stmt = prepare(c, sql.c_str());
+        sqlite3_bind_int(stmt, 1, playerID);
+        sqlite3_bind_int(stmt, 2, index);
+        if (slot != -1)
+            sqlite3_bind_int(stmt, 3, slot);
+
+        int rc = sqlite3_step(stmt);
+        if (rc != SQLITE_DONE)
+            std::cout << "[WARN] Database: Failed to delete email attachments: " << sqlite3_errmsg(c.db) << std::endl;
+        release(c, stmt);
+        return rc == SQLITE_DONE;
+    });
+}
+
+void SQLiteStorage::deleteEmails(int playerID, int64_t* indices) {
+    std::vector<int64_t> toDelete(indices, indices + 5);
+
+    queueWrite([this, playerID, toDelete]() {
+        Connection& c = writeConn;
+        sqlite3_stmt* stmt;
+
+        const char* sql = R"(
+            DELETE FROM EmailData
+            WHERE PlayerID = ? AND MsgIndex = ?;
+            )";
+        stmt = prepare(c, sql);
+
+        for (int64_t index : toDelete) {
+            sqlite3_bind_int(stmt, 1, playerID);
+            sqlite3_bind_int64(stmt, 2, index);
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                std::cout << "[WARN] Database: Failed to delete an email: " << sqlite3_errmsg(c.db) << std::endl;
+            }
+            sqlite3_reset(stmt);
+        }
+        release(c, stmt);
+        return true;
+    });
+}
+
+int SQLiteStorage::getNextEmailIndex(int playerID) {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+
+    const char* sql = R"(
+        SELECT MsgIndex
+        FROM EmailData
+        WHERE PlayerID = ?
+        ORDER BY MsgIndex DESC
+        LIMIT 1;
+        )";
+    sqlite3_stmt* stmt;
+    stmt = prepare(c, sql);
+    sqlite3_bind_int(stmt, 1, playerID);
+    sqlite3_step(stmt);
+    int index = sqlite3_column_int(stmt, 0);
+
+    release(c, stmt);
+    return (index > 0 ? index + 1 : 1);
+}
+
+bool SQLiteStorage::sendEmail(EmailData* data, std::vector<sItemBase> attachments) {
+    EmailData email = *data;
+
+    // the sender is told whether it went through, so this one waits for its group
+    return queueWrite([this, email, attachments]() {
+        Connection& c = writeConn;
+        const char* sql = R"(
+            INSERT INTO EmailData
+                (PlayerID, MsgIndex, ReadFlag, ItemFlag,
+                SenderID, SenderFirstName, SenderLastName,
+                SubjectLine, MsgBody, Taros, SendTime, DeleteTime)
+            VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+            )";
+        sqlite3_stmt* stmt;
+
+        stmt = prepare(c, sql);
+        sqlite3_bind_int(stmt, 1, email.PlayerId);
+        sqlite3_bind_int(stmt, 2, email.MsgIndex);
+        sqlite3_bind_int(stmt, 3, email.ReadFlag);
+        sqlite3_bind_int(stmt, 4, email.ItemFlag);
+        sqlite3_bind_int(stmt, 5, email.SenderId);
+        sqlite3_bind_text(stmt, 6, email.SenderFirstName.c_str(), -1, NULL);
+        sqlite3_bind_text(stmt, 7, email.SenderLastName.c_str(), -1, NULL);
+        sqlite3_bind_text(stmt, 8, email.SubjectLine.c_str(), -1, NULL);
+        sqlite3_bind_text(stmt, 9, email.MsgBody.c_str(), -1, NULL);
+        sqlite3_bind_int(stmt, 10, email.Taros);
+        sqlite3_bind_int64(stmt, 11, email.SendTime);
+        sqlite3_bind_int64(stmt, 12, email.DeleteTime);
+
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            std::cout << "[WARN] Database: Failed to send email: " << sqlite3_errmsg(c.db) << std::endl;
+            release(c, stmt);
+            return false;
+        }
+
+        release(c, stmt);
+
+        sql = R"(
+            INSERT INTO EmailItems
+                (PlayerID, MsgIndex, Slot, ID, Type, Opt, TimeLimit)
+            VALUES (?, ?, ?, ?, ?, ?, ?);
+            )";
+
+        stmt = prepare(c, sql);
+
+        // send attachments
+        int slot = 1;
+        for (sItemBase item : attachments) {
+            sqlite3_bind_int(stmt, 1, email.PlayerId);
+            sqlite3_bind_int(stmt, 2, email.MsgIndex);
+            sqlite3_bind_int(stmt, 3, slot++);
+            sqlite3_bind_int(stmt, 4, item.iID);
+            sqlite3_bind_int(stmt, 5, item.iType);
+            sqlite3_bind_int(stmt, 6, item.iOpt);
+            sqlite3_bind_int(stmt, 7, item.iTimeLimit);
+
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                std::cout << "[WARN] Database: Failed to send email: " << sqlite3_errmsg(c.db) << std::endl;
+                release(c, stmt);
+                return false;
+            }
+            sqlite3_reset(stmt);
+        }
+        release(c, stmt);
+        return true;
+    }, true);
+}
+
+std::vector<Database::RaceRanking> SQLiteStorage::getRaceBests() {
+    Connection& c = reader();
+    std::lock_guard<std::mutex> lock(c.lock);
+    // with MAX(), sqlite takes the bare columns from the row that has it
+    const char* sql = R"(
+        SELECT
+            EPID, PlayerID, MAX(Score), RingCount, Time, Timestamp
+        FROM RaceResults
+        GROUP BY EPID, PlayerID;
+        )";
+    sqlite3_stmt* stmt = prepare(c, sql);
+
+    std::vector<Database::RaceRanking> bests;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        Database::RaceRanking ranking = {};
+        ranking.EPID = sqlite3_column_int(stmt, 0);
+        ranking.PlayerID = sqlite3_column_int(stmt, 1);
+        ranking.Score = sqlite3_column_int(stmt, 2);
+        ranking.RingCount = sqlite3_column_int(stmt, 3);
+        ranking.Time = sqlite3_column_int64(stmt, 4);
+        ranking.Timestamp = sqlite3_column_int64(stmt, 5);
+        bests.push_back(ranking);
+    }
+
+    release(c, stmt);
+    return bests;
+}
+
+void SQLiteStorage::postRaceRanking(Database::RaceRanking ranking) {
+    queueWrite([this, ranking]() {
+        Connection& c = writeConn;
+        const char* sql = R"(
+            INSERT INTO RaceResults
+                (EPID, PlayerID, Score, RingCount, Time, Timestamp)
+            VALUES(?, ?, ?, ?, ?, ?);
+            )";
+        sqlite3_stmt* stmt;
+
+        stmt = prepare(c, sql);
+        sqlite3_bind_int(stmt, 1, ranking.EPID);
+        sqlite3_bind_int(stmt, 2, ranking.PlayerID);
+        sqlite3_bind_int(stmt, 3, ranking.Score);
+        sqlite3_bind_int(stmt, 4, ranking.RingCount);
+        sqlite3_bind_int64(stmt, 5, ranking.Time);
+        sqlite3_bind_int64(stmt, 6, ranking.Timestamp);
+
+        int rc = sqlite3_step(stmt);
+        if (rc != SQLITE_DONE) {
+            std::cout << "[WARN] Database: Failed to post race result" << std::endl;
+        }
+
+        release(c, stmt);
+        return rc == SQLITE_DONE;
+    });
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Storage.hpp"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.condition_variable.h"
+    #include "mingw/mingw.mutex.h"
+    #include "mingw/mingw.thread.h"
+#else
+    #include <condition_variable>
+    #include <mutex>
+    #include <thread>
+#endif
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+/*
+ * The database file at dbpath, in WAL mode.
+ *
+ * Every thread reads through a connection of its own, so a long save never
+ * holds up a login. All writes go through the one writer connection. The
+ * small, frequent ones (buddies, blocks, email, race results, selected slot)
+ * are queued to the I/O thread instead, which commits whatever piled up
+ * while it was busy as one transaction. Reads still see every write made
+ * before them: they wait for the ones that are queued.
+ *
+ * SQLite's own checkpointing runs on whichever commit crosses the limit,
+ * which could be the game's. The I/O thread does it instead once the WAL has
+ * grown past dbcheckpointpages.
+ */
+class SQLiteStorage : public Storage {
+public:
+    const char* name() const override { return "sqlite"; }
+    void open() override;
+    void close() override;
+    // turning it off finalizes every statement after use, like before there was a cache
+    void setStatementCache(bool enabled) override;
+    void submit(std::function<void()> job) override;
+
+    void findAccount(Account* account, std::string login) override;
+    int addAccount(std::string login, std::string password) override;
+    void banAccount(int accountId, int days) override;
+    void updateSelected(int accountId, int slot) override;
+
+    bool validateCharacter(int characterID, int userID) override;
+    bool isNameFree(std::string firstName, std::string lastName) override;
+    bool isSlotFree(int accountId, int slotNum) override;
+    int createCharacter(sP_CL2LS_REQ_SAVE_CHAR_NAME* save, int AccountID) override;
+    bool finishCharacter(sP_CL2LS_REQ_CHAR_CREATE* character, int accountId) override;
+    bool finishTutorial(int playerID, int accountID) override;
+    int deleteCharacter(int characterID, int userID) override;
+    void getCharInfo(std::vector <sP_LS2CL_REP_CHAR_INFO>* result, int userID) override;
+    void evaluateCustomName(int characterID, CustomName decision) override;
+    bool changeName(sP_CL2LS_REQ_CHANGE_CHAR_NAME* save, int accountId) override;
+
+    void getPlayer(Player* plr, int id) override;
+    std::vector<PlayerSummary> getPlayerSummaries(const std::vector<int>& ids) override;
+    void updatePlayer(const Player* player) override;
+    void updatePlayers(std::vector<PlayerSave>& saves) override;
+
+    int getNumBuddies(Player* player) override;
+    void addBuddyship(int playerA, int playerB) override;
+    void removeBuddyship(int playerA, int playerB) override;
+    void addBlock(int playerId, int blockedPlayerId) override;
+    void removeBlock(int playerId, int blockedPlayerId) override;
+
+    int getUnreadEmailCount(int playerID) override;
+    std::vector<EmailData> getEmails(int playerID, int before, int count) override;
+    EmailData getEmail(int playerID, int index) override;
+    sItemBase* getEmailAttachments(int playerID, int index) override;
+    void updateEmailContent(EmailData* data) override;
+    void deleteEmailAttachments(int playerID, int index, int slot) override;
+    void deleteEmails(int playerID, int64_t* indices) override;
+    int getNextEmailIndex(int playerID) override;
+    bool sendEmail(EmailData* data, std::vector<sItemBase> attachments) override;
+
+    std::vector<RaceRanking> getRaceBests() override;
+    void postRaceRanking(RaceRanking ranking) override;
+
+private:
+    struct Connection {
+        sqlite3* db = nullptr;
+        std::mutex lock;
+
+        /*
+         * Prepared statements, compiled once per connection and reused. Callers hold
+         * lock, get a statement back freshly reset, and release() it when they're
+         * done instead of finalizing it. They're keyed by SQL text, so statements
+         * assembled at runtime are cached once per distinct string.
+         */
+        std::unordered_map<std::string, sqlite3_stmt*> statements;
+        bool cacheStatements = true; // under lock, so prepare() and release() agree on it
+    };
+    struct Job {
+        std::function<bool()> fn;
+        bool write; // goes into a group commit; otherwise it's a submit()ted job
+        uint64_t seq;
+        bool* result; // the waiting caller's, if there is one
+    };
+
+    Connection writeConn;
+    Connection checkpointConn; // checkpoints copy pages back on a connection of their own, so writes carry on meanwhile
+    std::mutex readersLock;
+    std::unordered_map<std::thread::id, std::unique_ptr<Connection>> readers;
+    bool cacheStatements = true; // for readers connected later; under readersLock
+
+    // queued writes and submit()ted jobs, run in order by ioThread
+    std::thread ioThread;
+    std::mutex jobLock;
+    std::condition_variable jobCv, doneCv;
+    std::deque<Job> jobs;
+    uint64_t queuedSeq = 0, doneSeq = 0;
+    uint64_t lastWrite = 0; // submit()ted jobs don't hold up reads
+    bool stopping = false;
+    std::atomic<int> walPages{0};
+    uint64_t groups = 0, groupedWrites = 0;
+
+    void connect(Connection& conn, int flags);
+    void disconnect(Connection& conn);
+    // both wait for the writes queued so far; lock the connection you get back
+    Connection& reader();
+    Connection& writer();
+
+    sqlite3_stmt* prepare(Connection& c, const char* sql);
+    void release(Connection& c, sqlite3_stmt* stmt);
+    void finalizeStatements(Connection& c);
+
+    // fn runs on the writer, inside a transaction; false rolls back just its own changes
+    bool queueWrite(std::function<bool()> fn, bool wait = false);
+    void waitForQueued();
+    void runGroup(std::vector<Job>& group);
+    bool checkpointDue();
+    void checkpoint();
+    void ioLoop();
+    static int walHook(void* arg, sqlite3* db, const char* name, int pages);
+
+    void checkMetaTable();
+    void createMetaTable();
+    void createTables();
+    int getTableSize(std::string tableName);
+
+    void loadPlayer(Connection& c, Player* plr, int id);
+    bool stepWrite(Connection& c, sqlite3_stmt* stmt, int& rows);
+    bool savePlayer(Connection& c, const Player* player, const Player* previous, int& rows);
+};
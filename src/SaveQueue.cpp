@@ -0,0 +1,258 @@
+#include "SaveQueue.hpp"
+#include "Database.hpp"
+#include "Journal.hpp"
+#include "settings.hpp"
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.condition_variable.h"
+    #include "mingw/mingw.mutex.h"
+    #include "mingw/mingw.thread.h"
+#else
+    #include <condition_variable>
+    #include <mutex>
+    #include <thread>
+#endif
+
+// players per transaction; bounds how long the writer holds the DB lock at a time
+static const size_t BATCH_SIZE = 32;
+
+static std::mutex queueLock;
+static std::condition_variable workCv, roomCv, idleCv;
+static std::thread writer;
+static bool running = false;
+static bool stopping = false;
+
+struct Snapshot {
+    std::unique_ptr<const Player> player;
+    bool leaving;
+};
+
+// one snapshot per player, written in the order they were first queued
+static std::unordered_map<int32_t, Snapshot> pending;
+static std::deque<int32_t> order;
+static std::unordered_set<int32_t> inFlight;
+static SaveQueue::Stats stats = {};
+
+// callbacks waiting on the players that were queued when they were registered
+struct Barrier {
+    std::unordered_map<int32_t, int> waiting; // writes still owed per player; two if one is in flight and another queued
+    bool ok;
+    std::function<void(bool)> fn;
+};
+static std::vector<Barrier> barriers;
+
+// what was last written for each player; only the writer thread touches this
+static std::unordered_map<int32_t, std::unique_ptr<const Player>> lastWritten;
+
+static void writerLoop() {
+    std::vector<Snapshot> batch;
+    std::vector<Database::PlayerSave> saves;
+    std::unique_lock<std::mutex> lock(queueLock);
+
+    while (true) {
+        workCv.wait(lock, [] { return stopping || !order.empty(); });
+        if (order.empty())
+            break; // stopping, and nothing left to write
+
+        while (!order.empty() && batch.size() < BATCH_SIZE) {
+            auto it = pending.find(order.front());
+            order.pop_front();
+
+            inFlight.insert(it->first);
+            batch.push_back(std::move(it->second));
+            pending.erase(it);
+        }
+        roomCv.notify_all();
+        lock.unlock();
+
+        saves.clear();
+        for (Snapshot& snapshot : batch) {
+            auto it = lastWritten.find(snapshot.player->iID);
+            const Player* previous = it != lastWritten.end() ? it->second.get() : nullptr;
+            saves.push_back({snapshot.player.get(), previous, false, 0});
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        Database::updatePlayers(saves);
+        uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t saved = 0, unchanged = 0, rows = 0;
+        lock.lock();
+        for (size_t i = 0; i < batch.size(); i++) {
+            int32_t id = batch[i].player->iID;
+            inFlight.erase(id);
+
+            // a failed save leaves the disk unknown, so the next one starts over from scratch
+            if (!saves[i].ok || batch[i].leaving) {
+                lastWritten.erase(id);
+            } else {
+                lastWritten[id] = std::move(batch[i].player);
+            }
+
+            if (saves[i].ok) {
+                saved++;
+                rows += saves[i].rows;
+                if (saves[i].rows == 0)
+                    unchanged++;
+            }
+
+            for (Barrier& barrier : barriers) {
+                auto it = barrier.waiting.find(id);
+                if (it == barrier.waiting.end())
+                    continue;
+
+                if (!saves[i].ok)
+                    barrier.ok = false;
+                if (--it->second == 0)
+                    barrier.waiting.erase(it);
+            }
+        }
+
+        batch.clear();
+
+        stats.batches++;
+        stats.saved += saved;
+        stats.failed += saves.size() - saved;
+        stats.unchanged += unchanged;
+        stats.rows += rows;
+        stats.lastBatchMicros = micros;
+        stats.totalMicros += micros;
+        if (micros > stats.maxBatchMicros)
+            stats.maxBatchMicros = micros;
+
+        idleCv.notify_all();
+
+        std::vector<Barrier> done;
+        for (size_t i = 0; i < barriers.size();) {
+            if (barriers[i].waiting.empty()) {
+                done.push_back(std::move(barriers[i]));
+                barriers.erase(barriers.begin() + i);
+            } else {
+                i++;
+            }
+        }
+
+        if (!done.empty()) {
+            lock.unlock();
+            for (Barrier& barrier : done)
+                barrier.fn(barrier.ok);
+            lock.lock();
+        }
+    }
+}
+
+void SaveQueue::init() {
+    std::lock_guard<std::mutex> lock(queueLock);
+    if (running)
+        return;
+
+    running = true;
+    stopping = false;
+    writer = std::thread(writerLoop);
+}
+
+void SaveQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        if (!running)
+            return;
+
+        stopping = true;
+        workCv.notify_all();
+    }
+
+    // the writer drains the queue before it exits
+    writer.join();
+
+    std::lock_guard<std::mutex> lock(queueLock);
+    running = false;
+    roomCv.notify_all();
+}
+
+void SaveQueue::push(const Player* plr, bool leaving) {
+    // the journal must never fall behind the database
+    Journal::record(plr);
+    if (leaving)
+        Journal::forget(plr->iID);
+
+    std::unique_lock<std::mutex> lock(queueLock);
+
+    // no writer (not started yet, or already shut down); save inline like before
+    if (!running || stopping) {
+        lock.unlock();
+        Database::updatePlayer(plr);
+        return;
+    }
+
+    // the snapshot is taken here, on the caller's thread, so the writer never sees a live Player
+    std::unique_ptr<const Player> snapshot(new Player(*plr));
+
+    auto it = pending.find(plr->iID);
+    if (it != pending.end()) {
+        it->second.player = std::move(snapshot);
+        it->second.leaving |= leaving;
+        return;
+    }
+
+    if (pending.size() >= (size_t)settings::SAVEQUEUESIZE) {
+        stats.stalls++;
+        roomCv.wait(lock, [] { return pending.size() < (size_t)settings::SAVEQUEUESIZE || !running; });
+
+        if (!running) {
+            lock.unlock();
+            Database::updatePlayer(snapshot.get());
+            return;
+        }
+    }
+
+    pending[plr->iID] = {std::move(snapshot), leaving};
+    order.push_back(plr->iID);
+    if (pending.size() > stats.peakDepth)
+        stats.peakDepth = pending.size();
+
+    workCv.notify_one();
+}
+
+void SaveQueue::flush() {
+    std::unique_lock<std::mutex> lock(queueLock);
+    idleCv.wait(lock, [] { return pending.empty() && inFlight.empty(); });
+}
+
+void SaveQueue::waitFor(int32_t playerId) {
+    std::unique_lock<std::mutex> lock(queueLock);
+    idleCv.wait(lock, [playerId] { return pending.count(playerId) == 0 && inFlight.count(playerId) == 0; });
+}
+
+void SaveQueue::whenWritten(std::function<void(bool ok)> fn) {
+    std::unique_lock<std::mutex> lock(queueLock);
+
+    Barrier barrier = {{}, true, std::move(fn)};
+    for (auto& pair : pending)
+        barrier.waiting[pair.first]++;
+    for (int32_t id : inFlight)
+        barrier.waiting[id]++;
+
+    // nothing outstanding; inline saves (no writer running) are already done too
+    if (barrier.waiting.empty()) {
+        lock.unlock();
+        barrier.fn(true);
+        return;
+    }
+
+    barriers.push_back(std::move(barrier));
+}
+
+SaveQueue::Stats SaveQueue::getStats() {
+    std::lock_guard<std::mutex> lock(queueLock);
+
+    Stats ret = stats;
+    ret.depth = pending.size();
+    return ret;
+}
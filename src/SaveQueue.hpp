@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Player.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/*
+ * Write-behind character saves.
+ *
+ * The shard thread copies players into snapshots and hands them to a writer
+ * thread that commits them in batched transactions, so periodic saves and
+ * logouts don't stall the tick on disk I/O. If a player is still waiting when
+ * a newer snapshot of them comes in, the newer one replaces it in place.
+ *
+ * The writer remembers the last snapshot it wrote for everyone online and only
+ * writes what changed since then. The first save of a session is a full one.
+ *
+ * The queue is bounded (savequeuesize in config.ini). When it's full, push()
+ * waits for the writer to make room rather than dropping a save.
+ */
+namespace SaveQueue {
+    struct Stats {
+        size_t depth;      // snapshots waiting right now
+        size_t peakDepth;
+        uint64_t stalls;   // pushes that had to wait for room
+        uint64_t batches;
+        uint64_t saved;    // players written
+        uint64_t failed;   // players whose save was rolled back
+        uint64_t unchanged; // players that needed no writes at all
+        uint64_t rows;     // rows written or deleted
+        uint64_t lastBatchMicros;
+        uint64_t maxBatchMicros;
+        uint64_t totalMicros;
+    };
+
+    void init();
+    // drains the queue, then stops the writer; call before Database::close()
+    void shutdown();
+
+    // leaving marks their last save, after which the writer forgets them
+    void push(const Player* plr, bool leaving = false);
+    // blocks until everything pushed so far has been written
+    void flush();
+    // blocks until no snapshot of this player is waiting or being written
+    void waitFor(int32_t playerId);
+    // calls fn on the writer thread once everything pushed so far has been written; ok is false if any of it failed
+    void whenWritten(std::function<void(bool ok)> fn);
+
+    Stats getStats();
+}
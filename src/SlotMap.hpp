@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+/*
+ * Generational slot map keyed by 32-bit entity IDs.
+ *
+ * The low SLOT_BITS of an ID pick a slot and the remaining bits hold that
+ * slot's generation. Values are packed densely so iterating runs in memory
+ * order, and lookups go through the sparse slot table in O(1).
+ *
+ * Erasing an entry bumps its slot's generation before the slot is handed out
+ * again, so a stale ID held somewhere else stops resolving instead of aliasing
+ * whichever entity gets the slot next. Freed slots are reused oldest-first.
+ *
+ * The interface mirrors the bits of std::map the server uses (find/end,
+ * operator[], erase, pair-style iteration), so callers barely change.
+ * Iterators are index-based: inserting while iterating is fine, but erase()
+ * moves the last element into the hole, so don't erase mid-iteration.
+ */
+template<typename T>
+class SlotMap {
+public:
+    static const int SLOT_BITS = 20;
+    static const int32_t SLOT_MASK = (1 << SLOT_BITS) - 1;
+    static const int32_t MAX_GENERATION = INT32_MAX >> SLOT_BITS;
+
+    typedef std::pair<int32_t, T> value_type;
+
+    class iterator {
+        SlotMap* map;
+        size_t idx;
+    public:
+        iterator(SlotMap* m, size_t i) : map(m), idx(i) {}
+
+        value_type& operator*() const { return map->dense[idx]; }
+        value_type* operator->() const { return &map->dense[idx]; }
+        iterator& operator++() { idx++; return *this; }
+        // end() is a moving target, so compare against the live size
+        bool operator==(const iterator& other) const { return position() == other.position(); }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+    private:
+        size_t position() const { return idx < map->dense.size() ? idx : map->dense.size(); }
+    };
+
+    static int32_t slotOf(int32_t id) { return id & SLOT_MASK; }
+    static int32_t generationOf(int32_t id) { return id >> SLOT_BITS; }
+    static int32_t makeId(int32_t slot, int32_t generation) { return (generation << SLOT_BITS) | slot; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, dense.size()); }
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+
+    // slots ever handed out, live or not; the difference to size() is the recycling backlog
+    size_t capacity() const { return slots.size(); }
+
+    iterator find(int32_t id) {
+        int32_t idx = denseIndex(id);
+        return idx < 0 ? end() : iterator(this, idx);
+    }
+
+    bool contains(int32_t id) const {
+        return denseIndex(id) >= 0;
+    }
+
+    /*
+     * Like std::map, this inserts a default value if the ID isn't live.
+     * The ID must not collide with a different live generation of its slot.
+     */
+    T& operator[](int32_t id) {
+        int32_t idx = denseIndex(id);
+        if (idx < 0)
+            idx = insert(id, T());
+        return dense[idx].second;
+    }
+
+    /*
+     * Picks an unused ID, preferring the slot that has been free the longest,
+     * and inserts a default value under it.
+     */
+    int32_t allocate() {
+        while (!freeSlots.empty()) {
+            int32_t slot = freeSlots.front();
+            freeSlots.pop_front();
+            slots[slot].queued = false;
+
+            // explicit inserts may have claimed a queued slot in the meantime
+            if (slots[slot].dense != -1)
+                continue;
+
+            int32_t id = makeId(slot, slots[slot].generation);
+            insert(id, T());
+            return id;
+        }
+
+        assert(slots.size() <= (size_t)SLOT_MASK);
+        int32_t id = makeId((int32_t)slots.size(), 0);
+        insert(id, T());
+        return id;
+    }
+
+    // places a value under a caller-chosen ID; used when loading IDs that must stay stable
+    int32_t insert(int32_t id, T value) {
+        assert(id >= 0);
+        int32_t slot = slotOf(id);
+
+        // growing past a gap leaves the skipped slots up for grabs
+        while ((int32_t)slots.size() <= slot) {
+            bool gap = (int32_t)slots.size() != slot;
+            if (gap)
+                freeSlots.push_back((int32_t)slots.size());
+            slots.push_back({0, -1, gap});
+        }
+
+        assert(slots[slot].dense == -1);
+        slots[slot].generation = generationOf(id);
+        slots[slot].dense = (int32_t)dense.size();
+        dense.push_back(std::make_pair(id, value));
+
+        return slots[slot].dense;
+    }
+
+    void erase(int32_t id) {
+        int32_t idx = denseIndex(id);
+        if (idx < 0)
+            return;
+
+        // keep the values packed by moving the last one into the hole
+        if ((size_t)idx != dense.size() - 1) {
+            dense[idx] = dense.back();
+            slots[slotOf(dense[idx].first)].dense = idx;
+        }
+        dense.pop_back();
+
+        Slot& s = slots[slotOf(id)];
+        s.dense = -1;
+
+        // a slot that has run out of generations is retired for good
+        if (s.generation < MAX_GENERATION) {
+            s.generation++;
+            if (!s.queued) {
+                s.queued = true;
+                freeSlots.push_back(slotOf(id));
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        int32_t generation;
+        int32_t dense; // index into dense, -1 if free
+        bool queued; // already waiting in freeSlots
+    };
+
+    std::vector<Slot> slots;
+    std::vector<value_type> dense;
+    std::deque<int32_t> freeSlots;
+
+    int32_t denseIndex(int32_t id) const {
+        if (id < 0)
+            return -1;
+
+        int32_t slot = slotOf(id);
+        if ((size_t)slot >= slots.size() || slots[slot].generation != generationOf(id))
+            return -1;
+
+        return slots[slot].dense;
+    }
+};
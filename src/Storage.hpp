@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Database.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Where accounts, characters and everything hanging off them are kept.
+ *
+ * Database forwards every call to the Storage picked by the dbbackend setting,
+ * so the rest of the server never knows which one it's talking to. Every
+ * method is synchronous and safe to call from any thread; it returns once the
+ * backend is done with it.
+ *
+ * submit() is the asynchronous side. A backend runs the job wherever it does
+ * its I/O and the caller carries on in the meantime; Database::async() adds a
+ * callback for the result. Backends that live in-process can just run the job
+ * there and then, which is what the default does. A store behind a network hop
+ * would queue it for its connection instead.
+ */
+class Storage {
+public:
+    using Account = Database::Account;
+    using EmailData = Database::EmailData;
+    using RaceRanking = Database::RaceRanking;
+    using PlayerSummary = Database::PlayerSummary;
+    using PlayerSave = Database::PlayerSave;
+    using CustomName = Database::CustomName;
+
+    virtual ~Storage() {}
+
+    virtual const char* name() const = 0;
+    virtual void open() = 0;
+    virtual void close() = 0;
+    // only means something to backends that prepare statements
+    virtual void setStatementCache(bool enabled) {}
+    // jobs must only touch storage and what they captured; never live game state
+    virtual void submit(std::function<void()> job) { job(); }
+
+    // accounts
+    virtual void findAccount(Account* account, std::string login) = 0;
+    virtual int addAccount(std::string login, std::string password) = 0;
+    virtual void banAccount(int accountId, int days) = 0;
+    virtual void updateSelected(int accountId, int slot) = 0;
+
+    // characters
+    virtual bool validateCharacter(int characterID, int userID) = 0;
+    virtual bool isNameFree(std::string firstName, std::string lastName) = 0;
+    virtual bool isSlotFree(int accountId, int slotNum) = 0;
+    virtual int createCharacter(sP_CL2LS_REQ_SAVE_CHAR_NAME* save, int AccountID) = 0;
+    virtual bool finishCharacter(sP_CL2LS_REQ_CHAR_CREATE* character, int accountId) = 0;
+    virtual bool finishTutorial(int playerID, int accountID) = 0;
+    virtual int deleteCharacter(int characterID, int userID) = 0;
+    virtual void getCharInfo(std::vector <sP_LS2CL_REP_CHAR_INFO>* result, int userID) = 0;
+    virtual void evaluateCustomName(int characterID, CustomName decision) = 0;
+    virtual bool changeName(sP_CL2LS_REQ_CHANGE_CHAR_NAME* save, int accountId) = 0;
+
+    // player state, inventory and nanos included
+    virtual void getPlayer(Player* plr, int id) = 0;
+    virtual std::vector<PlayerSummary> getPlayerSummaries(const std::vector<int>& ids) = 0;
+    virtual void updatePlayer(const Player* player) = 0;
+    virtual void updatePlayers(std::vector<PlayerSave>& saves) = 0;
+
+    // buddies and blocking
+    virtual int getNumBuddies(Player* player) = 0;
+    virtual void addBuddyship(int playerA, int playerB) = 0;
+    virtual void removeBuddyship(int playerA, int playerB) = 0;
+    virtual void addBlock(int playerId, int blockedPlayerId) = 0;
+    virtual void removeBlock(int playerId, int blockedPlayerId) = 0;
+
+    // email
+    virtual int getUnreadEmailCount(int playerID) = 0;
+    virtual std::vector<EmailData> getEmails(int playerID, int before, int count) = 0;
+    virtual EmailData getEmail(int playerID, int index) = 0;
+    virtual sItemBase* getEmailAttachments(int playerID, int index) = 0;
+    virtual void updateEmailContent(EmailData* data) = 0;
+    virtual void deleteEmailAttachments(int playerID, int index, int slot) = 0;
+    virtual void deleteEmails(int playerID, int64_t* indices) = 0;
+    virtual int getNextEmailIndex(int playerID) = 0;
+    virtual bool sendEmail(EmailData* data, std::vector<sItemBase> attachments) = 0;
+
+    // racing
+    // each player's best result on each EPID; RacingManager answers everything else from memory
+    virtual std::vector<RaceRanking> getRaceBests() = 0;
+    virtual void postRaceRanking(RaceRanking ranking) = 0;
+};
@@ -72,8 +72,8 @@ void TableData::init() {
     // read file into json
     infile >> xdtData;
 
-    // data we'll need for summoned mobs
-    NPCManager::NPCData = xdtData["m_pNpcTable"]["m_pNpcData"];
+    // data we'll need for spawning and summoning mobs
+    NPCManager::loadMobTemplates(xdtData["m_pNpcTable"]["m_pNpcData"]);
 
     try {
         // load warps
@@ -122,11 +122,11 @@ void TableData::init() {
                 MissionManager::Rewards[task["m_iHTaskID"]] = rew;
             }
 
-            // everything else lol. see TaskData comment.
-            MissionManager::Tasks[task["m_iHTaskID"]] = new TaskData(task);
+            MissionManager::loadTask(task);
         }
 
-        std::cout << "[INFO] Loaded mission-related data" << std::endl;
+        std::cout << "[INFO] Loaded " << MissionManager::Tasks.size() << " mission tasks ("
+            << MissionManager::KillTasks.size() << " mob types counted by tasks)" << std::endl;
 
         /*
         * load all equipment data. i'm sorry. it has to be done
@@ -170,9 +170,7 @@ void TableData::init() {
 
         nlohmann::json growth = xdtData["m_pAvatarTable"]["m_pAvatarGrowData"];
 
-        for (int i = 0; i < 37; i++) {
-            MissionManager::AvatarGrowth[i] = growth[i];
-        }
+        MissionManager::loadAvatarGrowth(growth);
 
         // load vendor listings
         nlohmann::json listings = xdtData["m_pVendorTable"]["m_pItemData"];
@@ -264,7 +262,7 @@ void TableData::init() {
         // single mobs
         for (nlohmann::json::iterator _npc = npcData.begin(); _npc != npcData.end(); _npc++) {
             auto npc = _npc.value();
-            auto td = NPCManager::NPCData[(int)npc["iNPCType"]];
+            auto td = &NPCManager::MobTemplates[(int)npc["iNPCType"]];
             uint64_t instanceID = npc.find("iMapNum") == npc.end() ? INSTANCE_OVERWORLD : (int)npc["iMapNum"];
 
 #ifdef ACADEMY
@@ -286,7 +284,7 @@ void TableData::init() {
         // single mobs
         for (nlohmann::json::iterator _group = groupData.begin(); _group != groupData.end(); _group++) {
             auto leader = _group.value();
-            auto td = NPCManager::NPCData[(int)leader["iNPCType"]];
+            auto td = &NPCManager::MobTemplates[(int)leader["iNPCType"]];
             uint64_t instanceID = leader.find("iMapNum") == leader.end() ? INSTANCE_OVERWORLD : (int)leader["iMapNum"];
 
 #ifdef ACADEMY
@@ -310,7 +308,7 @@ void TableData::init() {
                 int followerCount = 0;
                 for (nlohmann::json::iterator _fol = followers.begin(); _fol != followers.end(); _fol++) {
                     auto follower = _fol.value();
-                    auto tdFol = NPCManager::NPCData[(int)follower["iNPCType"]];
+                    auto tdFol = &NPCManager::MobTemplates[(int)follower["iNPCType"]];
                     Mob* tmpFol = new Mob((int)leader["iX"] + (int)follower["iOffsetX"], (int)leader["iY"] + (int)follower["iOffsetY"], leader["iZ"], leader["iAngle"], instanceID, follower["iNPCType"], tdFol, nextId);
 
                     NPCManager::NPCs[nextId] = tmpFol;
@@ -349,10 +347,10 @@ void TableData::init() {
             auto npc = _npc.value();
             int instanceID = npc.find("iMapNum") == npc.end() ? INSTANCE_OVERWORLD : (int)npc["iMapNum"];
 
-            int team = NPCManager::NPCData[(int)npc["iNPCType"]]["m_iTeam"];
+            int team = NPCManager::MobTemplates[(int)npc["iNPCType"]].team;
 
             if (team == 2) {
-                NPCManager::NPCs[nextId] = new Mob(npc["iX"], npc["iY"], npc["iZ"], npc["iAngle"], instanceID, npc["iNPCType"], NPCManager::NPCData[(int)npc["iNPCType"]], nextId);
+                NPCManager::NPCs[nextId] = new Mob(npc["iX"], npc["iY"], npc["iZ"], npc["iAngle"], instanceID, npc["iNPCType"], &NPCManager::MobTemplates[(int)npc["iNPCType"]], nextId);
                 MobManager::Mobs[nextId] = (Mob*)NPCManager::NPCs[nextId];
             } else
                 NPCManager::NPCs[nextId] = new BaseNPC(npc["iX"], npc["iY"], npc["iZ"], npc["iAngle"], instanceID, npc["iNPCType"], nextId);
@@ -377,8 +375,6 @@ void TableData::init() {
     loadPaths(&nextId); // load paths
 
     loadGruntwork(&nextId);
-
-    NPCManager::nextId = nextId;
 }
 
 /*
@@ -402,7 +398,7 @@ void TableData::loadPaths(int* nextId) {
         // slider circuit
         nlohmann::json pathDataSlider = pathData["slider"];
         // lerp between keyframes
-        std::queue<WarpLocation> route;
+        auto route = std::make_shared<TransportPath>();
         // initial point
         nlohmann::json::iterator _point = pathDataSlider.begin(); // iterator
         auto point = _point.value();
@@ -411,9 +407,6 @@ void TableData::loadPaths(int* nextId) {
         // remaining points
         for (_point++; _point != pathDataSlider.end(); _point++) { // loop through all point Bs
             point = _point.value();
-            for (int i = 0; i < stopTime + 1; i++) { // repeat point if it's a stop
-                route.push(from); // add point A to the queue
-            }
             WarpLocation to = { point["iX"] , point["iY"] , point["iZ"] }; // point B coords
             // we may need to change this later; right now, the speed is cut before and after stops (no accel)
             float curve = 1;
@@ -422,19 +415,17 @@ void TableData::loadPaths(int* nextId) {
             } else if (point["stop"]) { // point B is a stop
                 curve = 0.375f;//0.35f;
             }
-            TransportManager::lerp(&route, from, to, SLIDER_SPEED * curve, 1); // lerp from A to B (arbitrary speed)
+            route->addSegment(from, to, SLIDER_SPEED * curve, stopTime + 1); // sit on A if it's a stop, then lerp to B (arbitrary speed)
             from = to; // update point A
             stopTime = point["stop"] ? SLIDER_STOP_TICKS : 0; // set stop ticks for next point A
         }
-        // Uniform distance calculation
+        TransportManager::SliderPath = route;
+        // Uniform distance calculation; every slider runs the route at its own offset from the clock
+        int now = (int)((getTime() / 1000) % route->length);
         int passedDistance = 0;
-        // initial point
-        int pos = 0;
-        WarpLocation lastPoint = route.front();
-        route.pop();
-        route.push(lastPoint);
-        for (pos = 1; pos < route.size(); pos++) {
-            WarpLocation point = route.front();
+        WarpLocation lastPoint = route->at(0);
+        for (int pos = 1; pos < route->length; pos++) {
+            WarpLocation point = route->at(pos);
             passedDistance += hypot(point.x - lastPoint.x, point.y - lastPoint.y);
             if (passedDistance >= SLIDER_GAP_SIZE) { // space them out uniformaly
                 passedDistance -= SLIDER_GAP_SIZE; // step down
@@ -442,11 +433,8 @@ void TableData::loadPaths(int* nextId) {
                 BaseNPC* slider = new BaseNPC(point.x, point.y, point.z, 0, INSTANCE_OVERWORLD, 1, (*nextId)++, NPC_BUS);
                 NPCManager::NPCs[slider->appearanceData.iNPC_ID] = slider;
                 NPCManager::updateNPCPosition(slider->appearanceData.iNPC_ID, slider->appearanceData.iX, slider->appearanceData.iY, slider->appearanceData.iZ, INSTANCE_OVERWORLD, 0);
-                TransportManager::NPCQueues[slider->appearanceData.iNPC_ID] = route;
+                TransportManager::Sliders[slider->appearanceData.iNPC_ID] = { (pos - now + route->length) % route->length, -1 };
             }
-            // rotate
-            route.pop();
-            route.push(point);
             lastPoint = point;
         }
 
@@ -478,7 +466,7 @@ void TableData::loadPaths(int* nextId) {
                 }
             }
         }
-        std::cout << "[INFO] Loaded " << TransportManager::NPCQueues.size() << " NPC paths" << std::endl;
+        std::cout << "[INFO] Loaded " << TransportManager::Sliders.size() << " sliders and " << TransportManager::NPCPaths.size() << " NPC paths" << std::endl;
     }
     catch (const std::exception& err) {
         std::cerr << "[FATAL] Malformed paths.json file! Reason:" << err.what() << std::endl;
@@ -711,7 +699,7 @@ void TableData::constructPathSkyway(nlohmann::json::iterator _pathData) {
     auto pathData = _pathData.value();
     // Interpolate
     nlohmann::json pathPoints = pathData["points"];
-    std::queue<WarpLocation> points;
+    auto path = std::make_shared<TransportPath>();
     nlohmann::json::iterator _point = pathPoints.begin();
     auto point = _point.value();
     WarpLocation last = { point["iX"] , point["iY"] , point["iZ"] }; // start pos
@@ -719,28 +707,25 @@ void TableData::constructPathSkyway(nlohmann::json::iterator _pathData) {
     for (_point++; _point != pathPoints.end(); _point++) {
         point = _point.value();
         WarpLocation coords = { point["iX"] , point["iY"] , point["iZ"] };
-        TransportManager::lerp(&points, last, coords, pathData["iMonkeySpeed"]);
-        points.push(coords); // add keyframe to the queue
+        path->addSegment(last, coords, pathData["iMonkeySpeed"], 0, true); // lerp to the keyframe, then stop on it
         last = coords; // update start pos
     }
-    TransportManager::SkywayPaths[pathData["iRouteID"]] = points;
+    TransportManager::SkywayPaths[pathData["iRouteID"]] = path;
 }
 
 void TableData::constructPathNPC(nlohmann::json::iterator _pathData, int32_t id) {
     auto pathData = _pathData.value();
     // Interpolate
     nlohmann::json pathPoints = pathData["points"];
-    std::queue<WarpLocation> points;
+    auto path = std::make_shared<TransportPath>();
     nlohmann::json::iterator _point = pathPoints.begin();
     auto point = _point.value();
     WarpLocation from = { point["iX"] , point["iY"] , point["iZ"] }; // point A coords
     int stopTime = point["stop"];
     for (_point++; _point != pathPoints.end(); _point++) { // loop through all point Bs
         point = _point.value();
-        for(int i = 0; i < stopTime + 1; i++) // repeat point if it's a stop
-            points.push(from); // add point A to the queue
         WarpLocation to = { point["iX"] , point["iY"] , point["iZ"] }; // point B coords
-        TransportManager::lerp(&points, from, to, pathData["iBaseSpeed"]); // lerp from A to B
+        path->addSegment(from, to, pathData["iBaseSpeed"], stopTime + 1); // sit on A if it's a stop, then lerp to B
         from = to; // update point A
         stopTime = point["stop"];
     }
@@ -748,7 +733,7 @@ void TableData::constructPathNPC(nlohmann::json::iterator _pathData, int32_t id)
     if (id == 0)
         id = pathData["iNPCID"];
 
-    TransportManager::NPCQueues[id] = points;
+    TransportManager::NPCPaths[id] = { path, 0 };
 }
 
 // load gruntwork output; if it exists
@@ -812,9 +797,9 @@ void TableData::loadGruntwork(int32_t *nextId) {
             int id = (*nextId)++;
             uint64_t instanceID = mob.find("iMapNum") == mob.end() ? INSTANCE_OVERWORLD : (int)mob["iMapNum"];
 
-            if (NPCManager::NPCData[(int)mob["iNPCType"]]["m_iTeam"] == 2) {
+            if (NPCManager::MobTemplates[(int)mob["iNPCType"]].team == 2) {
                 npc = new Mob(mob["iX"], mob["iY"], mob["iZ"], instanceID, mob["iNPCType"],
-                    NPCManager::NPCData[(int)mob["iNPCType"]], id);
+                    &NPCManager::MobTemplates[(int)mob["iNPCType"]], id);
 
                 // re-enable respawning
                 ((Mob*)npc)->summoned = false;
@@ -833,7 +818,7 @@ void TableData::loadGruntwork(int32_t *nextId) {
         auto groups = gruntwork["groups"];
         for (auto _group = groups.begin(); _group != groups.end(); _group++) {
             auto leader = _group.value();
-            auto td = NPCManager::NPCData[(int)leader["iNPCType"]];
+            auto td = &NPCManager::MobTemplates[(int)leader["iNPCType"]];
             uint64_t instanceID = leader.find("iMapNum") == leader.end() ? INSTANCE_OVERWORLD : (int)leader["iMapNum"];
 
             Mob* tmp = new Mob(leader["iX"], leader["iY"], leader["iZ"], leader["iAngle"], instanceID, leader["iNPCType"], td, *nextId);
@@ -854,7 +839,7 @@ void TableData::loadGruntwork(int32_t *nextId) {
                 int followerCount = 0;
                 for (nlohmann::json::iterator _fol = followers.begin(); _fol != followers.end(); _fol++) {
                     auto follower = _fol.value();
-                    auto tdFol = NPCManager::NPCData[(int)follower["iNPCType"]];
+                    auto tdFol = &NPCManager::MobTemplates[(int)follower["iNPCType"]];
                     Mob* tmpFol = new Mob((int)leader["iX"] + (int)follower["iOffsetX"], (int)leader["iY"] + (int)follower["iOffsetY"], leader["iZ"], leader["iAngle"], instanceID, follower["iNPCType"], tdFol, *nextId);
 
                     // re-enable respawning
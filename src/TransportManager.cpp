@@ -8,12 +8,16 @@
 
 #include <unordered_map>
 #include <cmath>
+#include <algorithm>
+#include <tuple>
 
 std::map<int32_t, TransportRoute> TransportManager::Routes;
 std::map<int32_t, TransportLocation> TransportManager::Locations;
-std::map<int32_t, std::queue<WarpLocation>> TransportManager::SkywayPaths;
-std::unordered_map<CNSocket*, std::queue<WarpLocation>> TransportManager::SkywayQueues;
-std::unordered_map<int32_t, std::queue<WarpLocation>> TransportManager::NPCQueues;
+std::map<int32_t, std::shared_ptr<const TransportPath>> TransportManager::SkywayPaths;
+std::unordered_map<CNSocket*, PathCursor> TransportManager::SkywayRiders;
+std::unordered_map<int32_t, PathCursor> TransportManager::NPCPaths;
+std::shared_ptr<const TransportPath> TransportManager::SliderPath;
+std::unordered_map<int32_t, SliderState> TransportManager::Sliders;
 
 void TransportManager::init() {
     REGISTER_SHARD_TIMER(tickTransportationSystem, 1000);
@@ -144,7 +148,7 @@ void TransportManager::transportWarpHandler(CNSocket* sock, CNPacketData* data)
         plr->lastZ = plr->z;
         if (SkywayPaths.find(route.mssRouteNum) != SkywayPaths.end()) { // check if route exists
             NanoManager::summonNano(sock, -1); // make sure that no nano is active during the ride
-            SkywayQueues[sock] = SkywayPaths[route.mssRouteNum]; // set socket point queue to route
+            SkywayRiders[sock] = { SkywayPaths[route.mssRouteNum], 0 }; // start the socket at the beginning of the route
             plr->onMonkey = true;
             break;
         } else if (TableData::RunningSkywayRoutes.find(route.mssRouteNum) != TableData::RunningSkywayRoutes.end()) {
@@ -188,45 +192,49 @@ void TransportManager::transportWarpHandler(CNSocket* sock, CNPacketData* data)
 
 void TransportManager::testMssRoute(CNSocket *sock, std::vector<WarpLocation>* route) {
     int speed = 1500; // TODO: make this adjustable
-    std::queue<WarpLocation> path;
+    auto path = std::make_shared<TransportPath>();
     WarpLocation last = route->front(); // start pos
 
     for (int i = 1; i < route->size(); i++) {
         WarpLocation coords = route->at(i);
-        TransportManager::lerp(&path, last, coords, speed);
-        path.push(coords); // add keyframe to the queue
+        path->addSegment(last, coords, speed, 0, true); // lerp to the keyframe, then stop on it
         last = coords; // update start pos
     }
 
-    SkywayQueues[sock] = path;
+    SkywayRiders[sock] = { path, 0 };
 }
 
 void TransportManager::tickTransportationSystem(CNServer* serv, time_t currTime) {
     stepNPCPathing();
     stepSkywaySystem();
+    stepSliders(currTime);
 }
 
 /*
- * Go through every socket that has broomstick points queued up, and advance to the next point.
- * If the player has disconnected or finished the route, clean up and remove them from the queue.
+ * Go through every socket riding a skyway, and advance it to the next point.
+ * If the player has disconnected or finished the route, clean up and remove them from the map.
+ *
+ * Riders on the same path at the same tick are at the same point and see the same
+ * chunks, so each such batch has its point worked out and its viewers walked only once.
  */
 void TransportManager::stepSkywaySystem() {
+    std::map<std::tuple<const TransportPath*, int, uint64_t>, std::vector<CNSocket*>> batches;
 
     // using an unordered map so we can remove finished players in one iteration
-    std::unordered_map<CNSocket*, std::queue<WarpLocation>>::iterator it = SkywayQueues.begin();
-    while (it != SkywayQueues.end()) {
+    std::unordered_map<CNSocket*, PathCursor>::iterator it = SkywayRiders.begin();
+    while (it != SkywayRiders.end()) {
 
-        std::queue<WarpLocation>* queue = &it->second;
+        PathCursor* cursor = &it->second;
 
         if (PlayerManager::players.find(it->first) == PlayerManager::players.end()) {
             // pluck out dead socket + update iterator
-            it = SkywayQueues.erase(it);
+            it = SkywayRiders.erase(it);
             continue;
         }
 
         Player* plr = PlayerManager::getPlayer(it->first);
 
-        if (queue->empty()) {
+        if (cursor->tick >= cursor->path->length) {
             // send dismount packet
             INITSTRUCT(sP_FE2CL_REP_PC_RIDING_SUCC, rideSucc);
             INITSTRUCT(sP_FE2CL_PC_RIDING, rideBroadcast);
@@ -237,43 +245,59 @@ void TransportManager::stepSkywaySystem() {
             it->first->sendPacket((void*)&rideSucc, P_FE2CL_REP_PC_RIDING_SUCC, sizeof(sP_FE2CL_REP_PC_RIDING_SUCC));
             // send packet to players in view
             PlayerManager::sendToViewable(it->first, (void*)&rideBroadcast, P_FE2CL_PC_RIDING, sizeof(sP_FE2CL_PC_RIDING));
-            it = SkywayQueues.erase(it); // remove player from tracking map + update iterator
+            it = SkywayRiders.erase(it); // remove player from tracking map + update iterator
             plr->onMonkey = false;
         } else {
-            WarpLocation point = queue->front(); // get point
-            queue->pop(); // remove point from front of queue
-
-            INITSTRUCT(sP_FE2CL_PC_BROOMSTICK_MOVE, bmstk);
-            bmstk.iPC_ID = plr->iID;
-            bmstk.iToX = point.x;
-            bmstk.iToY = point.y;
-            bmstk.iToZ = point.z;
-            it->first->sendPacket((void*)&bmstk, P_FE2CL_PC_BROOMSTICK_MOVE, sizeof(sP_FE2CL_PC_BROOMSTICK_MOVE));
-            // set player location to point to update viewables
-            PlayerManager::updatePlayerPosition(it->first, point.x, point.y, point.z, plr->instanceID, plr->angle);
-            // send packet to players in view
-            PlayerManager::sendToViewable(it->first, (void*)&bmstk, P_FE2CL_PC_BROOMSTICK_MOVE, sizeof(sP_FE2CL_PC_BROOMSTICK_MOVE));
+            batches[std::make_tuple(cursor->path.get(), cursor->tick, plr->instanceID)].push_back(it->first);
+            cursor->tick++;
 
             it++; // go to next entry in map
         }
     }
+
+    for (auto& batch : batches) {
+        WarpLocation point = std::get<0>(batch.first)->at(std::get<1>(batch.first)); // get point
+        std::vector<CNSocket*>& riders = batch.second;
+
+        std::vector<sP_FE2CL_PC_BROOMSTICK_MOVE> moves(riders.size());
+        for (size_t i = 0; i < riders.size(); i++) {
+            Player* plr = PlayerManager::getPlayer(riders[i]);
+
+            memset(&moves[i], 0, sizeof(sP_FE2CL_PC_BROOMSTICK_MOVE));
+            moves[i].iPC_ID = plr->iID;
+            moves[i].iToX = point.x;
+            moves[i].iToY = point.y;
+            moves[i].iToZ = point.z;
+            // set player location to point to update viewables
+            PlayerManager::updatePlayerPosition(riders[i], point.x, point.y, point.z, plr->instanceID, plr->angle);
+        }
+
+        // everyone in view of the point, the riders themselves included, sees every rider move
+        Player* first = PlayerManager::getPlayer(riders.front());
+        for (Chunk* chunk : *first->viewableChunks)
+            for (CNSocket* otherSock : chunk->players)
+                for (auto& bmstk : moves)
+                    otherSock->sendPacket((void*)&bmstk, P_FE2CL_PC_BROOMSTICK_MOVE, sizeof(sP_FE2CL_PC_BROOMSTICK_MOVE));
+    }
 }
 
 void TransportManager::stepNPCPathing() {
 
-    // all NPC pathing queues
-    std::unordered_map<int32_t, std::queue<WarpLocation>>::iterator it = NPCQueues.begin();
-    while (it != NPCQueues.end()) {
+    // all NPC path cursors
+    std::unordered_map<int32_t, PathCursor>::iterator it = NPCPaths.begin();
+    while (it != NPCPaths.end()) {
 
-        std::queue<WarpLocation>* queue = &it->second;
+        PathCursor* cursor = &it->second;
 
+        // a cursor outliving its NPC won't resolve to whoever reused the slot
         BaseNPC* npc = nullptr;
-        if (NPCManager::NPCs.find(it->first) != NPCManager::NPCs.end())
-            npc = NPCManager::NPCs[it->first];
+        auto npcIt = NPCManager::NPCs.find(it->first);
+        if (npcIt != NPCManager::NPCs.end())
+            npc = npcIt->second;
 
-        if (npc == nullptr || queue->empty()) {
-            // pluck out dead path + update iterator
-            it = NPCQueues.erase(it);
+        if (npc == nullptr || cursor->tick >= cursor->path->length) {
+            // pluck out dead or finished path + update iterator
+            it = NPCPaths.erase(it);
             continue;
         }
 
@@ -289,8 +313,7 @@ void TransportManager::stepNPCPathing() {
             continue;
         }
 
-        WarpLocation point = queue->front(); // get point
-        queue->pop(); // remove point from front of queue
+        WarpLocation point = cursor->path->at(cursor->tick++); // get point and advance
 
         // calculate displacement
         int dXY = hypot(point.x - npc->appearanceData.iX, point.y - npc->appearanceData.iY); // XY plane distance
@@ -329,34 +352,131 @@ void TransportManager::stepNPCPathing() {
         }
 
         /*
-         * Move processed point to the back to maintain cycle, unless this is a
+         * Wrap around to maintain the cycle, unless this is a
          * dynamically calculated mob route.
          */
-        if (!(npc->npcClass == NPC_MOB && !((Mob*)npc)->staticPath))
-            queue->push(point);
+        if (cursor->tick >= cursor->path->length && !(npc->npcClass == NPC_MOB && !((Mob*)npc)->staticPath))
+            cursor->tick = 0;
 
         it++; // go to next entry in map
     }
 }
 
 /*
- * Linearly interpolate between two points and insert the results into a queue.
+ * Where a slider is along the loop at a given server time.
+ */
+int TransportManager::sliderTick(const SliderState& slider, time_t currTime) {
+    int length = SliderPath->length;
+    return (int)((slider.offset + currTime / 1000) % length);
+}
+
+/*
+ * Slider moves only go out when one sets off towards its next keyframe; the client
+ * carries it the rest of the way. Positions are still kept up to date every tick,
+ * since that's what chunk tracking (and the enter packet) works from, but a slider
+ * nobody can see never sends anything.
  */
-void TransportManager::lerp(std::queue<WarpLocation>* queue, WarpLocation start, WarpLocation end, int gapSize, float curve) {
-    int dXY = hypot(end.x - start.x, end.y - start.y); // XY plane distance
-    int distanceBetween = hypot(dXY, end.z - start.z); // total distance
-    int lerps = distanceBetween / gapSize; // number of intermediate points to add
-    for (int i = 1; i <= lerps; i++) {
-        WarpLocation lerp;
-        // lerp math
-        //float frac = i / (lerps + 1);
-        float frac = powf(i, curve) / powf(lerps + 1, curve);
-        lerp.x = (start.x * (1.0f - frac)) + (end.x * frac);
-        lerp.y = (start.y * (1.0f - frac)) + (end.y * frac);
-        lerp.z = (start.z * (1.0f - frac)) + (end.z * frac);
-        queue->push(lerp); // add lerp'd point
+void TransportManager::stepSliders(time_t currTime) {
+    if (SliderPath == nullptr || SliderPath->length == 0)
+        return;
+
+    for (auto& pair : Sliders) {
+        auto npcIt = NPCManager::NPCs.find(pair.first);
+        if (npcIt == NPCManager::NPCs.end())
+            continue;
+
+        BaseNPC* npc = npcIt->second;
+        SliderState& slider = pair.second;
+        int tick = sliderTick(slider, currTime);
+
+        WarpLocation point = SliderPath->at(tick);
+        NPCManager::updateNPCPosition(npc->appearanceData.iNPC_ID, point.x, point.y, point.z, npc->instanceID, npc->appearanceData.iAngle);
+
+        // still sitting at a stop
+        int idx = SliderPath->segmentAt(tick);
+        const TransportPath::Segment& seg = SliderPath->segments[idx];
+        if (tick - seg.start < seg.hold - 1 || slider.leg == idx)
+            continue;
+
+        slider.leg = idx;
+        if (npc->playersInView > 0)
+            for (Chunk* chunk : *npc->viewableChunks)
+                for (CNSocket* sock : chunk->players)
+                    sendSliderMove(sock, npc, currTime);
     }
 }
-void TransportManager::lerp(std::queue<WarpLocation>* queue, WarpLocation start, WarpLocation end, int gapSize) {
-    lerp(queue, start, end, gapSize, 1);
+
+/*
+ * Send the leg a slider is currently on; used both at keyframes and when a
+ * player first sees it mid-leg.
+ */
+void TransportManager::sendSliderMove(CNSocket* sock, BaseNPC* npc, time_t currTime) {
+    if (Sliders.find(npc->appearanceData.iNPC_ID) == Sliders.end() || SliderPath->length == 0)
+        return;
+
+    int tick = sliderTick(Sliders[npc->appearanceData.iNPC_ID], currTime);
+    const TransportPath::Segment& seg = SliderPath->segments[SliderPath->segmentAt(tick)];
+
+    // parked at a stop; the enter packet already has it in the right place
+    if (tick - seg.start < seg.hold - 1)
+        return;
+
+    // calculate displacement to the keyframe
+    int dXY = hypot(seg.to.x - npc->appearanceData.iX, seg.to.y - npc->appearanceData.iY); // XY plane distance
+    int distanceBetween = hypot(dXY, seg.to.z - npc->appearanceData.iZ); // total distance
+    int ticksLeft = seg.start + seg.hold + seg.steps - tick; // until the next segment takes over at the keyframe
+
+    INITSTRUCT(sP_FE2CL_TRANSPORTATION_MOVE, busMove);
+    busMove.eTT = 3;
+    busMove.iT_ID = npc->appearanceData.iNPC_ID;
+    busMove.iMoveStyle = 0; // ???
+    busMove.iToX = seg.to.x;
+    busMove.iToY = seg.to.y;
+    busMove.iToZ = seg.to.z;
+    busMove.iSpeed = distanceBetween / std::max(ticksLeft, 1); // distance per tick, to match how monkeys work
+
+    sock->sendPacket((void*)&busMove, P_FE2CL_TRANSPORTATION_MOVE, sizeof(sP_FE2CL_TRANSPORTATION_MOVE));
+}
+
+/*
+ * Append a leg from one keyframe to the next, split evenly into steps of about
+ * gapSize, optionally sitting on the first keyframe for a while.
+ */
+void TransportPath::addSegment(WarpLocation from, WarpLocation to, int gapSize, int hold, bool arrive) {
+    int dXY = hypot(to.x - from.x, to.y - from.y); // XY plane distance
+    int distanceBetween = hypot(dXY, to.z - from.z); // total distance
+
+    Segment seg = { from, to, hold, distanceBetween / gapSize, arrive, length };
+    segments.push_back(seg);
+    length += seg.hold + seg.steps + (seg.arrive ? 1 : 0);
+}
+
+/*
+ * Where the path is after a number of ticks; the caller keeps it within [0, length).
+ */
+int TransportPath::segmentAt(int tick) const {
+    // find the last segment starting at or before this tick
+    auto seg = std::upper_bound(segments.begin(), segments.end(), tick,
+        [](int t, const Segment& s) { return t < s.start; });
+    return (int)(seg - segments.begin()) - 1;
+}
+
+WarpLocation TransportPath::at(int tick) const {
+    const Segment* seg = &segments[segmentAt(tick)];
+
+    int k = tick - seg->start;
+    if (k < seg->hold)
+        return seg->from;
+
+    k -= seg->hold;
+    if (k >= seg->steps)
+        return seg->to;
+
+    // linear interpolation between the keyframes
+    WarpLocation point;
+    float frac = (float)(k + 1) / (seg->steps + 1);
+    point.x = (seg->from.x * (1.0f - frac)) + (seg->to.x * frac);
+    point.y = (seg->from.y * (1.0f - frac)) + (seg->to.y * frac);
+    point.z = (seg->from.z * (1.0f - frac)) + (seg->to.z * frac);
+    return point;
 }
@@ -4,6 +4,8 @@
 #include "NPCManager.hpp"
 
 #include <unordered_map>
+#include <memory>
+#include <vector>
 
 const int SLIDER_SPEED = 1200;
 const int SLIDER_STOP_TICKS = 16;
@@ -19,12 +21,52 @@ struct TransportLocation {
     int npcID, x, y, z;
 };
 
+/*
+ * A route kept as its keyframe segments. Points along it are worked out from a
+ * tick count on demand instead of being expanded up front, so one path can be
+ * followed by any number of NPCs or skyway riders at once. A tick is one transport timer step.
+ */
+struct TransportPath {
+    struct Segment {
+        WarpLocation from, to;
+        int hold; // ticks spent sitting on from first (stops)
+        int steps; // interpolated points between from and to
+        bool arrive; // spend a tick exactly on to at the end
+        int start; // first tick of this segment along the path
+    };
+
+    std::vector<Segment> segments;
+    int length = 0; // total ticks
+
+    void addSegment(WarpLocation from, WarpLocation to, int gapSize, int hold=0, bool arrive=false);
+    int segmentAt(int tick) const;
+    WarpLocation at(int tick) const;
+};
+
+/*
+ * How far along a shared path something is.
+ */
+struct PathCursor {
+    std::shared_ptr<const TransportPath> path;
+    int tick;
+};
+
+/*
+ * Sliders don't keep a cursor; where they are is a function of the server clock.
+ */
+struct SliderState {
+    int offset; // tick along the slider loop at server time 0
+    int leg; // segment whose move was last broadcast, -1 if none
+};
+
 namespace TransportManager {
     extern std::map<int32_t, TransportRoute> Routes;
     extern std::map<int32_t, TransportLocation> Locations;
-    extern std::map<int32_t, std::queue<WarpLocation>> SkywayPaths; // predefined skyway paths with points
-    extern std::unordered_map<CNSocket*, std::queue<WarpLocation>> SkywayQueues; // player sockets with queued broomstick points
-    extern std::unordered_map<int32_t, std::queue<WarpLocation>> NPCQueues; // NPC ids with queued pathing points
+    extern std::map<int32_t, std::shared_ptr<const TransportPath>> SkywayPaths; // predefined skyway paths, shared by every rider
+    extern std::unordered_map<CNSocket*, PathCursor> SkywayRiders; // player sockets with their place along a skyway
+    extern std::unordered_map<int32_t, PathCursor> NPCPaths; // NPC ids with their place along a path
+    extern std::shared_ptr<const TransportPath> SliderPath; // the loop every slider runs along
+    extern std::unordered_map<int32_t, SliderState> Sliders; // slider NPC ids
 
     void init();
 
@@ -36,7 +78,8 @@ namespace TransportManager {
     void tickTransportationSystem(CNServer*, time_t);
     void stepNPCPathing();
     void stepSkywaySystem();
+    void stepSliders(time_t);
 
-    void lerp(std::queue<WarpLocation>*, WarpLocation, WarpLocation, int, float);
-    void lerp(std::queue<WarpLocation>*, WarpLocation, WarpLocation, int);
+    int sliderTick(const SliderState&, time_t);
+    void sendSliderMove(CNSocket*, BaseNPC*, time_t);
 }
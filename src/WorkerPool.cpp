@@ -0,0 +1,77 @@
+#include "WorkerPool.hpp"
+
+// set while this thread is inside a job, so a nested parallelFor() doesn't wait on itself
+static thread_local bool inJob = false;
+
+WorkerPool::WorkerPool(int threads) {
+    for (int i = 1; i < threads; i++)
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wakeCv.notify_all();
+
+    for (std::thread& t : workers)
+        t.join();
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    // not worth waking anyone up for, or everyone's already busy with the outer job
+    if (workers.empty() || count < 2 || inJob) {
+        for (size_t i = 0; i < count; i++)
+            fn(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        job = &fn;
+        jobSize = count;
+        next = 0;
+        busy = (int)workers.size();
+        generation++;
+    }
+    wakeCv.notify_all();
+
+    // the caller pulls its weight too
+    drain();
+
+    std::unique_lock<std::mutex> guard(lock);
+    doneCv.wait(guard, [this] { return busy == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::drain() {
+    bool outer = inJob;
+    inJob = true;
+
+    size_t i;
+    while ((i = next++) < jobSize)
+        (*job)(i);
+
+    inJob = outer;
+}
+
+void WorkerPool::workerLoop() {
+    uint64_t seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wakeCv.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (--busy == 0)
+            doneCv.notify_one();
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.condition_variable.h"
+    #include "mingw/mingw.mutex.h"
+    #include "mingw/mingw.thread.h"
+#else
+    #include <condition_variable>
+    #include <mutex>
+    #include <thread>
+#endif
+
+/*
+ * Small fixed-size thread pool for fork/join work inside a shard tick.
+ *
+ * parallelFor() hands out indices to the workers and the calling thread alike
+ * and only returns once every index has been processed, so the caller can treat
+ * it like a plain loop whose iterations may run concurrently. Jobs must not
+ * touch shared game state they don't own; results go into per-index slots
+ * that the caller applies afterwards, in order. A parallelFor() from inside a
+ * job just runs its loop inline on that thread.
+ */
+class WorkerPool {
+public:
+    // total threads including the caller; 1 (or less) means everything runs inline
+    explicit WorkerPool(int threads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int size() const { return (int)workers.size() + 1; }
+
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wakeCv, doneCv;
+
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobSize = 0;
+    std::atomic<size_t> next{0};
+    int busy = 0; // workers still on the current job
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void drain();
+    void workerLoop();
+};
@@ -15,6 +15,9 @@
 #include "GroupManager.hpp"
 #include "Monitor.hpp"
 #include "RacingManager.hpp"
+#include "Rand.hpp"
+#include "SaveQueue.hpp"
+#include "Journal.hpp"
 
 #include "settings.hpp"
 
@@ -50,6 +53,8 @@ void terminate(int arg) {
     if (shardServer != nullptr && shardThread != nullptr)
         shardServer->kill();
     
+    SaveQueue::shutdown();
+    Journal::close();
     Database::close();
     exit(0);
 }
@@ -86,8 +91,8 @@ int main() {
 #else
     initsignals();
 #endif
-    srand(getTime());
     settings::init();
+    Rand::init(settings::RANDSEED != 0 ? settings::RANDSEED : getTime());
     std::cout << "[INFO] OpenFusion v" GIT_VERSION << std::endl;
     std::cout << "[INFO] Protocol version: " << PROTOCOL_VERSION << std::endl;
     std::cout << "[INFO] Intializing Packet Managers..." << std::endl;
@@ -104,6 +109,9 @@ int main() {
     GroupManager::init();
     RacingManager::init();
     Database::open();
+    RacingManager::loadRankings();
+    Journal::init();
+    SaveQueue::init();
 
     switch (settings::EVENTMODE) {
     case 0: break; // no event
@@ -126,6 +134,8 @@ int main() {
 
     shardServer->kill();
     shardThread->join();
+    SaveQueue::shutdown();
+    Journal::close();
 
 #ifdef _WIN32
     WSACleanup();
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstdlib>
 #include "settings.hpp"
 #include "contrib/INIReader.hpp"
 
@@ -7,13 +8,22 @@ int settings::VERBOSITY = 1;
 
 int settings::LOGINPORT = 23000;
 bool settings::APPROVEALLNAMES = true;
-int settings::DBSAVEINTERVAL = 240;
+int settings::DBSAVEINTERVAL = 1800;
+int settings::SAVEQUEUESIZE = 512;
 
 int settings::SHARDPORT = 23001;
 std::string settings::SHARDSERVERIP = "127.0.0.1";
 time_t settings::TIMEOUT = 60000;
 int settings::VIEWDISTANCE = 25600;
+// 0 in config.ini means "derive from VIEWDISTANCE", to stay compatible with older configs
+int settings::CHUNKSIZE = 25600 / 3;
+int settings::VIEWRADIUS = 1;
+std::map<int, settings::MapViewSettings> settings::MAPVIEWSETTINGS;
 bool settings::SIMULATEMOBS = true;
+int settings::MOBTHREADS = 1;
+int settings::INSTANCESTEPBUDGET = 50;
+// 0 seeds from the clock
+int64_t settings::RANDSEED = 0;
 
 // default spawn point
 #ifndef ACADEMY
@@ -38,6 +48,11 @@ std::string settings::EGGSJSON = "tdata/eggs.json";
 std::string settings::GRUNTWORKJSON = "tdata/gruntwork.json";
 std::string settings::MOTDSTRING = "Welcome to OpenFusion!";
 std::string settings::DBPATH = "database.db";
+std::string settings::DBBACKEND = "sqlite";
+std::string settings::DBSYNCHRONOUS = "normal";
+int settings::DBCHECKPOINTPAGES = 1000;
+std::string settings::JOURNALPATH = "journal.bin";
+int settings::JOURNALINTERVAL = 5000;
 int settings::ACCLEVEL = 1;
 bool settings::DISABLEFIRSTUSEFLAG = true;
 
@@ -67,10 +82,16 @@ void settings::init() {
     LOGINPORT = reader.GetInteger("login", "port", LOGINPORT);
     SHARDPORT = reader.GetInteger("shard", "port", SHARDPORT);
     DBSAVEINTERVAL = reader.GetInteger("login", "dbsaveinterval", DBSAVEINTERVAL);
+    SAVEQUEUESIZE = reader.GetInteger("login", "savequeuesize", SAVEQUEUESIZE);
     SHARDSERVERIP = reader.Get("shard", "ip", "127.0.0.1");
     TIMEOUT = reader.GetInteger("shard", "timeout", TIMEOUT);
     VIEWDISTANCE = reader.GetInteger("shard", "viewdistance", VIEWDISTANCE);
+    CHUNKSIZE = reader.GetInteger("shard", "chunksize", 0);
+    VIEWRADIUS = reader.GetInteger("shard", "viewradius", VIEWRADIUS);
     SIMULATEMOBS = reader.GetBoolean("shard", "simulatemobs", SIMULATEMOBS);
+    MOBTHREADS = reader.GetInteger("shard", "mobthreads", MOBTHREADS);
+    INSTANCESTEPBUDGET = reader.GetInteger("shard", "instancestepbudget", INSTANCESTEPBUDGET);
+    RANDSEED = reader.GetInteger("shard", "randseed", RANDSEED);
     SPAWN_X = reader.GetInteger("shard", "spawnx", SPAWN_X);
     SPAWN_Y = reader.GetInteger("shard", "spawny", SPAWN_Y);
     SPAWN_Z = reader.GetInteger("shard", "spawnz", SPAWN_Z);
@@ -85,6 +106,11 @@ void settings::init() {
     GRUNTWORKJSON = reader.Get("shard", "gruntwork", GRUNTWORKJSON);
     MOTDSTRING = reader.Get("shard", "motd", MOTDSTRING);
     DBPATH = reader.Get("shard", "dbpath", DBPATH);
+    DBBACKEND = reader.Get("shard", "dbbackend", DBBACKEND);
+    DBSYNCHRONOUS = reader.Get("shard", "dbsynchronous", DBSYNCHRONOUS);
+    DBCHECKPOINTPAGES = reader.GetInteger("shard", "dbcheckpointpages", DBCHECKPOINTPAGES);
+    JOURNALPATH = reader.Get("shard", "journalpath", JOURNALPATH);
+    JOURNALINTERVAL = reader.GetInteger("shard", "journalinterval", JOURNALINTERVAL);
     ACCLEVEL = reader.GetInteger("shard", "accountlevel", ACCLEVEL);
     EVENTMODE = reader.GetInteger("shard", "eventmode", EVENTMODE);
     EVENTCRATECHANCE = reader.GetInteger("shard", "eventcratechance", EVENTCRATECHANCE);
@@ -92,4 +118,33 @@ void settings::init() {
     MONITORENABLED = reader.GetBoolean("monitor", "enabled", MONITORENABLED);
     MONITORPORT = reader.GetInteger("monitor", "port", MONITORPORT);
     MONITORINTERVAL = reader.GetInteger("monitor", "interval", MONITORINTERVAL);
+
+    // the old behaviour: the 3x3 chunk neighbourhood spans the view distance
+    if (CHUNKSIZE <= 0)
+        CHUNKSIZE = VIEWDISTANCE / 3;
+    if (VIEWRADIUS < 0)
+        VIEWRADIUS = 0;
+
+    // per-map overrides live in sections named [map.<mapnum>]
+    for (const std::string& section : reader.Sections()) {
+        if (section.rfind("map.", 0) != 0)
+            continue;
+
+        char* rest;
+        int mapNum = std::strtol(section.c_str() + 4, &rest, 10);
+        if (*rest || rest == section.c_str() + 4) {
+            std::cerr << "[WARN] Settings: invalid map section [" << section << "]" << std::endl;
+            continue;
+        }
+
+        MapViewSettings view;
+        view.chunkSize = reader.GetInteger(section, "chunksize", CHUNKSIZE);
+        view.viewRadius = reader.GetInteger(section, "viewradius", VIEWRADIUS);
+        if (view.chunkSize <= 0)
+            view.chunkSize = CHUNKSIZE;
+        if (view.viewRadius < 0)
+            view.viewRadius = 0;
+
+        MAPVIEWSETTINGS[mapNum] = view;
+    }
 }
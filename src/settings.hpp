@@ -1,15 +1,24 @@
 #pragma once
 
+#include <map>
+#include <cstdint>
+
 namespace settings {
     extern int VERBOSITY;
     extern int LOGINPORT;
     extern bool APPROVEALLNAMES;
     extern int DBSAVEINTERVAL;
+    extern int SAVEQUEUESIZE;
     extern int SHARDPORT;
     extern std::string SHARDSERVERIP;
     extern time_t TIMEOUT;
     extern int VIEWDISTANCE;
+    extern int CHUNKSIZE;
+    extern int VIEWRADIUS;
     extern bool SIMULATEMOBS;
+    extern int MOBTHREADS;
+    extern int INSTANCESTEPBUDGET;
+    extern int64_t RANDSEED;
     extern int SPAWN_X;
     extern int SPAWN_Y;
     extern int SPAWN_Z;
@@ -25,6 +34,11 @@ namespace settings {
     extern std::string EGGSJSON;
     extern std::string GRUNTWORKJSON;
     extern std::string DBPATH;
+    extern std::string DBBACKEND;
+    extern std::string DBSYNCHRONOUS;
+    extern int DBCHECKPOINTPAGES;
+    extern std::string JOURNALPATH;
+    extern int JOURNALINTERVAL;
     extern int EVENTMODE;
     extern int EVENTCRATECHANCE;
     extern bool MONITORENABLED;
@@ -32,5 +46,13 @@ namespace settings {
     extern int MONITORINTERVAL;
     extern bool DISABLEFIRSTUSEFLAG;
 
+
+    // per-map overrides for chunk size and view radius (in chunks)
+    struct MapViewSettings {
+        int chunkSize;
+        int viewRadius;
+    };
+    extern std::map<int, MapViewSettings> MAPVIEWSETTINGS;
+
     void init();
 }